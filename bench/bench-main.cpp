@@ -0,0 +1,79 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Benchmark runner
+ *
+ * Runs the benchmarks registered with BENCHMARK(); arguments select
+ * benchmarks by name. Counts heap allocations so allocation-free paths can
+ * be verified.
+ *
+ * License: GPL-3.0
+ */
+
+#include "bench.h"
+#include "srtla-log.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+static std::atomic<size_t> g_allocations{0};
+static const char* g_current = "";
+static int g_failures = 0;
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+size_t benchAllocations() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+std::vector<BenchCase>& benchRegistry() {
+    static std::vector<BenchCase> registry;
+    return registry;
+}
+
+void benchReport(const char* metric, double value, const char* unit) {
+    printf("%-28s %-22s %12.2f %s\n", g_current, metric, value, unit);
+    fflush(stdout);
+}
+
+void benchFail(const char* reason) {
+    g_failures++;
+    printf("%-28s FAILED: %s\n", g_current, reason);
+}
+
+static bool selected(const char* name, int argc, char** argv) {
+    if (argc < 2) return true;
+    for (int i = 1; i < argc; i++) {
+        if (strstr(name, argv[i])) return true;
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    srtla_log_set_handler([](int level, const char* message) {
+        if (level <= SRTLA_LOG_WARNING) {
+            fprintf(stderr, "  log: %s\n", message);
+        }
+    });
+
+    for (const BenchCase& bench : benchRegistry()) {
+        if (!selected(bench.name, argc, argv)) continue;
+        g_current = bench.name;
+        bench.function();
+    }
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Minimal self-registering benchmark harness for srtla-bench.
+//
+// Each BENCHMARK() runs once and reports its own figures with
+// benchReport(); benchFail() marks the run as failed (e.g. when a path
+// that must not allocate did). Arguments to srtla-bench select
+// benchmarks by name.
+
+using BenchFunction = void (*)();
+
+struct BenchCase {
+    const char* name;
+    BenchFunction function;
+};
+
+std::vector<BenchCase>& benchRegistry();
+
+struct BenchRegistrar {
+    BenchRegistrar(const char* name, BenchFunction function) {
+        benchRegistry().push_back({name, function});
+    }
+};
+
+#define BENCHMARK(name)                                                \
+    static void bench_##name();                                        \
+    static BenchRegistrar bench_registrar_##name(#name, bench_##name); \
+    static void bench_##name()
+
+// Print one result line of the running benchmark
+void benchReport(const char* metric, double value, const char* unit);
+
+// Mark the running benchmark as failed
+void benchFail(const char* reason);
+
+// Heap allocations made by this process so far
+size_t benchAllocations();
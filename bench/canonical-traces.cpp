@@ -0,0 +1,140 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Canonical link traces
+ *
+ * License: GPL-3.0
+ */
+
+#include "canonical-traces.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+
+static constexpr int64_t DURATION_MS = 60000;
+static constexpr int64_t FRAME_MS = 250;
+
+namespace {
+
+struct ModemProfile {
+    const char* name;
+    double capacityKbps;
+    double rttMs;
+    double lossBp;
+};
+
+// Slowly wandering multiplier around 1.0, within [low, high]
+class RandomWalk {
+public:
+    RandomWalk(std::mt19937& rng, double step, double low, double high)
+        : m_rng(rng), m_step(step), m_low(low), m_high(high) {}
+
+    double next() {
+        m_value += std::uniform_real_distribution<double>(-m_step, m_step)(m_rng);
+        m_value = std::min(std::max(m_value, m_low), m_high);
+        return m_value;
+    }
+
+private:
+    std::mt19937& m_rng;
+    double m_step, m_low, m_high;
+    double m_value = 1.0;
+};
+
+LinkTracePoint point(double capacityKbps, double rttMs, double lossBp) {
+    LinkTracePoint p;
+    p.capacityKbps = (uint32_t)std::max(0.0, std::round(capacityKbps));
+    p.rttMs = (uint32_t)std::max(1.0, std::round(rttMs));
+    p.lossBp = (uint32_t)std::min(10000.0, std::max(0.0, std::round(lossBp)));
+    return p;
+}
+
+// Fills a trace frame by frame; shape(link, ms, base) returns the point
+LinkTrace build(const std::vector<ModemProfile>& modems,
+                const std::function<LinkTracePoint(size_t, int64_t, const ModemProfile&)>& shape) {
+    LinkTrace trace;
+    for (const auto& modem : modems) trace.linkNames.push_back(modem.name);
+    for (int64_t ms = 0; ms <= DURATION_MS; ms += FRAME_MS) {
+        LinkTrace::Frame frame;
+        frame.atMs = ms;
+        for (size_t i = 0; i < modems.size(); i++) {
+            frame.links.push_back(shape(i, ms, modems[i]));
+        }
+        trace.frames.push_back(std::move(frame));
+    }
+    return trace;
+}
+
+LinkTrace urbanHandover() {
+    std::vector<ModemProfile> modems = {
+        {"modem-a", 7000, 45, 30}, {"modem-b", 5000, 60, 50}, {"modem-c", 3000, 80, 80}};
+    std::mt19937 rng(401);
+    std::vector<RandomWalk> walks;
+    for (size_t i = 0; i < modems.size(); i++) walks.emplace_back(rng, 0.05, 0.4, 1.3);
+
+    // Handover every period ms from offset: 500 ms outage, then 1.5 s of
+    // a congested new cell
+    const int64_t offsets[] = {5000, 9000, 3000};
+    const int64_t periods[] = {12000, 15000, 18000};
+    return build(modems, [&](size_t i, int64_t ms, const ModemProfile& m) {
+        double capacity = m.capacityKbps * walks[i].next();
+        double rtt = m.rttMs + std::uniform_real_distribution<double>(-10, 10)(rng);
+        int64_t sinceHandover = ms >= offsets[i] ? (ms - offsets[i]) % periods[i] : -1;
+        if (sinceHandover >= 0 && sinceHandover < 500) return point(0, rtt, 0);
+        if (sinceHandover >= 0 && sinceHandover < 2000) return point(capacity * 0.5, rtt * 3, 500);
+        return point(capacity, rtt, m.lossBp);
+    });
+}
+
+LinkTrace tunnelBlackout() {
+    std::vector<ModemProfile> modems = {{"modem-a", 6000, 50, 20}, {"modem-b", 4000, 65, 40}};
+    std::mt19937 rng(402);
+    std::vector<RandomWalk> walks;
+    for (size_t i = 0; i < modems.size(); i++) walks.emplace_back(rng, 0.04, 0.6, 1.2);
+
+    return build(modems, [&](size_t i, int64_t ms, const ModemProfile& m) {
+        double capacity = m.capacityKbps * walks[i].next();
+        double rtt = m.rttMs + std::uniform_real_distribution<double>(-8, 8)(rng);
+        int64_t back = i == 0 ? 33000 : 35000;
+        if (ms >= 20000 && ms < 25000) {
+            // Approaching the tunnel: capacity fades, queues and loss build up
+            double fade = (ms - 20000) / 5000.0;
+            return point(capacity * (1.0 - 0.8 * fade), rtt + 250 * fade, m.lossBp + 300 * fade);
+        }
+        if (ms >= 25000 && ms < back) return point(0, rtt, 0);
+        if (ms >= back && ms < back + 3000) return point(capacity * 0.5, rtt * 2, m.lossBp * 3);
+        return point(capacity, rtt, m.lossBp);
+    });
+}
+
+LinkTrace congestedStadium() {
+    std::vector<ModemProfile> modems = {
+        {"modem-a", 2500, 150, 200}, {"modem-b", 2000, 180, 300}, {"modem-c", 1500, 220, 500}};
+    std::mt19937 rng(403);
+    std::vector<RandomWalk> walks;
+    for (size_t i = 0; i < modems.size(); i++) walks.emplace_back(rng, 0.25, 0.5, 1.5);
+    std::vector<int64_t> outageUntil(modems.size(), -1);
+
+    return build(modems, [&](size_t i, int64_t ms, const ModemProfile& m) {
+        double factor = walks[i].next();
+        // Bufferbloat: the less capacity, the longer the queues
+        double rtt = m.rttMs * (1.0 + 1.5 * (1.5 - factor)) + std::uniform_real_distribution<double>(0, 40)(rng);
+        double loss = m.lossBp * (0.5 + std::uniform_real_distribution<double>(0, 1)(rng));
+        if (ms >= outageUntil[i] && std::uniform_real_distribution<double>(0, 1)(rng) < 0.01) {
+            outageUntil[i] = ms + 300;
+        }
+        if (ms < outageUntil[i]) return point(0, rtt, 0);
+        return point(m.capacityKbps * factor, rtt, loss);
+    });
+}
+
+} // namespace
+
+std::vector<CanonicalTrace> canonicalTraces() {
+    return {
+        {"urban_4g_handover", urbanHandover()},
+        {"tunnel_blackout", tunnelBlackout()},
+        {"congested_stadium", congestedStadium()},
+    };
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "link-trace.h"
+
+// Synthetic link traces of the situations the bonding logic is tuned for,
+// generated from fixed seeds so every build replays exactly the same links.
+//
+//   urban_4g_handover   three modems with periodic cell handovers: short
+//                       outages followed by RTT and loss spikes
+//   tunnel_blackout     two modems degrade, drop out together for 8 s and
+//                       come back one after the other
+//   congested_stadium   three modems with little, fast-changing capacity,
+//                       bufferbloated RTTs, heavy loss and brief dropouts
+struct CanonicalTrace {
+    const char* name;
+    LinkTrace trace;
+};
+
+std::vector<CanonicalTrace> canonicalTraces();
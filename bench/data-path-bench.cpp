@@ -0,0 +1,296 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Data path benchmarks
+ *
+ * Packet ring and scheduler costs, and end-to-end goodput, one-way latency
+ * and reordering of the bonding engine through the local SRTLA receiver.
+ *
+ * License: GPL-3.0
+ */
+
+#include "bench.h"
+#include "link-impairment.h"
+#include "link-scheduler.h"
+#include "packet-ring.h"
+#include "srtla-receiver.h"
+#include "srtla-sender.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+static int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+BENCHMARK(packet_ring_spsc) {
+    static constexpr uint64_t COUNT = 5000000;
+    PacketRing<1500> ring(8192);
+    uint8_t packet[1316] = {0};
+
+    auto start = Clock::now();
+    std::thread producer([&]() {
+        for (uint64_t i = 0; i < COUNT;) {
+            if (ring.push(packet, sizeof(packet))) {
+                i++;
+            }
+        }
+    });
+    uint64_t consumed = 0;
+    while (consumed < COUNT) {
+        size_t len;
+        size_t n = 0;
+        while (n < 64 && ring.peek(len, n)) n++;
+        ring.pop(n);
+        consumed += n;
+    }
+    producer.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    benchReport("throughput", COUNT / seconds / 1e6, "Mpkt/s");
+}
+
+BENCHMARK(link_scheduler_select) {
+    static constexpr int ITERATIONS = 10000000;
+    LinkMetrics metrics[4];
+    const LinkMetrics* links[4];
+    for (int i = 0; i < 4; i++) {
+        metrics[i].registered = true;
+        metrics[i].window = SRTLA_WINDOW_DEF * SRTLA_WINDOW_MULT;
+        metrics[i].srttMs = 20.0 + 10 * i;
+        metrics[i].lossRate = 0.01 * i;
+        metrics[i].priority = i / 2;
+        links[i] = &metrics[i];
+    }
+
+    for (LinkSchedulerType type : {LinkSchedulerType::Window, LinkSchedulerType::RttWeighted,
+                                   LinkSchedulerType::LossPenalised, LinkSchedulerType::Priority}) {
+        auto scheduler = createLinkScheduler(type);
+        auto start = Clock::now();
+        for (int i = 0; i < ITERATIONS; i++) {
+            int selected = scheduler->select(links, 4);
+            // Keep the in-flight counts moving like the engine does
+            metrics[selected].inFlight = (metrics[selected].inFlight + 1) % SRTLA_WINDOW_DEF;
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ITERATIONS;
+        benchReport(linkSchedulerName(type), ns, "ns/select");
+    }
+}
+
+namespace {
+
+// SRT sink behind the local receiver, records the one-way latency from
+// the send timestamp carried in each packet
+class LatencySink {
+public:
+    LatencySink() {
+        m_fd = socket(AF_INET, SOCK_DGRAM, 0);
+        int rcvbuf = 8 << 20;
+        setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(m_fd, (sockaddr*)&addr, sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(m_fd, (sockaddr*)&addr, &len);
+        m_port = ntohs(addr.sin_port);
+
+        timeval tv{0, 50000};
+        setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        m_thread = std::thread(&LatencySink::run, this);
+    }
+
+    ~LatencySink() {
+        m_stop = true;
+        m_thread.join();
+        close(m_fd);
+    }
+
+    uint16_t port() const { return m_port; }
+    std::atomic<uint64_t> received{0};
+
+    // One-way latencies in microseconds; call after the traffic stopped
+    std::vector<double> takeLatencies() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return std::move(m_latencies);
+    }
+
+private:
+    void run() {
+        uint8_t buf[SRTLA_MTU];
+        while (!m_stop) {
+            ssize_t n = recv(m_fd, buf, sizeof(buf), 0);
+            if (n < SRT_MIN_LEN + 8 || srt_data_seq(buf, n) < 0) continue;
+            int64_t sentNs;
+            memcpy(&sentNs, buf + SRT_MIN_LEN, sizeof(sentNs));
+            double latencyUs = (nowNs() - sentNs) / 1000.0;
+
+            received++;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_latencies.push_back(latencyUs);
+        }
+    }
+
+    int m_fd;
+    uint16_t m_port;
+    std::atomic<bool> m_stop{false};
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::vector<double> m_latencies;
+};
+
+double percentile(std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t index = std::min(sorted.size() - 1, (size_t)(p * sorted.size()));
+    return sorted[index];
+}
+
+// Streams count packets at offeredMbps to the engine's local port, as OBS
+// would, over 127.0.0.1 to 127.0.0.<uplinks> to the local receiver, and
+// reports what reached the SRT sink behind it
+void runSenderLoopback(size_t uplinks, double offeredMbps, uint32_t count,
+                       std::shared_ptr<const ImpairmentScript> impairment) {
+    static constexpr size_t PAYLOAD = 1316;
+
+    // The receiver restores sequence order, as a relay in front of an SRT
+    // listener would need to, so latency includes the reordering wait
+    LatencySink sink;
+    SrtlaReceiver receiver;
+    receiver.setReassembly(256, 50);
+    if (!receiver.start("127.0.0.1", 0, "127.0.0.1", sink.port())) {
+        benchFail("receiver did not start");
+        return;
+    }
+
+    std::vector<LinkConfig> links;
+    for (size_t i = 1; i <= uplinks; i++) {
+        LinkConfig link;
+        link.sourceIp = "127.0.0." + std::to_string(i);
+        links.push_back(link);
+    }
+    // A local port nothing is bound to, for the SRT client to send to
+    int client = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(client, (sockaddr*)&local, sizeof(local));
+    socklen_t localLen = sizeof(local);
+    getsockname(client, (sockaddr*)&local, &localLen);
+    close(client);
+    client = socket(AF_INET, SOCK_DGRAM, 0);
+
+    SenderStatsBuffer statsBuffer;
+    SrtlaSender sender;
+    sender.setStatsBuffer(&statsBuffer);
+    sender.setImpairment(impairment);
+    if (!sender.start(ntohs(local.sin_port), {"127.0.0.1"}, receiver.port(), links)) {
+        close(client);
+        benchFail("sender did not start");
+        return;
+    }
+
+    auto deadline = Clock::now() + std::chrono::seconds(3);
+    size_t registered = 0;
+    while (registered < uplinks && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        const SenderStats* stats = nullptr;
+        statsBuffer.read(stats);
+        registered = 0;
+        for (const auto& link : stats->links) registered += link.registered;
+    }
+    if (registered < uplinks) {
+        close(client);
+        benchFail("links did not register");
+        return;
+    }
+
+    // Paced in bursts of 10 packets, like an encoder output at the offered rate
+    auto burstInterval = std::chrono::nanoseconds((int64_t)(10 * PAYLOAD * 8 / (offeredMbps * 1e6) * 1e9));
+    uint8_t packet[PAYLOAD] = {0};
+    auto start = Clock::now();
+    for (uint32_t seq = 0; seq < count; seq++) {
+        if (seq % 10 == 0) {
+            std::this_thread::sleep_until(start + burstInterval * (seq / 10));
+        }
+        srtla_write_be32(packet, seq);
+        int64_t sent = nowNs();
+        memcpy(packet + SRT_MIN_LEN, &sent, sizeof(sent));
+        sendto(client, packet, sizeof(packet), 0, (sockaddr*)&local, sizeof(local));
+    }
+    close(client);
+
+    // Wait for stragglers until nothing arrives for a while
+    auto lastProgress = Clock::now();
+    uint64_t lastReceived = sink.received;
+    while (sink.received < count && Clock::now() - lastProgress < std::chrono::milliseconds(500)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (sink.received != lastReceived) {
+            lastReceived = sink.received;
+            lastProgress = Clock::now();
+        }
+    }
+    double seconds = std::chrono::duration<double>(lastProgress - start).count();
+
+    const SenderStats* stats = nullptr;
+    statsBuffer.read(stats);
+    uint64_t impairedDrops = 0;
+    for (const auto& link : stats->links) impairedDrops += link.impairedDrops;
+    sender.stop();
+    ReceiverStats received = receiver.stats();
+    receiver.stop();
+
+    std::vector<double> latencies = sink.takeLatencies();
+    std::sort(latencies.begin(), latencies.end());
+    double delivered = (double)sink.received / count;
+
+    benchReport("offered", offeredMbps, "Mbit/s");
+    benchReport("goodput", sink.received * PAYLOAD * 8 / seconds / 1e6, "Mbit/s");
+    benchReport("delivered", delivered * 100.0, "%");
+    if (impairment) {
+        benchReport("impairment drops", impairedDrops, "pkts");
+    }
+    benchReport("latency p50", percentile(latencies, 0.50), "us");
+    benchReport("latency p99", percentile(latencies, 0.99), "us");
+    benchReport("latency max", latencies.empty() ? 0.0 : latencies.back(), "us");
+    benchReport("reordered", received.packets ? 100.0 * received.reordered / received.packets : 0.0, "%");
+    benchReport("reorder depth mean", received.meanReorderDepth, "pkts");
+    benchReport("reorder depth max", received.maxReorderDepth, "pkts");
+}
+
+} // namespace
+
+BENCHMARK(sender_loopback) {
+    // A high-bitrate contribution stream over four clean links
+    runSenderLoopback(4, 50.0, 20000, nullptr);
+}
+
+BENCHMARK(sender_impaired) {
+    // Two cellular modems with bursty loss and a WiFi link that drops out.
+    // There are no SRT retransmissions here, so losses stay lost.
+    static const char* SCRIPT =
+        "seed 7\n"
+        "0     0  delay=35 jitter=15 rate=6000 loss=0.5 ge=0.005,0.3,60\n"
+        "0     1  delay=50 jitter=25 rate=4000 loss=1 ge=0.01,0.2,80\n"
+        "0     2  delay=8 jitter=4 rate=10000\n"
+        "2000  2  blackout=on\n"
+        "3500  2  blackout=off\n";
+    auto script = std::make_shared<ImpairmentScript>();
+    std::string error;
+    if (!ImpairmentScript::parse(SCRIPT, *script, error)) {
+        benchFail(error.c_str());
+        return;
+    }
+    runSenderLoopback(3, 8.0, 4000, script);
+}
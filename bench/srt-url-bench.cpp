@@ -0,0 +1,64 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * SRT URL micro-benchmarks
+ *
+ * Times parseSrtUrl() and formatSrtUrl() on a URL using every option, and
+ * fails if either allocates.
+ *
+ * License: GPL-3.0
+ */
+
+#include "bench.h"
+#include "srt-url.h"
+
+#include <chrono>
+
+static const char TEST_URL[] =
+    "srt://[2001:db8::1]:9000?streamid=%23%21%3A%3Ar%3Dlive%2Fcam1%2Cm%3Dpublish&latency=2000"
+    "&passphrase=correct%20horse%20battery&pbkeylen=32&maxbw=-1&oheadbw=25"
+    "&rcvbuf=12058624&sndbuf=12058624&tlpktdrop=1&mode=caller";
+
+static constexpr int ITERATIONS = 1000000;
+
+using Clock = std::chrono::steady_clock;
+
+static volatile size_t g_sink;
+
+BENCHMARK(srt_url_parse) {
+    char scratch[sizeof(TEST_URL)];
+    SrtUrl url;
+    size_t allocations = benchAllocations();
+    auto start = Clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        if (!parseSrtUrl(TEST_URL, url, scratch, sizeof(scratch))) {
+            benchFail("parse failed");
+            return;
+        }
+        g_sink = g_sink + url.streamId.size();
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ITERATIONS;
+    allocations = benchAllocations() - allocations;
+
+    benchReport("time", ns, "ns/op");
+    benchReport("allocations", (double)allocations, "");
+    if (allocations) benchFail("parseSrtUrl allocated");
+}
+
+BENCHMARK(srt_url_format) {
+    char scratch[sizeof(TEST_URL)];
+    char out[sizeof(TEST_URL) * 3];
+    SrtUrl url;
+    parseSrtUrl(TEST_URL, url, scratch, sizeof(scratch));
+
+    size_t allocations = benchAllocations();
+    auto start = Clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        g_sink = g_sink + formatSrtUrl(url, out, sizeof(out));
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ITERATIONS;
+    allocations = benchAllocations() - allocations;
+
+    benchReport("time", ns, "ns/op");
+    benchReport("allocations", (double)allocations, "");
+    if (allocations) benchFail("formatSrtUrl allocated");
+}
@@ -0,0 +1,64 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Standalone local SRTLA receiver
+ *
+ * Runs the receiver stand-in in front of a local SRT listener (ffplay,
+ * srt-live-transmit, ...) so the plugin can stream end to end on one
+ * machine. Takes the same arguments as srtla_rec, optionally followed by
+ * a reassembly window, and prints statistics every second.
+ *
+ * License: GPL-3.0
+ */
+
+#include "srtla-receiver.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+static volatile sig_atomic_t g_stop = 0;
+
+static void onSignal(int) {
+    g_stop = 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s LISTEN_PORT SRT_HOST SRT_PORT [REORDER_PACKETS [HOLD_MS]]\n", argv[0]);
+        return 2;
+    }
+    int listenPort = atoi(argv[1]);
+    int sinkPort = atoi(argv[3]);
+    if (listenPort <= 0 || listenPort > 65535 || sinkPort <= 0 || sinkPort > 65535) {
+        fprintf(stderr, "Invalid port\n");
+        return 2;
+    }
+
+    SrtlaReceiver receiver;
+    if (argc > 4) {
+        receiver.setReassembly((size_t)atoi(argv[4]), argc > 5 ? atoi(argv[5]) : 50);
+    }
+    if (!receiver.start("::", (uint16_t)listenPort, argv[2], (uint16_t)sinkPort)) {
+        return 1;
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    ReceiverStats last;
+    while (!g_stop) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        ReceiverStats stats = receiver.stats();
+        printf("%.2f Mbit/s  %llu pkts  dup %llu  reordered %llu (depth mean %.1f max %d)  late %llu  links %zu\n",
+               (stats.bytes - last.bytes) * 8 / 1e6,
+               (unsigned long long)stats.packets, (unsigned long long)stats.duplicates,
+               (unsigned long long)stats.reordered, stats.meanReorderDepth, stats.maxReorderDepth,
+               (unsigned long long)stats.late, stats.linkPackets.size());
+        fflush(stdout);
+        last = stats;
+    }
+
+    receiver.stop();
+    return 0;
+}
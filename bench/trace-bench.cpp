@@ -0,0 +1,74 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Link trace replay benchmarks
+ *
+ * Replays the canonical traces through every link scheduler, and once with
+ * adaptive bitrate, on simulated time. Results are deterministic, so runs
+ * of different releases compare number for number.
+ *
+ * License: GPL-3.0
+ */
+
+#include "bench.h"
+#include "canonical-traces.h"
+#include "trace-replay.h"
+
+#include <chrono>
+#include <string>
+
+static void replaySuite(const char* name) {
+    for (const auto& canonical : canonicalTraces()) {
+        if (std::string(canonical.name) != name) continue;
+
+        // Through the file format, as a recorded trace would be
+        LinkTrace trace;
+        std::string error;
+        if (!decodeLinkTrace(encodeLinkTrace(canonical.trace), trace, error)) {
+            benchFail(error.c_str());
+            return;
+        }
+
+        auto report = [](const std::string& label, const TraceReplayResult& result) {
+            benchReport((label + " goodput").c_str(), result.goodputKbps, "kbit/s");
+            benchReport((label + " stalls").c_str(), result.stalls, "");
+            benchReport((label + " stalled").c_str(), result.stalledSeconds, "s");
+            benchReport((label + " latency p50").c_str(), result.latencyP50Ms, "ms");
+            benchReport((label + " latency p99").c_str(), result.latencyP99Ms, "ms");
+        };
+
+        TraceReplayConfig config;
+        auto start = std::chrono::steady_clock::now();
+        double simulated = 0.0;
+        for (LinkSchedulerType type : {LinkSchedulerType::Window, LinkSchedulerType::RttWeighted,
+                                       LinkSchedulerType::LossPenalised, LinkSchedulerType::Priority}) {
+            config.scheduler = type;
+            TraceReplayResult result = replayLinkTrace(trace, config);
+            report(linkSchedulerName(type), result);
+            simulated += result.seconds;
+        }
+
+        config.scheduler = LinkSchedulerType::Window;
+        config.adaptBitrate = true;
+        TraceReplayResult result = replayLinkTrace(trace, config);
+        report("window+abr", result);
+        benchReport("window+abr mean bitrate", result.meanBitrateKbps, "kbit/s");
+        simulated += result.seconds;
+
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        benchReport("replay speed", simulated / wall, "x realtime");
+        return;
+    }
+    benchFail("no such trace");
+}
+
+BENCHMARK(trace_urban_4g_handover) {
+    replaySuite("urban_4g_handover");
+}
+
+BENCHMARK(trace_tunnel_blackout) {
+    replaySuite("tunnel_blackout");
+}
+
+BENCHMARK(trace_congested_stadium) {
+    replaySuite("congested_stadium");
+}
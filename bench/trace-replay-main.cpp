@@ -0,0 +1,98 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Link trace replay tool
+ *
+ * Replays a recorded link trace through every link scheduler and prints
+ * goodput, stalls and latency, or converts it to an impairment script for
+ * a real-time replay through the engine. --export writes the canonical
+ * benchmark traces as trace files.
+ *
+ * License: GPL-3.0
+ */
+
+#include "canonical-traces.h"
+#include "trace-replay.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "Usage: %s TRACE [BITRATE_KBPS [LATENCY_MS]]\n"
+            "       %s --script TRACE\n"
+            "       %s --export DIR\n",
+            argv0, argv0, argv0);
+}
+
+static int exportCanonical(const std::string& dir) {
+    for (const auto& canonical : canonicalTraces()) {
+        std::string path = dir + "/" + canonical.name + ".srtlatrc";
+        if (!saveLinkTrace(path, canonical.trace)) {
+            fprintf(stderr, "Failed to write %s\n", path.c_str());
+            return 1;
+        }
+        printf("%s\n", path.c_str());
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (strcmp(argv[1], "--export") == 0) {
+        if (argc != 3) {
+            usage(argv[0]);
+            return 2;
+        }
+        return exportCanonical(argv[2]);
+    }
+
+    bool script = strcmp(argv[1], "--script") == 0;
+    const char* path = script ? (argc > 2 ? argv[2] : nullptr) : argv[1];
+    if (!path) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    LinkTrace trace;
+    std::string error;
+    if (!loadLinkTrace(path, trace, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    if (script) {
+        fputs(linkTraceToImpairmentScript(trace).c_str(), stdout);
+        return 0;
+    }
+
+    TraceReplayConfig config;
+    if (argc > 2) config.bitrateKbps = atoi(argv[2]);
+    if (argc > 3) config.latencyMs = atoi(argv[3]);
+    if (config.bitrateKbps <= 0 || config.latencyMs <= 0) {
+        fprintf(stderr, "Invalid bitrate or latency\n");
+        return 2;
+    }
+
+    printf("%zu links, %.1f s, %d kbit/s offered, %d ms latency\n", trace.linkNames.size(),
+           trace.durationMs() / 1000.0, config.bitrateKbps, config.latencyMs);
+    printf("%-12s %10s %10s %7s %9s %9s %9s\n", "scheduler", "goodput", "bitrate", "stalls", "stalled",
+           "p50 ms", "p99 ms");
+
+    auto print = [](const char* name, const TraceReplayResult& result) {
+        printf("%-12s %10.0f %10.0f %7d %8.2fs %9.1f %9.1f\n", name, result.goodputKbps, result.meanBitrateKbps,
+               result.stalls, result.stalledSeconds, result.latencyP50Ms, result.latencyP99Ms);
+    };
+    for (LinkSchedulerType type : {LinkSchedulerType::Window, LinkSchedulerType::RttWeighted,
+                                   LinkSchedulerType::LossPenalised, LinkSchedulerType::Priority}) {
+        config.scheduler = type;
+        print(linkSchedulerName(type), replayLinkTrace(trace, config));
+    }
+    config.scheduler = LinkSchedulerType::Window;
+    config.adaptBitrate = true;
+    print("window+abr", replayLinkTrace(trace, config));
+    return 0;
+}
@@ -0,0 +1,51 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * SRT URL round-trip fuzz target
+ *
+ * libFuzzer entry point: any URL the parser accepts must survive
+ * format -> parse unchanged, and formatting must be stable.
+ *
+ * License: GPL-3.0
+ */
+
+#include "srt-url.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    std::string_view input(reinterpret_cast<const char*>(data), size);
+
+    std::vector<char> scratch(size + 1);
+    SrtUrl parsed;
+    if (!parseSrtUrl(input, parsed, scratch.data(), scratch.size())) {
+        return 0;
+    }
+
+    // Size query, then a truncated write that must still be terminated
+    size_t len = formatSrtUrl(parsed, nullptr, 0);
+    std::vector<char> formatted(len + 1);
+    if (formatSrtUrl(parsed, formatted.data(), formatted.size()) != len || formatted[len] != '\0') {
+        abort();
+    }
+    char small[8];
+    formatSrtUrl(parsed, small, sizeof(small));
+    if (small[len < sizeof(small) ? len : sizeof(small) - 1] != '\0') {
+        abort();
+    }
+
+    std::string_view first(formatted.data(), len);
+    std::vector<char> scratch2(len + 1);
+    SrtUrl reparsed;
+    if (!parseSrtUrl(first, reparsed, scratch2.data(), scratch2.size()) || reparsed != parsed) {
+        abort();
+    }
+
+    std::vector<char> again(len + 1);
+    formatSrtUrl(reparsed, again.data(), again.size());
+    if (std::string_view(again.data(), len) != first) {
+        abort();
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Crash-safe file replacement
+ *
+ * Used for settings and other files that must never be left half written,
+ * e.g. on SD-card-based encoders that lose power without shutting down.
+ *
+ * License: GPL-3.0
+ */
+
+#include "atomic-file.h"
+#include "srtla-log.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+static bool writeAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+bool atomicWriteFile(const std::string& path, const std::string& contents) {
+    std::string tmpPath = path + ".tmp";
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        srtla_log(SRTLA_LOG_ERROR, "Failed to create %s: %s", tmpPath.c_str(), strerror(errno));
+        return false;
+    }
+
+    bool ok = writeAll(fd, contents.data(), contents.size()) && fsync(fd) == 0;
+    int err = errno;
+    if (close(fd) != 0 && ok) {
+        ok = false;
+        err = errno;
+    }
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        if (ok) err = errno;
+        srtla_log(SRTLA_LOG_ERROR, "Failed to write %s: %s", path.c_str(), strerror(err));
+        unlink(tmpPath.c_str());
+        return false;
+    }
+
+    // Make the rename itself durable
+    size_t slash = path.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int dirFd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+    return true;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+
+// Replace path with contents so that readers, and the file after a crash or
+// power loss, only ever see the old or the new contents in full.
+//
+// Writes path + ".tmp", fsyncs it, renames it over path and fsyncs the
+// directory. Returns false and leaves path untouched on failure.
+bool atomicWriteFile(const std::string& path, const std::string& contents);
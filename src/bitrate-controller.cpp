@@ -0,0 +1,127 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Adaptive encoder bitrate control
+ *
+ * Turns per-link ACK/NAK feedback into a target video bitrate, so that
+ * congestion on the bonded links lowers picture quality instead of
+ * stalling the stream.
+ *
+ * License: GPL-3.0
+ */
+
+#include "bitrate-controller.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+// Base RTT creeps up by this fraction per snapshot, so a permanent route
+// change is eventually accepted as the new normal
+static constexpr double BASE_RTT_DRIFT = 0.001;
+
+BitrateController::BitrateController()
+    : m_targetKbps(0.0),
+      m_appliedKbps(0),
+      m_baseRttMs(-1.0),
+      m_congested(false),
+      m_lastDecreaseMs(INT64_MIN / 2),
+      m_lastIncreaseMs(INT64_MIN / 2),
+      m_lastCongestionMs(INT64_MIN / 2) {
+}
+
+void BitrateController::configure(const BitrateControllerConfig& config) {
+    m_config = config;
+    if (m_config.ceilingKbps < m_config.floorKbps) {
+        m_config.ceilingKbps = m_config.floorKbps;
+    }
+    m_targetKbps = clamp(m_targetKbps);
+}
+
+void BitrateController::reset(int startKbps) {
+    m_targetKbps = clamp(startKbps);
+    m_appliedKbps = (int)m_targetKbps;
+    m_baseRttMs = -1.0;
+    m_congested = false;
+    m_lastDecreaseMs = INT64_MIN / 2;
+    m_lastIncreaseMs = INT64_MIN / 2;
+    m_lastCongestionMs = INT64_MIN / 2;
+}
+
+double BitrateController::clamp(double kbps) const {
+    return std::min(std::max(kbps, (double)m_config.floorKbps), (double)m_config.ceilingKbps);
+}
+
+bool BitrateController::detectCongestion(const SenderStats& stats) {
+    double packets = 0.0;
+    double naks = 0.0;
+    double rttSum = 0.0;
+    double rttWeight = 0.0;
+    int inFlight = 0;
+    int window = 0;
+    int registered = 0;
+
+    for (const auto& link : stats.links) {
+        if (!link.registered) continue;
+        registered++;
+        packets += link.packetsPerSec;
+        naks += link.naksPerSec;
+        inFlight += link.inFlight;
+        window += link.window;
+
+        // Traffic-weighted RTT, so an idle backup link does not dominate
+        if (link.rttMs >= 0.0) {
+            double weight = std::max(link.packetsPerSec, 1.0);
+            rttSum += link.rttMs * weight;
+            rttWeight += weight;
+        }
+    }
+
+    // Nothing to judge without registered links, keep the current target
+    if (registered == 0 || packets <= 0.0) {
+        return false;
+    }
+
+    bool lossy = naks / packets > m_config.lossThreshold;
+    bool windowFull = window > 0 && inFlight >= m_config.windowFullRatio * window;
+
+    bool rttInflated = false;
+    if (rttWeight > 0.0) {
+        double rtt = rttSum / rttWeight;
+        if (m_baseRttMs < 0.0 || rtt < m_baseRttMs) {
+            m_baseRttMs = rtt;
+        } else {
+            m_baseRttMs += (rtt - m_baseRttMs) * BASE_RTT_DRIFT;
+        }
+        rttInflated = rtt > m_baseRttMs * m_config.rttInflation + m_config.rttSlackMs;
+    }
+
+    return lossy || windowFull || rttInflated;
+}
+
+bool BitrateController::update(const SenderStats& stats, int64_t nowMs) {
+    m_congested = detectCongestion(stats);
+
+    if (m_congested) {
+        m_lastCongestionMs = nowMs;
+        if (nowMs - m_lastDecreaseMs >= m_config.decreaseIntervalMs) {
+            m_targetKbps = clamp(m_targetKbps * m_config.decreaseFactor);
+            m_lastDecreaseMs = nowMs;
+        }
+    } else if (nowMs - m_lastCongestionMs >= m_config.increaseHoldMs &&
+               nowMs - m_lastIncreaseMs >= m_config.increaseIntervalMs) {
+        int step = m_config.increaseStepKbps > 0 ? m_config.increaseStepKbps :
+                   std::max(m_config.ceilingKbps / 20, 1);
+        m_targetKbps = clamp(m_targetKbps + step);
+        m_lastIncreaseMs = nowMs;
+    }
+
+    // Hysteresis: only move the encoder for meaningful changes, or to reach a limit
+    int target = (int)std::lround(m_targetKbps);
+    bool atLimit = target == m_config.floorKbps || target == m_config.ceilingKbps;
+    double change = std::fabs((double)target - m_appliedKbps);
+    if (target != m_appliedKbps && (change >= m_config.deadband * m_appliedKbps || atLimit)) {
+        m_appliedKbps = target;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+#include "link-stats.h"
+
+struct BitrateControllerConfig {
+    int floorKbps = 500;
+    int ceilingKbps = 6000;
+    double lossThreshold = 0.02;      // NAKed fraction of sent packets that counts as congestion
+    double rttInflation = 1.5;        // RTT above base * inflation (+ slack) counts as congestion
+    double rttSlackMs = 20.0;
+    double windowFullRatio = 0.9;     // in-flight / window above this counts as congestion
+    double decreaseFactor = 0.85;     // multiplicative decrease per congestion event
+    int increaseStepKbps = 0;         // additive increase, 0 = 5% of the ceiling
+    int decreaseIntervalMs = 1000;    // at most one decrease per interval
+    int increaseHoldMs = 5000;        // quiet time after congestion before increasing
+    int increaseIntervalMs = 1000;    // at most one increase per interval
+    double deadband = 0.05;           // relative change needed before a new bitrate is applied
+};
+
+// AIMD encoder bitrate control from bonded link feedback.
+//
+// Each statistics snapshot is checked for congestion: NAK loss, RTT inflation
+// over the lowest RTT seen, or links running out of window. Congestion cuts
+// the target multiplicatively; a quiet period grows it additively. The
+// applied bitrate only follows the target when it moves by more than the
+// deadband, so small oscillations never reach the encoder.
+class BitrateController {
+public:
+    BitrateController();
+
+    void configure(const BitrateControllerConfig& config);
+    const BitrateControllerConfig& config() const { return m_config; }
+
+    // Start over from startKbps (clamped to floor/ceiling)
+    void reset(int startKbps);
+
+    // Feed one snapshot. Returns true when appliedKbps() changed.
+    bool update(const SenderStats& stats, int64_t nowMs);
+
+    int targetKbps() const { return (int)m_targetKbps; }
+    int appliedKbps() const { return m_appliedKbps; }
+
+    // Whether the last snapshot was judged congested
+    bool isCongested() const { return m_congested; }
+
+private:
+    bool detectCongestion(const SenderStats& stats);
+    double clamp(double kbps) const;
+
+    BitrateControllerConfig m_config;
+    double m_targetKbps;
+    int m_appliedKbps;
+    double m_baseRttMs;
+    bool m_congested;
+    int64_t m_lastDecreaseMs;
+    int64_t m_lastIncreaseMs;
+    int64_t m_lastCongestionMs;
+};
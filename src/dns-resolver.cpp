@@ -0,0 +1,203 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Asynchronous DNS resolution
+ *
+ * Resolves the SRTLA server name off the calling thread and keeps the
+ * result cached and refreshed, so starting the sender never waits on DNS.
+ *
+ * License: GPL-3.0
+ */
+
+#include "dns-resolver.h"
+#include "srtla-log.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+// Lifetime of a cached lookup, a watched host is refreshed this long before expiry
+static constexpr int DNS_CACHE_TTL_MS = 60000;
+static constexpr int DNS_REFRESH_AHEAD_MS = 10000;
+
+// Retry interval after a failed lookup; stale addresses stay usable meanwhile
+static constexpr int DNS_RETRY_MS = 5000;
+
+DnsResolver::DnsResolver()
+    : m_watchNotified(false),
+      m_stopRequested(false) {
+    m_thread = std::thread(&DnsResolver::run, this);
+}
+
+DnsResolver::~DnsResolver() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_cond.notify_all();
+    m_thread.join();
+}
+
+bool DnsResolver::isAddress(const std::string& host) {
+    uint8_t buf[sizeof(in6_addr)];
+    return inet_pton(AF_INET, host.c_str(), buf) == 1 || inet_pton(AF_INET6, host.c_str(), buf) == 1;
+}
+
+bool DnsResolver::lookup(const std::string& host, std::vector<std::string>& addresses) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_cache.find(host);
+    if (it == m_cache.end() || Clock::now() >= it->second.expires) {
+        queueLocked(host);
+        it = m_cache.find(host);
+    }
+    if (it->second.addresses.empty()) {
+        return false;
+    }
+    addresses = it->second.addresses;
+    return true;
+}
+
+void DnsResolver::watch(const std::string& host, Callback callback) {
+    std::lock_guard<std::mutex> callbackLock(m_callbackMutex);
+    std::vector<std::string> cached;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_watchHost = host;
+        m_watchCallback = std::move(callback);
+        m_watchReported.clear();
+        m_watchNotified = false;
+
+        // Report a cached result right away, otherwise resolve it first
+        auto it = m_cache.find(host);
+        if (it != m_cache.end() && !it->second.addresses.empty()) {
+            cached = it->second.addresses;
+            m_watchReported = cached;
+            m_watchNotified = true;
+        }
+        if (it == m_cache.end() || Clock::now() >= it->second.expires) {
+            queueLocked(host);
+        }
+        m_cond.notify_all();
+    }
+    if (!cached.empty()) {
+        m_watchCallback(cached);
+    }
+}
+
+void DnsResolver::unwatch() {
+    std::lock_guard<std::mutex> callbackLock(m_callbackMutex);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_watchHost.clear();
+    m_watchCallback = nullptr;
+    m_watchReported.clear();
+    m_watchNotified = false;
+}
+
+void DnsResolver::queueLocked(const std::string& host) {
+    Entry& entry = m_cache[host];
+    if (entry.queued) return;
+    entry.queued = true;
+    m_queue.push_back(host);
+    m_cond.notify_all();
+}
+
+bool DnsResolver::resolve(const std::string& host, std::vector<std::string>& addresses) {
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    addrinfo* result = nullptr;
+    int err = getaddrinfo(host.c_str(), nullptr, &hints, &result);
+    if (err != 0) {
+        srtla_log(SRTLA_LOG_WARNING, "Could not resolve %s: %s", host.c_str(), gai_strerror(err));
+        return false;
+    }
+
+    addresses.clear();
+    for (addrinfo* ai = result; ai; ai = ai->ai_next) {
+        char ip[INET6_ADDRSTRLEN];
+        const void* addr = ai->ai_family == AF_INET ?
+            (const void*)&((const sockaddr_in*)ai->ai_addr)->sin_addr :
+            (const void*)&((const sockaddr_in6*)ai->ai_addr)->sin6_addr;
+        if ((ai->ai_family != AF_INET && ai->ai_family != AF_INET6) ||
+            !inet_ntop(ai->ai_family, addr, ip, sizeof(ip))) {
+            continue;
+        }
+        if (std::find(addresses.begin(), addresses.end(), ip) == addresses.end()) {
+            addresses.push_back(ip);
+        }
+    }
+    freeaddrinfo(result);
+
+    // Keep the resolver's order within each family, IPv4 first
+    std::stable_partition(addresses.begin(), addresses.end(), [](const std::string& ip) {
+        return ip.find(':') == std::string::npos;
+    });
+    return !addresses.empty();
+}
+
+void DnsResolver::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopRequested) {
+        // Refresh the watched host ahead of expiry, so it never goes stale
+        Clock::time_point wakeAt = Clock::time_point::max();
+        if (!m_watchHost.empty()) {
+            Entry& entry = m_cache[m_watchHost];
+            if (!entry.queued && Clock::now() >= entry.refresh) {
+                queueLocked(m_watchHost);
+            } else if (!entry.queued) {
+                wakeAt = entry.refresh;
+            }
+        }
+
+        if (m_queue.empty()) {
+            if (wakeAt == Clock::time_point::max()) {
+                m_cond.wait(lock);
+            } else {
+                m_cond.wait_until(lock, wakeAt);
+            }
+            continue;
+        }
+
+        std::string host = m_queue.front();
+        m_queue.erase(m_queue.begin());
+        lock.unlock();
+
+        std::vector<std::string> addresses;
+        bool ok = resolve(host, addresses);
+
+        // Callback lock first, the same order as watch() and unwatch()
+        std::unique_lock<std::mutex> callbackLock(m_callbackMutex);
+        lock.lock();
+
+        Entry& entry = m_cache[host];
+        entry.queued = false;
+        if (ok) {
+            if (addresses != entry.addresses) {
+                srtla_log(SRTLA_LOG_INFO, "Resolved %s to %zu address(es), first %s",
+                          host.c_str(), addresses.size(), addresses[0].c_str());
+            }
+            entry.addresses = addresses;
+            entry.expires = Clock::now() + std::chrono::milliseconds(DNS_CACHE_TTL_MS);
+            entry.refresh = entry.expires - std::chrono::milliseconds(DNS_REFRESH_AHEAD_MS);
+        } else {
+            entry.expires = Clock::now() + std::chrono::milliseconds(DNS_RETRY_MS);
+            entry.refresh = entry.expires;
+        }
+
+        bool notify = ok && host == m_watchHost && m_watchCallback &&
+                      (!m_watchNotified || addresses != m_watchReported);
+        if (!notify) continue;
+
+        m_watchReported = addresses;
+        m_watchNotified = true;
+        Callback callback = m_watchCallback;
+        lock.unlock();
+        callback(addresses);
+        callbackLock.unlock();
+        lock.lock();
+    }
+}
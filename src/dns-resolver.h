@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Non-blocking, cached host name resolution.
+//
+// Lookups run getaddrinfo() on a worker thread; callers only ever read the
+// cache. getaddrinfo() does not expose record TTLs, so entries live for a
+// fixed time and a watched host is refreshed in the background before its
+// entry expires. Both A and AAAA records are kept, IPv4 addresses first.
+class DnsResolver {
+public:
+    using Callback = std::function<void(const std::vector<std::string>& addresses)>;
+
+    DnsResolver();
+    ~DnsResolver();
+
+    // Cached addresses of host, possibly stale. Never blocks: a miss or an
+    // expired entry queues a background lookup. Returns false on a miss.
+    bool lookup(const std::string& host, std::vector<std::string>& addresses);
+
+    // Keep host resolved. The callback runs on the resolver thread after the
+    // first successful lookup and whenever a refresh changes the address set.
+    // Replaces any previous watch.
+    void watch(const std::string& host, Callback callback);
+
+    // Stop watching. No callback is running or will run once this returns,
+    // so it must not be called from within the callback.
+    void unwatch();
+
+    // Whether host is a numeric IPv4 or IPv6 address that needs no lookup
+    static bool isAddress(const std::string& host);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::vector<std::string> addresses;
+        Clock::time_point expires;
+        Clock::time_point refresh;   // when a watched entry is looked up again
+        bool queued = false;
+    };
+
+    void run();
+    void queueLocked(const std::string& host);
+    static bool resolve(const std::string& host, std::vector<std::string>& addresses);
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::map<std::string, Entry> m_cache;
+    std::vector<std::string> m_queue;
+
+    // Watched host and the addresses last reported for it
+    std::string m_watchHost;
+    Callback m_watchCallback;
+    std::vector<std::string> m_watchReported;
+    bool m_watchNotified;
+
+    // Held while a callback runs, so unwatch() can wait for it
+    std::mutex m_callbackMutex;
+
+    std::thread m_thread;
+    bool m_stopRequested;
+};
@@ -0,0 +1,131 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Network interface classification
+ *
+ * License: GPL-3.0
+ */
+
+#include "interface-class.h"
+
+#include <fstream>
+
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// ARP hardware types from <linux/if_arp.h>
+static constexpr int ARPHRD_TYPE_ETHER = 1;
+static constexpr int ARPHRD_TYPE_PPP = 512;
+static constexpr int ARPHRD_TYPE_RAWIP = 519;
+static constexpr int ARPHRD_TYPE_TUNNEL = 768;
+static constexpr int ARPHRD_TYPE_TUNNEL6 = 769;
+static constexpr int ARPHRD_TYPE_LOOPBACK = 772;
+static constexpr int ARPHRD_TYPE_SIT = 776;
+static constexpr int ARPHRD_TYPE_IPGRE = 778;
+static constexpr int ARPHRD_TYPE_IP6GRE = 823;
+static constexpr int ARPHRD_TYPE_NONE = 0xFFFE;
+
+// USB networking drivers of phones sharing their mobile data. Modems using
+// the same class drivers are flagged as WWAN by usbnet and never get here.
+static const char* const TETHER_DRIVERS[] = {"rndis_host", "ipheth", "cdc_ncm", "cdc_ether", "cdc_eem"};
+
+static bool exists(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
+}
+
+// Last path component of a symlink target, empty if there is no link
+static std::string linkTarget(const std::string& path) {
+    char buf[PATH_MAX];
+    ssize_t n = readlink(path.c_str(), buf, sizeof(buf) - 1);
+    if (n <= 0) return std::string();
+    std::string target(buf, (size_t)n);
+    size_t slash = target.rfind('/');
+    return slash == std::string::npos ? target : target.substr(slash + 1);
+}
+
+static std::string ueventValue(const std::string& path, const std::string& key) {
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, key.size() + 1, key + "=") == 0) return line.substr(key.size() + 1);
+    }
+    return std::string();
+}
+
+InterfaceType classifyInterface(const std::string& name, const std::string& sysfsRoot) {
+    const std::string dir = sysfsRoot + "/" + name;
+    int arpType = -1;
+    {
+        std::ifstream in(dir + "/type");
+        if (!(in >> arpType)) return InterfaceType::Unknown;
+    }
+    std::string devType = ueventValue(dir + "/uevent", "DEVTYPE");
+    std::string driver = linkTarget(dir + "/device/driver");
+
+    switch (arpType) {
+    case ARPHRD_TYPE_PPP:
+    case ARPHRD_TYPE_RAWIP:
+        return InterfaceType::Cellular;
+    case ARPHRD_TYPE_TUNNEL:
+    case ARPHRD_TYPE_TUNNEL6:
+    case ARPHRD_TYPE_SIT:
+    case ARPHRD_TYPE_IPGRE:
+    case ARPHRD_TYPE_IP6GRE:
+    case ARPHRD_TYPE_NONE:   // tun, WireGuard
+        return InterfaceType::Tunnel;
+    case ARPHRD_TYPE_LOOPBACK:
+        return InterfaceType::Virtual;
+    default:
+        break;
+    }
+
+    // A WWAN control port next to the network device marks a modem whatever
+    // its data interface looks like
+    if (devType == "wwan" || exists(dir + "/device/wwan")) return InterfaceType::Cellular;
+    if (devType == "wlan" || exists(dir + "/wireless") || exists(dir + "/phy80211")) {
+        return InterfaceType::Wireless;
+    }
+    for (const char* tether : TETHER_DRIVERS) {
+        if (driver == tether) return InterfaceType::Tether;
+    }
+
+    // Interfaces without a device behind them are built on other interfaces
+    if (arpType == ARPHRD_TYPE_ETHER && exists(dir + "/device")) return InterfaceType::Ethernet;
+    return InterfaceType::Virtual;
+}
+
+int interfacePriority(InterfaceType type) {
+    switch (type) {
+    case InterfaceType::Cellular:
+    case InterfaceType::Tether:
+    case InterfaceType::Tunnel:
+        return 1;
+    case InterfaceType::Ethernet:
+    case InterfaceType::Wireless:
+    case InterfaceType::Virtual:
+    case InterfaceType::Unknown:
+    default:
+        return 0;
+    }
+}
+
+const char* interfaceTypeName(InterfaceType type) {
+    switch (type) {
+    case InterfaceType::Ethernet:
+        return "ethernet";
+    case InterfaceType::Wireless:
+        return "wireless";
+    case InterfaceType::Cellular:
+        return "cellular";
+    case InterfaceType::Tether:
+        return "tether";
+    case InterfaceType::Tunnel:
+        return "tunnel";
+    case InterfaceType::Virtual:
+        return "virtual";
+    case InterfaceType::Unknown:
+    default:
+        return "unknown";
+    }
+}
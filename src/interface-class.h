@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+enum class InterfaceType {
+    Unknown,    // no sysfs entry
+    Ethernet,   // wired NIC or USB Ethernet adapter
+    Wireless,   // WiFi
+    Cellular,   // modem: WWAN, raw-IP or PPP
+    Tether,     // phone sharing its mobile data over USB (RNDIS, NCM, iPhone)
+    Tunnel,     // VPN or IP tunnel
+    Virtual     // bridge, bond, VLAN, veth, ... on top of other interfaces
+};
+
+// Classifies a network interface from what the kernel reports about it in
+// sysfs: the ARP hardware type, the uevent DEVTYPE, the bound driver and a
+// WWAN control device, rather than from its name. USB modems and tethered
+// phones show up as usb0, wwan0 or enx... and look like Ethernet by name.
+//
+// Reads a handful of small files, so callers cache the result per interface
+// index. sysfsRoot is only changed by tests.
+InterfaceType classifyInterface(const std::string& name, const std::string& sysfsRoot = "/sys/class/net");
+
+// Scheduling tier of a link over such an interface, for the priority
+// scheduler: metered and second-hand uplinks only take the overflow
+int interfacePriority(InterfaceType type);
+
+const char* interfaceTypeName(InterfaceType type);
@@ -0,0 +1,55 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Background job queue
+ *
+ * Serial worker for slow work that must stay off the Qt UI thread, such
+ * as syncing the OBS streaming service.
+ *
+ * License: GPL-3.0
+ */
+
+#include "job-queue.h"
+
+#include <algorithm>
+
+JobQueue::JobQueue()
+    : m_stopRequested(false) {
+    m_thread = std::thread(&JobQueue::run, this);
+}
+
+JobQueue::~JobQueue() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_cond.notify_all();
+    m_thread.join();
+}
+
+void JobQueue::post(Job job, const std::string& key) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = key.empty() ? m_jobs.end() :
+            std::find_if(m_jobs.begin(), m_jobs.end(), [&](const Entry& entry) { return entry.key == key; });
+        if (it != m_jobs.end()) {
+            it->job = std::move(job);
+        } else {
+            m_jobs.push_back({key, std::move(job)});
+        }
+    }
+    m_cond.notify_all();
+}
+
+void JobQueue::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cond.wait(lock, [this]() { return m_stopRequested || !m_jobs.empty(); });
+        if (m_jobs.empty()) break;
+
+        Job job = std::move(m_jobs.front().job);
+        m_jobs.pop_front();
+        lock.unlock();
+        job();
+        lock.lock();
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Runs jobs one at a time on a worker thread, in the order they were posted.
+//
+// A job posted with a key replaces a queued job with the same key that has
+// not started yet, so a burst of identical requests runs once, with the
+// newest state.
+class JobQueue {
+public:
+    using Job = std::function<void()>;
+
+    JobQueue();
+
+    // Runs every job already posted, then stops the worker
+    ~JobQueue();
+
+    void post(Job job, const std::string& key = std::string());
+
+private:
+    void run();
+
+    struct Entry {
+        std::string key;
+        Job job;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<Entry> m_jobs;
+    bool m_stopRequested;
+    std::thread m_thread;
+};
@@ -0,0 +1,207 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Userspace link impairment
+ *
+ * Scripted delay, jitter, burst loss, rate limits and blackouts on the
+ * engine's uplinks, for reproducible bonding tests without root, tc or
+ * netem.
+ *
+ * License: GPL-3.0
+ */
+
+#include "link-impairment.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+static bool parseNumber(const std::string& text, double min, double max, double& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    value = strtod(text.c_str(), &end);
+    return *end == '\0' && value >= min && value <= max;
+}
+
+static bool applySetting(const std::string& setting, ImpairmentParams& params) {
+    size_t eq = setting.find('=');
+    if (eq == std::string::npos) return false;
+    std::string key = setting.substr(0, eq);
+    std::string value = setting.substr(eq + 1);
+
+    double number;
+    if (key == "delay" || key == "jitter" || key == "queue" || key == "rate") {
+        if (!parseNumber(value, 0.0, 1e9, number)) return false;
+        double& field = key == "delay" ? params.delayMs : key == "jitter" ? params.jitterMs :
+                        key == "queue" ? params.queueMs : params.rateKbps;
+        field = number;
+    } else if (key == "loss") {
+        if (!parseNumber(value, 0.0, 100.0, number)) return false;
+        params.lossGood = number / 100.0;
+    } else if (key == "ge") {
+        std::vector<std::string> parts;
+        std::stringstream ss(value);
+        std::string part;
+        while (std::getline(ss, part, ',')) parts.push_back(part);
+        double p, r, bad = 100.0;
+        if (parts.size() < 2 || parts.size() > 3 || !parseNumber(parts[0], 0.0, 1.0, p) ||
+            !parseNumber(parts[1], 0.0, 1.0, r) || (parts.size() == 3 && !parseNumber(parts[2], 0.0, 100.0, bad))) {
+            return false;
+        }
+        params.geP = p;
+        params.geR = r;
+        params.lossBad = bad / 100.0;
+    } else if (key == "blackout") {
+        if (value == "on" || value == "1") {
+            params.blackout = true;
+        } else if (value == "off" || value == "0") {
+            params.blackout = false;
+        } else {
+            return false;
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ImpairmentScript::parse(const std::string& text, ImpairmentScript& out, std::string& error) {
+    out = ImpairmentScript();
+    std::map<std::string, ImpairmentParams> states;
+    states["*"] = ImpairmentParams();
+    int64_t lastMs = 0;
+
+    std::istringstream lines(text);
+    std::string line;
+    for (int lineNo = 1; std::getline(lines, line); lineNo++) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream tokens(line);
+        std::string first;
+        if (!(tokens >> first)) continue;
+
+        auto fail = [&](const std::string& message) {
+            error = "line " + std::to_string(lineNo) + ": " + message;
+            return false;
+        };
+
+        std::string arg;
+        if (first == "seed" || first == "loop") {
+            double value;
+            if (!(tokens >> arg) || !parseNumber(arg, 0.0, 1e15, value)) return fail("expected a number");
+            if (first == "seed") {
+                out.m_seed = (uint64_t)value;
+            } else {
+                out.m_loopMs = (int64_t)value;
+            }
+            continue;
+        }
+
+        double atMs;
+        if (!parseNumber(first, 0.0, 1e15, atMs)) return fail("expected a time in ms");
+        if ((int64_t)atMs < lastMs) return fail("times must not decrease");
+        lastMs = (int64_t)atMs;
+
+        std::string selector;
+        if (!(tokens >> selector)) return fail("expected a link");
+        std::vector<std::string> settings;
+        while (tokens >> arg) settings.push_back(arg);
+        if (settings.empty()) return fail("expected settings");
+
+        // A link first named here starts from the current settings of all links
+        if (!states.count(selector)) {
+            states[selector] = states["*"];
+        }
+        for (auto& state : states) {
+            if (selector != "*" && state.first != selector) continue;
+            for (const auto& setting : settings) {
+                if (!applySetting(setting, state.second)) return fail("bad setting " + setting);
+            }
+            out.m_timelines[state.first].push_back({lastMs, state.second});
+        }
+    }
+    return true;
+}
+
+bool ImpairmentScript::load(const std::string& path, ImpairmentScript& out, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::stringstream contents;
+    contents << in.rdbuf();
+    if (!parse(contents.str(), out, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+const ImpairmentScript::Step* ImpairmentScript::stepAt(const std::vector<Step>& timeline, int64_t ms) {
+    auto it = std::upper_bound(timeline.begin(), timeline.end(), ms,
+                               [](int64_t t, const Step& step) { return t < step.atMs; });
+    return it == timeline.begin() ? nullptr : &*(it - 1);
+}
+
+ImpairmentParams ImpairmentScript::paramsAt(const std::string& sourceIp, size_t index, int64_t ms) const {
+    if (m_loopMs > 0) {
+        ms %= m_loopMs;
+    }
+
+    // The most recent step naming this link, else the one for all links
+    const Step* best = nullptr;
+    for (const std::string& selector : {sourceIp, std::to_string(index)}) {
+        auto it = m_timelines.find(selector);
+        if (it == m_timelines.end()) continue;
+        const Step* step = stepAt(it->second, ms);
+        if (step && (!best || step->atMs > best->atMs)) best = step;
+    }
+    if (!best) {
+        auto it = m_timelines.find("*");
+        if (it != m_timelines.end()) best = stepAt(it->second, ms);
+    }
+    return best ? best->params : ImpairmentParams();
+}
+
+LinkImpairment::LinkImpairment(uint64_t seed)
+    : m_rng(seed) {
+}
+
+bool LinkImpairment::admit(size_t len, Clock::time_point now, Clock::time_point& releaseAt) {
+    if (m_params.blackout) {
+        m_lost++;
+        return false;
+    }
+
+    // The loss channel changes state once per packet
+    if (m_bad) {
+        if (uniform() < m_params.geR) m_bad = false;
+    } else if (uniform() < m_params.geP) {
+        m_bad = true;
+    }
+    double loss = m_bad ? m_params.lossBad : m_params.lossGood;
+    if (loss > 0.0 && uniform() < loss) {
+        m_lost++;
+        return false;
+    }
+
+    // Bottleneck: packets leave one after another at the link rate
+    Clock::time_point departure = now;
+    if (m_params.rateKbps > 0.0) {
+        if (m_busyUntil < now) m_busyUntil = now;
+        if (m_busyUntil - now > std::chrono::duration<double, std::milli>(m_params.queueMs)) {
+            m_queueDrops++;
+            return false;
+        }
+        m_busyUntil += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(len * 8.0 / (m_params.rateKbps * 1000.0)));
+        departure = m_busyUntil;
+    }
+
+    double delayMs = m_params.delayMs + (m_params.jitterMs > 0.0 ? uniform() * m_params.jitterMs : 0.0);
+    releaseAt = departure + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(delayMs));
+    releaseAt = std::max(releaseAt, m_lastRelease);
+    m_lastRelease = releaseAt;
+    return true;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// Conditions of one emulated uplink. The defaults let everything through.
+struct ImpairmentParams {
+    double delayMs = 0.0;     // one-way delay added on the uplink
+    double jitterMs = 0.0;    // extra delay, uniform in [0, jitterMs]; packet order is kept
+    double rateKbps = 0.0;    // bottleneck rate, 0 for unlimited
+    double queueMs = 100.0;   // bottleneck buffer: packets that would queue longer are dropped
+
+    // Gilbert-Elliott loss. Per packet the channel moves Good -> Bad with
+    // probability geP and Bad -> Good with geR, and loses the packet with
+    // lossGood or lossBad. geP = 0 with lossGood > 0 is plain random loss.
+    double geP = 0.0;
+    double geR = 1.0;
+    double lossGood = 0.0;
+    double lossBad = 1.0;
+
+    bool blackout = false;    // nothing gets through, in either direction
+};
+
+// Scripted link conditions over time, read from a text file:
+//
+//     # ms     link        settings
+//     seed     42
+//     loop     30000
+//     0        *           delay=25 jitter=10 rate=8000
+//     0        1           loss=1 ge=0.01,0.25
+//     12000    10.0.0.2    blackout=on
+//     15000    10.0.0.2    blackout=off
+//
+// A step changes only the settings it names, from its time on. Links are
+// selected by source IP, by the order they were added ("0", "1", ...), or
+// all with "*". Settings: delay, jitter, queue (ms), rate (kbit/s, 0 for
+// unlimited), loss (percent, random loss in the Good state), ge=p,r[,bad]
+// (Gilbert-Elliott transition probabilities, and the loss percentage in
+// the Bad state, 100 by default) and blackout=on|off. "loop" restarts the
+// script after the given number of ms; "seed" fixes the random sequence.
+class ImpairmentScript {
+public:
+    // Conditions of the link with this source IP and index, ms after start
+    ImpairmentParams paramsAt(const std::string& sourceIp, size_t index, int64_t ms) const;
+
+    uint64_t seed() const { return m_seed; }
+    int64_t loopMs() const { return m_loopMs; }
+
+    // Returns false with a message naming the offending line on error
+    static bool parse(const std::string& text, ImpairmentScript& out, std::string& error);
+    static bool load(const std::string& path, ImpairmentScript& out, std::string& error);
+
+private:
+    struct Step {
+        int64_t atMs;
+        ImpairmentParams params;  // complete state of the selector from atMs on
+    };
+
+    static const Step* stepAt(const std::vector<Step>& timeline, int64_t ms);
+
+    // Keyed by selector, each timeline sorted by time. Changes to "*" are
+    // copied into every other timeline so one lookup suffices.
+    std::map<std::string, std::vector<Step>> m_timelines;
+    uint64_t m_seed = 1;
+    int64_t m_loopMs = 0;
+};
+
+// Emulates one uplink for outgoing packets: blackout, Gilbert-Elliott
+// loss, a rate-limited bottleneck queue, then delay and jitter.
+class LinkImpairment {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit LinkImpairment(uint64_t seed);
+
+    void setParams(const ImpairmentParams& params) { m_params = params; }
+    const ImpairmentParams& params() const { return m_params; }
+
+    // Fate of a packet of len bytes sent at now. Returns false if the link
+    // loses it, otherwise releaseAt is when it leaves the emulated link.
+    bool admit(size_t len, Clock::time_point now, Clock::time_point& releaseAt);
+
+    uint64_t lost() const { return m_lost; }              // random and burst loss, blackouts
+    uint64_t queueDrops() const { return m_queueDrops; }  // bottleneck buffer overflow
+
+private:
+    double uniform() { return std::uniform_real_distribution<double>(0.0, 1.0)(m_rng); }
+
+    ImpairmentParams m_params;
+    std::mt19937_64 m_rng;
+    bool m_bad = false;
+    Clock::time_point m_busyUntil;    // bottleneck done with the packets so far
+    Clock::time_point m_lastRelease;  // keeps jitter from reordering
+    uint64_t m_lost = 0;
+    uint64_t m_queueDrops = 0;
+};
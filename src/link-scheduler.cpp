@@ -0,0 +1,164 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Link scheduling strategies
+ *
+ * Decides which uplink carries each SRT packet. Kept free of OBS and socket
+ * code so the strategies can be replayed against recorded link traces.
+ *
+ * License: GPL-3.0
+ */
+
+#include "link-scheduler.h"
+#include "srtla-protocol.h"
+
+#include <algorithm>
+#include <climits>
+
+// Loss at which the loss-penalised score is halved: 1 / LOSS_PENALTY
+static constexpr double LOSS_PENALTY = 20.0;
+
+// Floor for RTT weighting, so loopback-fast links do not dominate completely
+static constexpr double MIN_RTT_MS = 1.0;
+
+// Free-window score of the classic SRTLA selection
+static inline double windowScore(const LinkMetrics& link) {
+    return (double)link.window / (link.inFlight + 1);
+}
+
+class WindowScheduler : public LinkScheduler {
+public:
+    LinkSchedulerType type() const override { return LinkSchedulerType::Window; }
+
+    int select(const LinkMetrics* const* links, size_t count) override {
+        int best = -1;
+        double bestScore = -1.0;
+        for (size_t i = 0; i < count; i++) {
+            if (!links[i]->registered) continue;
+            double score = windowScore(*links[i]);
+            if (score > bestScore) {
+                bestScore = score;
+                best = (int)i;
+            }
+        }
+        return best;
+    }
+};
+
+class RttWeightedScheduler : public LinkScheduler {
+public:
+    LinkSchedulerType type() const override { return LinkSchedulerType::RttWeighted; }
+
+    int select(const LinkMetrics* const* links, size_t count) override {
+        // Links without a measurement yet are treated like the fastest known link
+        double minRtt = -1.0;
+        for (size_t i = 0; i < count; i++) {
+            if (links[i]->registered && links[i]->srttMs >= 0.0 &&
+                (minRtt < 0.0 || links[i]->srttMs < minRtt)) {
+                minRtt = links[i]->srttMs;
+            }
+        }
+
+        int best = -1;
+        double bestScore = -1.0;
+        for (size_t i = 0; i < count; i++) {
+            if (!links[i]->registered) continue;
+            double rtt = links[i]->srttMs >= 0.0 ? links[i]->srttMs : minRtt;
+            double score = windowScore(*links[i]) / std::max(rtt, MIN_RTT_MS);
+            if (score > bestScore) {
+                bestScore = score;
+                best = (int)i;
+            }
+        }
+        return best;
+    }
+};
+
+class LossPenalisedScheduler : public LinkScheduler {
+public:
+    LinkSchedulerType type() const override { return LinkSchedulerType::LossPenalised; }
+
+    int select(const LinkMetrics* const* links, size_t count) override {
+        int best = -1;
+        double bestScore = -1.0;
+        for (size_t i = 0; i < count; i++) {
+            if (!links[i]->registered) continue;
+            double score = windowScore(*links[i]) / (1.0 + LOSS_PENALTY * links[i]->lossRate);
+            if (score > bestScore) {
+                bestScore = score;
+                best = (int)i;
+            }
+        }
+        return best;
+    }
+};
+
+class PriorityScheduler : public LinkScheduler {
+public:
+    LinkSchedulerType type() const override { return LinkSchedulerType::Priority; }
+
+    int select(const LinkMetrics* const* links, size_t count) override {
+        // Best link with free window in the most preferred tier that has one
+        int best = -1;
+        int bestPriority = INT_MAX;
+        double bestScore = -1.0;
+        for (size_t i = 0; i < count; i++) {
+            const LinkMetrics& link = *links[i];
+            if (!link.registered || link.inFlight * SRTLA_WINDOW_MULT >= link.window) continue;
+            double score = windowScore(link);
+            if (link.priority < bestPriority || (link.priority == bestPriority && score > bestScore)) {
+                bestPriority = link.priority;
+                bestScore = score;
+                best = (int)i;
+            }
+        }
+        if (best >= 0) return best;
+
+        // Every window is full, behave like the classic scheduler
+        return m_fallback.select(links, count);
+    }
+
+private:
+    WindowScheduler m_fallback;
+};
+
+std::unique_ptr<LinkScheduler> createLinkScheduler(LinkSchedulerType type) {
+    switch (type) {
+    case LinkSchedulerType::RttWeighted:
+        return std::make_unique<RttWeightedScheduler>();
+    case LinkSchedulerType::LossPenalised:
+        return std::make_unique<LossPenalisedScheduler>();
+    case LinkSchedulerType::Priority:
+        return std::make_unique<PriorityScheduler>();
+    case LinkSchedulerType::Window:
+    default:
+        return std::make_unique<WindowScheduler>();
+    }
+}
+
+const char* linkSchedulerName(LinkSchedulerType type) {
+    switch (type) {
+    case LinkSchedulerType::RttWeighted:
+        return "rtt";
+    case LinkSchedulerType::LossPenalised:
+        return "loss";
+    case LinkSchedulerType::Priority:
+        return "priority";
+    case LinkSchedulerType::Window:
+    default:
+        return "window";
+    }
+}
+
+bool linkSchedulerFromName(const std::string& name, LinkSchedulerType& type) {
+    static const LinkSchedulerType all[] = {
+        LinkSchedulerType::Window, LinkSchedulerType::RttWeighted,
+        LinkSchedulerType::LossPenalised, LinkSchedulerType::Priority
+    };
+    for (LinkSchedulerType candidate : all) {
+        if (name == linkSchedulerName(candidate)) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
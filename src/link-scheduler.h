@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// Scheduling-relevant state of one uplink, maintained by the bonding engine
+// (or by a simulator when benchmarking strategies against link traces)
+struct LinkMetrics {
+    bool registered = false;
+    int window = 0;           // congestion window, in SRTLA_WINDOW_MULT units
+    int inFlight = 0;         // packets sent but not yet acknowledged
+    double srttMs = -1.0;     // smoothed ACK round trip, -1 until measured
+    double lossRate = 0.0;    // smoothed fraction of packets NAKed
+    int priority = 0;         // lower is preferred, used by the priority strategy
+};
+
+enum class LinkSchedulerType {
+    Window,          // classic SRTLA: most free window
+    RttWeighted,     // free window scaled by inverse RTT
+    LossPenalised,   // free window reduced by recent loss
+    Priority         // fill preferred links first, overflow to the rest
+};
+
+// Chooses the link for the next packet
+class LinkScheduler {
+public:
+    virtual ~LinkScheduler() = default;
+
+    virtual LinkSchedulerType type() const = 0;
+
+    // Index of the link to send on, or -1 if no link is usable.
+    // Called once per packet, so implementations must not allocate.
+    virtual int select(const LinkMetrics* const* links, size_t count) = 0;
+};
+
+std::unique_ptr<LinkScheduler> createLinkScheduler(LinkSchedulerType type);
+
+// Stable names used in settings files
+const char* linkSchedulerName(LinkSchedulerType type);
+bool linkSchedulerFromName(const std::string& name, LinkSchedulerType& type);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "triple-buffer.h"
+
+// Per-uplink counters published by the bonding engine
+struct LinkStats {
+    std::string sourceIp;
+    std::string interfaceName;   // empty if not known
+    bool pinned = false;         // traffic bound to the interface, not left to routing
+    bool ipv6 = false;
+    bool probing = false;        // registered, but has not passed the quality gate
+    bool standby = false;        // registered, but the interface's other address family carries the data
+    bool registered = false;
+    uint64_t bytesSent = 0;
+    uint64_t packetsSent = 0;
+    double packetsPerSec = 0.0;
+    double bitsPerSec = 0.0;
+    double rttMs = -1.0;       // smoothed SRTLA ACK round trip, -1 until measured
+    double keepaliveRttMs = -1.0;  // smoothed keepalive echo time, -1 until measured
+    uint64_t naks = 0;         // SRT NAKs attributed to this link
+    double naksPerSec = 0.0;
+    int window = 0;            // congestion window, in packets
+    int inFlight = 0;          // packets sent but not yet acknowledged
+    int64_t lastSeenMs = -1;   // since the last packet from the receiver, -1 if never
+    uint64_t impairedDrops = 0;  // dropped by the impairment emulation, if enabled
+};
+
+// One complete snapshot of all links
+struct SenderStats {
+    std::vector<LinkStats> links;
+    double rxPacketsPerSyscall = 0.0;   // local SRT packets per recvmmsg
+    double txPacketsPerSyscall = 0.0;   // link data packets per sendmmsg / GSO sendmsg
+    bool gso = false;                   // UDP segmentation offload in use
+    uint64_t generation = 0;
+};
+
+using SenderStatsBuffer = TripleBuffer<SenderStats>;
@@ -0,0 +1,235 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Link traces
+ *
+ * Compact binary recordings of per-link capacity, RTT and loss, for
+ * replaying real drives against the bonding logic.
+ *
+ * License: GPL-3.0
+ */
+
+#include "link-trace.h"
+#include "atomic-file.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+static const char TRACE_MAGIC[] = "SRTLATRC";
+static constexpr size_t TRACE_MAGIC_LEN = 8;
+static constexpr uint8_t TRACE_VERSION = 1;
+static constexpr uint32_t MAX_LOSS_BP = 10000;
+
+static void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(char((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(char(value));
+}
+
+static void putDelta(std::string& out, uint32_t value, uint32_t previous) {
+    int64_t delta = (int64_t)value - (int64_t)previous;
+    putVarint(out, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+}
+
+namespace {
+
+// Bounds-checked reader over the encoded bytes
+struct TraceReader {
+    const std::string& data;
+    size_t pos = 0;
+
+    bool atEnd() const { return pos >= data.size(); }
+
+    bool byte(uint8_t& value) {
+        if (pos >= data.size()) return false;
+        value = (uint8_t)data[pos++];
+        return true;
+    }
+
+    bool varint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b;
+            if (!byte(b)) return false;
+            value |= (uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    bool delta(uint32_t& value, uint32_t max) {
+        uint64_t zigzag;
+        if (!varint(zigzag)) return false;
+        int64_t delta = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+        int64_t result = (int64_t)value + delta;
+        if (result < 0 || result > (int64_t)max) return false;
+        value = (uint32_t)result;
+        return true;
+    }
+};
+
+} // namespace
+
+LinkTracePoint LinkTrace::at(size_t link, int64_t ms) const {
+    auto it = std::upper_bound(frames.begin(), frames.end(), ms,
+                               [](int64_t t, const Frame& frame) { return t < frame.atMs; });
+    if (it == frames.begin() || link >= (it - 1)->links.size()) return LinkTracePoint();
+    return (it - 1)->links[link];
+}
+
+std::string encodeLinkTrace(const LinkTrace& trace) {
+    std::string out(TRACE_MAGIC, TRACE_MAGIC_LEN);
+    out.push_back(char(TRACE_VERSION));
+
+    size_t links = std::min<size_t>(trace.linkNames.size(), 255);
+    out.push_back(char(links));
+    for (size_t i = 0; i < links; i++) {
+        const std::string& name = trace.linkNames[i];
+        size_t len = std::min<size_t>(name.size(), 255);
+        out.push_back(char(len));
+        out.append(name, 0, len);
+    }
+
+    int64_t lastMs = 0;
+    std::vector<LinkTracePoint> previous(links);
+    for (const auto& frame : trace.frames) {
+        putVarint(out, (uint64_t)std::max<int64_t>(frame.atMs - lastMs, 0));
+        lastMs = std::max(frame.atMs, lastMs);
+        for (size_t i = 0; i < links; i++) {
+            LinkTracePoint point = i < frame.links.size() ? frame.links[i] : LinkTracePoint();
+            point.lossBp = std::min(point.lossBp, MAX_LOSS_BP);
+            putDelta(out, point.capacityKbps, previous[i].capacityKbps);
+            putDelta(out, point.rttMs, previous[i].rttMs);
+            putDelta(out, point.lossBp, previous[i].lossBp);
+            previous[i] = point;
+        }
+    }
+    return out;
+}
+
+bool decodeLinkTrace(const std::string& data, LinkTrace& trace, std::string& error) {
+    trace = LinkTrace();
+    TraceReader in{data};
+
+    if (data.compare(0, TRACE_MAGIC_LEN, TRACE_MAGIC) != 0) {
+        error = "not a link trace";
+        return false;
+    }
+    in.pos = TRACE_MAGIC_LEN;
+
+    uint8_t version, links;
+    if (!in.byte(version) || version != TRACE_VERSION) {
+        error = "unsupported trace version";
+        return false;
+    }
+    if (!in.byte(links)) {
+        error = "truncated header";
+        return false;
+    }
+    for (uint8_t i = 0; i < links; i++) {
+        uint8_t len;
+        if (!in.byte(len) || in.pos + len > data.size()) {
+            error = "truncated header";
+            return false;
+        }
+        trace.linkNames.push_back(data.substr(in.pos, len));
+        in.pos += len;
+    }
+
+    int64_t atMs = 0;
+    std::vector<LinkTracePoint> points(links);
+    while (!in.atEnd()) {
+        uint64_t deltaMs;
+        if (!in.varint(deltaMs) || deltaMs > (uint64_t)INT32_MAX) {
+            error = "bad frame time at byte " + std::to_string(in.pos);
+            return false;
+        }
+        atMs += (int64_t)deltaMs;
+        for (auto& point : points) {
+            if (!in.delta(point.capacityKbps, UINT32_MAX) || !in.delta(point.rttMs, UINT32_MAX) ||
+                !in.delta(point.lossBp, MAX_LOSS_BP)) {
+                error = "bad frame at byte " + std::to_string(in.pos);
+                return false;
+            }
+        }
+        trace.frames.push_back({atMs, points});
+    }
+    return true;
+}
+
+bool saveLinkTrace(const std::string& path, const LinkTrace& trace) {
+    return atomicWriteFile(path, encodeLinkTrace(trace));
+}
+
+bool loadLinkTrace(const std::string& path, LinkTrace& trace, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::stringstream contents;
+    contents << in.rdbuf();
+    if (!decodeLinkTrace(contents.str(), trace, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+std::string linkTraceToImpairmentScript(const LinkTrace& trace) {
+    std::string script = "# replay of a link trace, links by index\n";
+    std::vector<LinkTracePoint> previous;
+    for (const auto& frame : trace.frames) {
+        for (size_t i = 0; i < frame.links.size(); i++) {
+            const LinkTracePoint& point = frame.links[i];
+            if (i < previous.size() && previous[i] == point) continue;
+
+            char line[160];
+            if (point.capacityKbps == 0) {
+                snprintf(line, sizeof(line), "%lld %zu blackout=on\n", (long long)frame.atMs, i);
+            } else {
+                snprintf(line, sizeof(line), "%lld %zu blackout=off rate=%u delay=%.1f loss=%.2f\n",
+                         (long long)frame.atMs, i, point.capacityKbps, point.rttMs / 2.0, point.lossBp / 100.0);
+            }
+            script += line;
+        }
+        previous = frame.links;
+    }
+    return script;
+}
+
+void LinkTraceRecorder::record(const SenderStats& stats, int64_t nowMs) {
+    if (m_trace.frames.empty()) {
+        m_startMs = nowMs;
+    }
+
+    LinkTrace::Frame frame;
+    frame.atMs = nowMs - m_startMs;
+    frame.links.resize(m_trace.linkNames.size());
+    for (const auto& link : stats.links) {
+        auto it = m_columns.find(link.sourceIp);
+        if (it == m_columns.end()) {
+            if (m_trace.linkNames.size() >= 255) continue;
+            it = m_columns.emplace(link.sourceIp, m_trace.linkNames.size()).first;
+            m_trace.linkNames.push_back(link.sourceIp);
+            frame.links.resize(m_trace.linkNames.size());
+            for (auto& earlier : m_trace.frames) {
+                earlier.links.resize(m_trace.linkNames.size());
+            }
+        }
+        if (!link.registered) continue;
+
+        // A registered link is up even while it carries nothing
+        LinkTracePoint& point = frame.links[it->second];
+        point.capacityKbps = std::max<uint32_t>(1, (uint32_t)std::lround(link.bitsPerSec / 1000.0));
+        point.rttMs = link.rttMs > 0.0 ? (uint32_t)std::lround(link.rttMs) : 0;
+        if (link.packetsPerSec > 0.0) {
+            point.lossBp = (uint32_t)std::min<double>(MAX_LOSS_BP, std::lround(link.naksPerSec / link.packetsPerSec * MAX_LOSS_BP));
+        }
+    }
+    m_trace.frames.push_back(std::move(frame));
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "link-stats.h"
+
+// Conditions of one uplink at one point of a trace
+struct LinkTracePoint {
+    uint32_t capacityKbps = 0;  // 0 while the link is down
+    uint32_t rttMs = 0;
+    uint32_t lossBp = 0;        // packet loss in basis points, 0 to 10000
+
+    bool operator==(const LinkTracePoint& other) const {
+        return capacityKbps == other.capacityKbps && rttMs == other.rttMs && lossBp == other.lossBp;
+    }
+};
+
+// Per-link capacity, RTT and loss over time. Each frame holds one point
+// per link and is valid until the next frame.
+struct LinkTrace {
+    struct Frame {
+        int64_t atMs = 0;
+        std::vector<LinkTracePoint> links;
+    };
+
+    std::vector<std::string> linkNames;
+    std::vector<Frame> frames;
+
+    int64_t durationMs() const { return frames.empty() ? 0 : frames.back().atMs; }
+
+    // Conditions of link at ms, a default point before the first frame
+    LinkTracePoint at(size_t link, int64_t ms) const;
+};
+
+// Binary trace files, about 4 bytes per link and frame:
+//
+//     "SRTLATRC"  magic
+//     u8          version (1)
+//     u8          link count, then per link: u8 name length, name bytes
+//     frames until the end of the file:
+//         varint  ms since the previous frame
+//         per link: zigzag varint changes of capacity, RTT and loss
+//
+// Varints are unsigned LEB128; values are stored as differences to the
+// previous frame, so steady links cost a byte per field.
+std::string encodeLinkTrace(const LinkTrace& trace);
+bool decodeLinkTrace(const std::string& data, LinkTrace& trace, std::string& error);
+
+bool saveLinkTrace(const std::string& path, const LinkTrace& trace);
+bool loadLinkTrace(const std::string& path, LinkTrace& trace, std::string& error);
+
+// Impairment script (see link-impairment.h) that plays trace back in real
+// time through the engine's uplinks, selected by index: capacity becomes
+// the rate, half the RTT the one-way delay, a down link a blackout.
+std::string linkTraceToImpairmentScript(const LinkTrace& trace);
+
+// Builds a trace from the engine's statistics snapshots during a real
+// stream. The engine sees throughput rather than capacity, so capacity is
+// what the link carried: a lower bound while the encoder was not pushing
+// it. Loss is NAKs per packet sent. Links are keyed by source IP; one that
+// appears later reads as down before it did.
+class LinkTraceRecorder {
+public:
+    void record(const SenderStats& stats, int64_t nowMs);
+
+    bool empty() const { return m_trace.frames.empty(); }
+    const LinkTrace& trace() const { return m_trace; }
+
+private:
+    LinkTrace m_trace;
+    std::map<std::string, size_t> m_columns;
+    int64_t m_startMs = 0;
+};
@@ -1,20 +1,27 @@
 #include "network-monitor.h"
-#include <thread>
-#include <chrono>
-#include <fstream>
-#include <sstream>
-#include <iostream>
+#include "srtla-log.h"
 #include <algorithm>
+#include <cstring>
 
 #include <unistd.h>
+#include <poll.h>
 #include <sys/types.h>
+#include <sys/eventfd.h>
 #include <ifaddrs.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <net/if.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
 
-NetworkMonitor::NetworkMonitor() : m_running(false) {
+NetworkMonitor::NetworkMonitor()
+    : m_running(false),
+      m_netlinkFd(-1),
+      m_wakeFd(-1),
+      m_dumpSeq(0),
+      m_tableChanged(false),
+      m_usableChanged(false) {
 }
 
 NetworkMonitor::~NetworkMonitor() {
@@ -23,14 +30,39 @@ NetworkMonitor::~NetworkMonitor() {
 
 void NetworkMonitor::start() {
     if (m_running) return;
-    
+
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (!openNetlink() || m_wakeFd < 0) {
+        srtla_log(SRTLA_LOG_ERROR, "Failed to open rtnetlink socket, interface changes will not be tracked");
+        stop();
+        return;
+    }
+
+    // Load the initial table synchronously so callers see it right away
+    resync();
+    publishTable();
+    m_usableChanged = false;
+
     m_running = true;
-    std::thread t(&NetworkMonitor::monitorThread, this);
-    t.detach();
+    m_thread = std::thread(&NetworkMonitor::monitorThread, this);
 }
 
 void NetworkMonitor::stop() {
     m_running = false;
+
+    if (m_wakeFd >= 0) {
+        uint64_t one = 1;
+        ssize_t ret = write(m_wakeFd, &one, sizeof(one));
+        (void)ret;
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    if (m_netlinkFd >= 0) close(m_netlinkFd);
+    if (m_wakeFd >= 0) close(m_wakeFd);
+    m_netlinkFd = -1;
+    m_wakeFd = -1;
 }
 
 std::vector<NetworkInterface> NetworkMonitor::getNetworkInterfaces() {
@@ -38,172 +70,372 @@ std::vector<NetworkInterface> NetworkMonitor::getNetworkInterfaces() {
     return m_interfaces;
 }
 
-bool NetworkMonitor::saveIpListToFile(const std::string& filePath) {
-    // Force a fresh detection of network interfaces
-    std::vector<NetworkInterface> interfaces = detectNetworkInterfaces();
-    
-    // Store the updated interfaces
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_interfaces = interfaces;
+void NetworkMonitor::registerCallback(NetworkChangeCallback callback) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_callbacks.push_back(callback);
+}
+
+void NetworkMonitor::monitorThread() {
+    pollfd fds[2];
+    fds[0].fd = m_netlinkFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = m_wakeFd;
+    fds[1].events = POLLIN;
+
+    while (m_running) {
+        int ret = poll(fds, 2, -1);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            srtla_log(SRTLA_LOG_ERROR, "Network monitor poll failed: %s", strerror(errno));
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            // Woken by stop()
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            // Drain every queued message so a burst (link up + address) is reported once
+            if (!readMessages(false)) {
+                // Kernel dropped events (ENOBUFS), rebuild the table from scratch
+                srtla_log(SRTLA_LOG_WARNING, "Netlink event queue overflowed, resyncing interface table");
+                resync();
+            }
+
+            if (m_tableChanged) {
+                publishTable();
+            }
+            if (m_usableChanged) {
+                m_usableChanged = false;
+                notifyNetworkChange(); // This will update the sender's links
+            }
+        }
     }
-    
-    std::ofstream file(filePath);
-    if (!file.is_open()) {
+}
+
+bool NetworkMonitor::openNetlink() {
+    m_netlinkFd = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (m_netlinkFd < 0) {
         return false;
     }
-    
-    // Log the interfaces we found
-    std::string foundIps;
-    bool atLeastOneIp = false;
-    
-    for (const auto& interface : interfaces) {
-        // Skip localhost/loopback
-        if (interface.ipAddress == "127.0.0.1" || interface.name == "lo") {
-            continue;
+
+    int bufSize = 1024 * 1024;
+    setsockopt(m_netlinkFd, SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize));
+
+    sockaddr_nl addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+    if (bind(m_netlinkFd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(m_netlinkFd);
+        m_netlinkFd = -1;
+        return false;
+    }
+    return true;
+}
+
+bool NetworkMonitor::requestDump(int type) {
+    struct {
+        nlmsghdr hdr;
+        rtgenmsg gen;
+    } req;
+    memset(&req, 0, sizeof(req));
+    req.hdr.nlmsg_len = NLMSG_LENGTH(sizeof(rtgenmsg));
+    req.hdr.nlmsg_type = (uint16_t)type;
+    req.hdr.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.hdr.nlmsg_seq = ++m_dumpSeq;
+    req.gen.rtgen_family = AF_UNSPEC;
+
+    sockaddr_nl kernel;
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+    return sendto(m_netlinkFd, &req, req.hdr.nlmsg_len, 0, (sockaddr*)&kernel, sizeof(kernel)) >= 0;
+}
+
+bool NetworkMonitor::readMessages(bool dumping) {
+    alignas(nlmsghdr) char buf[16384];
+
+    while (true) {
+        ssize_t len = recv(m_netlinkFd, buf, sizeof(buf), 0);
+        if (len < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (!dumping) return true;
+
+                // The dump reply is not complete yet, wait for the rest
+                pollfd pfd = { m_netlinkFd, POLLIN, 0 };
+                if (poll(&pfd, 1, 1000) <= 0) return false;
+                continue;
+            }
+            return errno != ENOBUFS;
         }
-        
-        // Only include active interfaces with valid IPs
-        if (interface.isActive && !interface.ipAddress.empty()) {
-            file << interface.ipAddress << "\n";
-            foundIps += interface.name + "(" + interface.ipAddress + ") ";
-            atLeastOneIp = true;
+
+        for (nlmsghdr* msg = (nlmsghdr*)buf; NLMSG_OK(msg, (size_t)len); msg = NLMSG_NEXT(msg, len)) {
+            if (msg->nlmsg_type == NLMSG_DONE && msg->nlmsg_seq == m_dumpSeq) {
+                if (dumping) return true;
+                continue;
+            }
+            if (msg->nlmsg_type == NLMSG_ERROR) {
+                if (dumping && msg->nlmsg_seq == m_dumpSeq) return false;
+                continue;
+            }
+            handleMessage(msg);
         }
     }
-    
-    // If no valid interfaces were found, don't write anything
-    // This is because SRTLA will use all available interfaces if no IP file is provided
-    if (!atLeastOneIp) {
-        std::cout << "No non-loopback network interfaces found" << std::endl;
-        // Return true because this isn't considered an error
-        return true;
-    }
-    
-    // Log what we found
-    std::cout << "Found network interfaces: " << foundIps << std::endl;
-    
-    return true;
 }
 
-void NetworkMonitor::registerCallback(NetworkChangeCallback callback) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_callbacks.push_back(callback);
+void NetworkMonitor::resync() {
+    // Subscribed before dumping, so no event between dump and live updates is lost
+    std::map<std::pair<int, std::string>, NetworkInterface> previous;
+    previous.swap(m_addresses);
+    m_links.clear();
+
+    bool ok = requestDump(RTM_GETLINK) && readMessages(true) &&
+              requestDump(RTM_GETADDR) && readMessages(true);
+    if (!ok) {
+        srtla_log(SRTLA_LOG_WARNING, "Failed to dump interface table over netlink");
+    }
+
+    // Compare usable IP sets of the old and new table
+    auto usableSet = [](const std::map<std::pair<int, std::string>, NetworkInterface>& table) {
+        std::vector<std::string> ips;
+        for (const auto& entry : table) {
+            if (isUsable(entry.second)) ips.push_back(entry.second.ipAddress);
+        }
+        return ips;
+    };
+    if (usableSet(previous) != usableSet(m_addresses)) {
+        m_usableChanged = true;
+    }
+    m_tableChanged = true;
 }
 
-void NetworkMonitor::monitorThread() {
-    std::vector<NetworkInterface> lastInterfaces;
-    
-    while (m_running) {
-        std::vector<NetworkInterface> currentInterfaces = detectNetworkInterfaces();
-        
-        // Only rewrite the IP file if actual IP changes are detected
-        if (haveInterfacesChanged(lastInterfaces, currentInterfaces)) {
-            {
-                std::lock_guard<std::mutex> lock(m_mutex);
-                m_interfaces = currentInterfaces;
+void NetworkMonitor::handleMessage(const nlmsghdr* msg) {
+    switch (msg->nlmsg_type) {
+    case RTM_NEWLINK:
+    case RTM_DELLINK: {
+        const ifinfomsg* ifi = (const ifinfomsg*)NLMSG_DATA(msg);
+        int ifIndex = ifi->ifi_index;
+
+        if (msg->nlmsg_type == RTM_DELLINK) {
+            m_links.erase(ifIndex);
+            for (auto it = m_addresses.begin(); it != m_addresses.end();) {
+                if (it->first.first == ifIndex) {
+                    if (isUsable(it->second)) m_usableChanged = true;
+                    it = m_addresses.erase(it);
+                    m_tableChanged = true;
+                } else {
+                    ++it;
+                }
             }
-            notifyNetworkChange(); // This will rewrite the IP file and send HUP signal
+            return;
         }
-        
-        lastInterfaces = currentInterfaces;
-        std::this_thread::sleep_for(std::chrono::seconds(5));
+
+        LinkEntry& link = m_links[ifIndex];
+        link.flags = ifi->ifi_flags;
+
+        int attrLen = (int)IFLA_PAYLOAD(msg);
+        for (const rtattr* attr = IFLA_RTA(ifi); RTA_OK(attr, attrLen); attr = RTA_NEXT(attr, attrLen)) {
+            if (attr->rta_type == IFLA_IFNAME) {
+                link.name = (const char*)RTA_DATA(attr);
+            }
+        }
+
+        // Renames and late driver binds come with another RTM_NEWLINK, so the
+        // cached type follows them
+        InterfaceType type = classifyInterface(link.name);
+        if (type != link.type) {
+            link.type = type;
+            srtla_log(SRTLA_LOG_DEBUG, "Interface %s is %s", link.name.c_str(), interfaceTypeName(type));
+        }
+
+        refreshLinkState(ifIndex);
+        return;
+    }
+
+    case RTM_NEWADDR:
+    case RTM_DELADDR: {
+        const ifaddrmsg* ifa = (const ifaddrmsg*)NLMSG_DATA(msg);
+        if (ifa->ifa_family != AF_INET && ifa->ifa_family != AF_INET6) return;
+        bool ipv6 = ifa->ifa_family == AF_INET6;
+
+        std::string ip;
+        std::string label;
+        uint32_t flags = ifa->ifa_flags;
+        int attrLen = (int)IFA_PAYLOAD(msg);
+        for (const rtattr* attr = IFA_RTA(ifa); RTA_OK(attr, attrLen); attr = RTA_NEXT(attr, attrLen)) {
+            if (attr->rta_type == IFA_LOCAL || (attr->rta_type == IFA_ADDRESS && ip.empty())) {
+                char ipStr[INET6_ADDRSTRLEN];
+                inet_ntop(ifa->ifa_family, RTA_DATA(attr), ipStr, sizeof(ipStr));
+                ip = ipStr;
+            } else if (attr->rta_type == IFA_LABEL) {
+                label = (const char*)RTA_DATA(attr);
+            } else if (attr->rta_type == IFA_FLAGS) {
+                flags = *(const uint32_t*)RTA_DATA(attr);
+            }
+        }
+        if (ip.empty()) return;
+
+        // IPv6 links need a stable, routable source: no link-local addresses,
+        // none still in or failed duplicate detection, no deprecated or
+        // short-lived privacy addresses. One that turns unsuitable is dropped.
+        bool suitable = !ipv6 || (ifa->ifa_scope == RT_SCOPE_UNIVERSE &&
+            !(flags & (IFA_F_TENTATIVE | IFA_F_DADFAILED | IFA_F_DEPRECATED | IFA_F_TEMPORARY)));
+
+        if (msg->nlmsg_type == RTM_NEWADDR && suitable) {
+            setAddress((int)ifa->ifa_index, ip, ipv6, label);
+        } else {
+            removeAddress((int)ifa->ifa_index, ip);
+        }
+        return;
     }
+
+    default:
+        return;
+    }
+}
+
+void NetworkMonitor::setAddress(int ifIndex, const std::string& ip, bool ipv6, const std::string& label) {
+    auto key = std::make_pair(ifIndex, ip);
+    auto it = m_addresses.find(key);
+    bool wasUsable = (it != m_addresses.end()) && isUsable(it->second);
+
+    NetworkInterface& iface = m_addresses[key];
+    iface.ifIndex = ifIndex;
+    iface.ipAddress = ip;
+    iface.ipv6 = ipv6;
+
+    auto link = m_links.find(ifIndex);
+    if (link != m_links.end()) {
+        iface.name = link->second.name;
+        iface.type = link->second.type;
+        iface.isActive = (link->second.flags & IFF_UP) && (link->second.flags & IFF_RUNNING) &&
+                         !(link->second.flags & IFF_LOOPBACK);
+    } else {
+        iface.name = label;
+        iface.type = InterfaceType::Unknown;
+        iface.isActive = false;
+    }
+
+    if (isUsable(iface) != wasUsable) m_usableChanged = true;
+    m_tableChanged = true;
+}
+
+void NetworkMonitor::removeAddress(int ifIndex, const std::string& ip) {
+    auto it = m_addresses.find(std::make_pair(ifIndex, ip));
+    if (it == m_addresses.end()) return;
+
+    if (isUsable(it->second)) m_usableChanged = true;
+    m_addresses.erase(it);
+    m_tableChanged = true;
+}
+
+void NetworkMonitor::refreshLinkState(int ifIndex) {
+    const LinkEntry& link = m_links[ifIndex];
+    bool active = (link.flags & IFF_UP) && (link.flags & IFF_RUNNING) && !(link.flags & IFF_LOOPBACK);
+
+    // Only the addresses of this interface are affected
+    for (auto it = m_addresses.lower_bound(std::make_pair(ifIndex, std::string()));
+         it != m_addresses.end() && it->first.first == ifIndex; ++it) {
+        NetworkInterface& iface = it->second;
+        if (iface.isActive == active && iface.name == link.name && iface.type == link.type) continue;
+
+        bool wasUsable = isUsable(iface);
+        iface.isActive = active;
+        iface.name = link.name;
+        iface.type = link.type;
+        if (isUsable(iface) != wasUsable) m_usableChanged = true;
+        m_tableChanged = true;
+    }
+}
+
+void NetworkMonitor::publishTable() {
+    std::vector<NetworkInterface> interfaces;
+    interfaces.reserve(m_addresses.size());
+    for (const auto& entry : m_addresses) {
+        if (entry.second.name == "lo") continue;
+        interfaces.push_back(entry.second);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_interfaces.swap(interfaces);
+    m_tableChanged = false;
 }
 
 std::vector<NetworkInterface> NetworkMonitor::detectNetworkInterfaces() {
+    if (m_running) {
+        return getNetworkInterfaces();
+    }
+
     std::vector<NetworkInterface> interfaces;
-    
+
     // Linux implementation
     struct ifaddrs* ifaddr;
     if (getifaddrs(&ifaddr) == -1) {
         return interfaces;
     }
-    
+
+    std::map<std::string, InterfaceType> types;
     for (struct ifaddrs* ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
         if (ifa->ifa_addr == nullptr) continue;
-        
-        // Only consider IPv4 addresses
-        if (ifa->ifa_addr->sa_family == AF_INET) {
+
+        int family = ifa->ifa_addr->sa_family;
+        if (family == AF_INET6) {
+            // getifaddrs() has no address flags, only link-local ones can be
+            // told apart here; the netlink table also skips privacy addresses
+            const in6_addr& addr6 = ((const sockaddr_in6*)ifa->ifa_addr)->sin6_addr;
+            if (IN6_IS_ADDR_LINKLOCAL(&addr6) || IN6_IS_ADDR_LOOPBACK(&addr6)) continue;
+        }
+
+        if (family == AF_INET || family == AF_INET6) {
             NetworkInterface interface;
             interface.name = ifa->ifa_name;
+            interface.ifIndex = (int)if_nametoindex(ifa->ifa_name);
             interface.isActive = (ifa->ifa_flags & IFF_UP) && (ifa->ifa_flags & IFF_RUNNING);
-            
-            // Determine interface type based on name (common naming conventions)
-            interface.isEthernet = (interface.name.find("eth") == 0 || 
-                                   interface.name.find("en") == 0 ||
-                                   interface.name.find("eno") == 0 ||
-                                   interface.name.find("enp") == 0);
-            
-            interface.isWireless = (interface.name.find("wlan") == 0 || 
-                                   interface.name.find("wifi") == 0 ||
-                                   interface.name.find("wl") == 0);
-            
-            interface.isModem = (interface.name.find("ppp") == 0 || 
-                                interface.name.find("tun") == 0 ||
-                                interface.name.find("tap") == 0);
-            
+            auto type = types.find(interface.name);
+            if (type == types.end()) {
+                type = types.emplace(interface.name, classifyInterface(interface.name)).first;
+            }
+            interface.type = type->second;
+
             // Skip loopback interfaces
             if (interface.name == "lo" || ifa->ifa_flags & IFF_LOOPBACK) continue;
-            
+
             // Get IP address
-            char ipStr[INET_ADDRSTRLEN];
-            struct sockaddr_in* addr = (struct sockaddr_in*)ifa->ifa_addr;
-            inet_ntop(AF_INET, &(addr->sin_addr), ipStr, INET_ADDRSTRLEN);
+            char ipStr[INET6_ADDRSTRLEN];
+            const void* addr = family == AF_INET ?
+                (const void*)&((const sockaddr_in*)ifa->ifa_addr)->sin_addr :
+                (const void*)&((const sockaddr_in6*)ifa->ifa_addr)->sin6_addr;
+            inet_ntop(family, addr, ipStr, sizeof(ipStr));
             interface.ipAddress = ipStr;
-            
+            interface.ipv6 = family == AF_INET6;
+
             interfaces.push_back(interface);
         }
     }
-    
+
     freeifaddrs(ifaddr);
 
     return interfaces;
 }
 
-bool NetworkMonitor::haveInterfacesChanged(const std::vector<NetworkInterface>& oldInterfaces, 
-                                         const std::vector<NetworkInterface>& newInterfaces) {
-    // Extract only active, non-loopback interfaces with valid IPs
-    std::vector<std::string> oldIps;
-    std::vector<std::string> newIps;
-    
-    for (const auto& iface : oldInterfaces) {
-        if (iface.isActive && !iface.ipAddress.empty() && iface.ipAddress != "127.0.0.1" && iface.name != "lo") {
-            oldIps.push_back(iface.ipAddress);
-        }
-    }
-    
-    for (const auto& iface : newInterfaces) {
-        if (iface.isActive && !iface.ipAddress.empty() && iface.ipAddress != "127.0.0.1" && iface.name != "lo") {
-            newIps.push_back(iface.ipAddress);
-        }
-    }
-    
-    // Sort IPs for reliable comparison
-    std::sort(oldIps.begin(), oldIps.end());
-    std::sort(newIps.begin(), newIps.end());
-    
-    // Compare IP sets - if different, interfaces have changed
-    if (oldIps.size() != newIps.size()) {
-        return true;
-    }
-    
-    for (size_t i = 0; i < oldIps.size(); i++) {
-        if (oldIps[i] != newIps[i]) {
-            return true;
-        }
-    }
-    
-    return false;
+bool NetworkMonitor::isUsable(const NetworkInterface& iface) {
+    return iface.isActive && !iface.ipAddress.empty() &&
+           iface.ipAddress != "127.0.0.1" && iface.ipAddress != "::1" && iface.name != "lo";
 }
 
 void NetworkMonitor::notifyNetworkChange() {
     std::vector<NetworkInterface> interfaces;
+    std::vector<NetworkChangeCallback> callbacks;
     {
         std::lock_guard<std::mutex> lock(m_mutex);
         interfaces = m_interfaces;
-        
-        for (const auto& callback : m_callbacks) {
-            callback(interfaces);
-        }
+        callbacks = m_callbacks;
     }
-}
\ No newline at end of file
+
+    // Called without the lock held, callbacks may query the monitor again
+    for (const auto& callback : callbacks) {
+        callback(interfaces);
+    }
+}
@@ -5,14 +5,20 @@
 #include <map>
 #include <functional>
 #include <mutex>
+#include <thread>
+#include <atomic>
+
+#include "interface-class.h"
+
+struct nlmsghdr;
 
 struct NetworkInterface {
     std::string name;
     std::string ipAddress;
-    bool isWireless;
-    bool isEthernet;
-    bool isModem;
-    bool isActive;
+    bool ipv6 = false;
+    int ifIndex = 0;
+    InterfaceType type = InterfaceType::Unknown;
+    bool isActive = false;
 };
 
 class NetworkMonitor {
@@ -21,37 +27,71 @@ public:
     ~NetworkMonitor();
 
     // Start monitoring network interfaces
+    // Loads the current interface table before returning, then follows
+    // rtnetlink link/address events on a background thread.
     void start();
-    
+
     // Stop monitoring network interfaces
     void stop();
-    
+
     // Get current network interfaces
     std::vector<NetworkInterface> getNetworkInterfaces();
-    
-    // Save IP list to file
-    bool saveIpListToFile(const std::string& filePath);
-    
+
     // Register callback for network changes
     using NetworkChangeCallback = std::function<void(const std::vector<NetworkInterface>&)>;
     void registerCallback(NetworkChangeCallback callback);
-    
+
     // Detect network interfaces - made public so it can be called directly
+    // Returns the live table while monitoring, otherwise scans with getifaddrs.
     std::vector<NetworkInterface> detectNetworkInterfaces();
 
 private:
-    bool m_running;
+    // Link state from RTM_NEWLINK, keyed by interface index. The type is
+    // read from sysfs on every RTM_NEWLINK and cached in between.
+    struct LinkEntry {
+        std::string name;
+        unsigned int flags = 0;
+        InterfaceType type = InterfaceType::Unknown;
+    };
+
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+    int m_netlinkFd;
+    int m_wakeFd;
+    uint32_t m_dumpSeq;
+
     std::vector<NetworkInterface> m_interfaces;
     std::mutex m_mutex;
     std::vector<NetworkChangeCallback> m_callbacks;
-    
+
+    // Incremental interface table, only touched by the monitor thread
+    // (and by start() before the thread exists)
+    std::map<int, LinkEntry> m_links;
+    std::map<std::pair<int, std::string>, NetworkInterface> m_addresses;
+    bool m_tableChanged;   // anything in the table changed
+    bool m_usableChanged;  // the set of usable link IPs changed
+
     // Thread function to monitor network changes
     void monitorThread();
-    
-    // Compare interfaces to detect changes
-    bool haveInterfacesChanged(const std::vector<NetworkInterface>& oldInterfaces, 
-                              const std::vector<NetworkInterface>& newInterfaces);
-    
+
+    // Netlink helpers
+    bool openNetlink();
+    bool requestDump(int type);
+    bool readMessages(bool dumping);
+    void handleMessage(const nlmsghdr* msg);
+    void resync();
+
+    // Update one address entry, tracking whether the usable IP set changed
+    void setAddress(int ifIndex, const std::string& ip, bool ipv6, const std::string& label);
+    void removeAddress(int ifIndex, const std::string& ip);
+    void refreshLinkState(int ifIndex);
+
+    // Rebuild the snapshot returned by getNetworkInterfaces()
+    void publishTable();
+
+    // Whether this entry should be used as an SRTLA link
+    static bool isUsable(const NetworkInterface& iface);
+
     // Notify all registered callbacks
     void notifyNetworkChange();
-};
\ No newline at end of file
+};
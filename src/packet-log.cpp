@@ -0,0 +1,76 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Per-link packet log and congestion window
+ *
+ * The SRTLA window rules, kept apart from the socket code so recorded
+ * link traces can be replayed against them.
+ *
+ * License: GPL-3.0
+ */
+
+#include "packet-log.h"
+#include "srtla-protocol.h"
+
+#include <algorithm>
+
+void PacketLog::clear() {
+    std::fill(std::begin(m_seqs), std::end(m_seqs), -1);
+}
+
+void PacketLog::sent(LinkMetrics& link, int32_t seq, Clock::time_point now) {
+    // An entry that is still set was never acknowledged, stop counting it
+    if (m_seqs[m_index] >= 0 && link.inFlight > 0) {
+        link.inFlight--;
+    }
+    m_seqs[m_index] = seq;
+    m_sentAt[m_index] = now;
+    m_index = (m_index + 1) % SIZE;
+    link.inFlight++;
+}
+
+void PacketLog::unsent(LinkMetrics& link, int32_t seq) {
+    int idx = find(seq);
+    if (idx < 0) return;
+
+    m_seqs[idx] = -1;
+    if (link.inFlight > 0) link.inFlight--;
+}
+
+int PacketLog::find(int32_t seq) const {
+    for (size_t i = 0; i < SIZE; i++) {
+        size_t idx = (m_index + SIZE - i - 1) % SIZE;
+        if (m_seqs[idx] == seq) return (int)idx;
+    }
+    return -1;
+}
+
+bool PacketLog::acked(LinkMetrics& link, int32_t seq, Clock::time_point now) {
+    int idx = find(seq);
+    if (idx < 0) return false;
+
+    m_seqs[idx] = -1;
+    if (link.inFlight > 0) link.inFlight--;
+
+    link.lossRate -= link.lossRate / SRTLA_LOSS_SMOOTHING;
+
+    // Smoothed RTT, same 1/8 gain as TCP's SRTT
+    double sample = std::chrono::duration<double, std::milli>(now - m_sentAt[idx]).count();
+    link.srttMs = link.srttMs < 0.0 ? sample : link.srttMs + (sample - link.srttMs) / 8.0;
+
+    // Only grow the window while the link is actually being used
+    if (link.inFlight * SRTLA_WINDOW_MULT > link.window) {
+        link.window = std::min(link.window + SRTLA_WINDOW_INCR, SRTLA_WINDOW_MAX * SRTLA_WINDOW_MULT);
+    }
+    return true;
+}
+
+bool PacketLog::naked(LinkMetrics& link, int32_t seq) {
+    int idx = find(seq);
+    if (idx < 0) return false;
+
+    m_seqs[idx] = -1;
+    link.lossRate += (1.0 - link.lossRate) / SRTLA_LOSS_SMOOTHING;
+    if (link.inFlight > 0) link.inFlight--;
+    link.window = std::max(link.window - SRTLA_WINDOW_DECR, SRTLA_WINDOW_MIN * SRTLA_WINDOW_MULT);
+    return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "link-scheduler.h"
+
+// Recently sent sequence numbers of one uplink and the congestion window
+// bookkeeping driven by SRTLA ACKs and SRT NAKs. Shared by the bonding
+// engine and the trace replay simulator, which runs it on virtual time.
+class PacketLog {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t SIZE = 256;
+
+    PacketLog() { clear(); }
+
+    // Forget every logged packet, e.g. when the link starts over
+    void clear();
+
+    // seq went out on link at now
+    void sent(LinkMetrics& link, int32_t seq, Clock::time_point now);
+
+    // seq was logged by sent() but never left, e.g. the socket buffer was full
+    void unsent(LinkMetrics& link, int32_t seq);
+
+    // The receiver acknowledged seq on this link: update RTT, loss and
+    // window. Returns false if seq is not in the log.
+    bool acked(LinkMetrics& link, int32_t seq, Clock::time_point now);
+
+    // SRT reported seq lost: shrink the window if it went out on this
+    // link. Returns false if seq is not in the log.
+    bool naked(LinkMetrics& link, int32_t seq);
+
+private:
+    // Slot of seq, searching from the most recent, or -1
+    int find(int32_t seq) const;
+
+    int32_t m_seqs[SIZE];
+    Clock::time_point m_sentAt[SIZE];
+    size_t m_index = 0;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Lock-free single-producer/single-consumer ring of datagrams.
+//
+// Each slot holds one packet of up to SlotSize bytes. The producer copies a
+// packet in with push(); the consumer reads it in place with peek() and
+// releases the slot with pop(), so a packet is copied exactly once on its way
+// from the producer to the socket.
+template <size_t SlotSize>
+class PacketRing {
+public:
+    // capacity is rounded up to a power of two
+    explicit PacketRing(size_t capacity) : m_head(0), m_tail(0) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        m_mask = size - 1;
+        m_data.resize(size * SlotSize);
+        m_lengths.resize(size);
+    }
+
+    // Producer side. Returns false if the packet is too large or the ring is full.
+    bool push(const uint8_t* data, size_t len) {
+        if (len > SlotSize) return false;
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) > m_mask) return false;
+
+        size_t slot = head & m_mask;
+        memcpy(&m_data[slot * SlotSize], data, len);
+        m_lengths[slot] = len;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: the index-th oldest packet, or nullptr if there are not that many
+    const uint8_t* peek(size_t& len, size_t index = 0) const {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (index >= m_head.load(std::memory_order_acquire) - tail) return nullptr;
+
+        size_t slot = (tail + index) & m_mask;
+        len = m_lengths[slot];
+        return &m_data[slot * SlotSize];
+    }
+
+    // Consumer side: release the count oldest packets returned by peek()
+    void pop(size_t count = 1) {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    bool empty() const {
+        return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire);
+    }
+
+private:
+    std::vector<uint8_t> m_data;
+    std::vector<size_t> m_lengths;
+    size_t m_mask;
+
+    // Producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) std::atomic<size_t> m_tail;
+};
@@ -23,16 +23,20 @@
 #include <QSpinBox>
 #include <QSlider>
 #include <QCheckBox>
+#include <QComboBox>
 #include <QLabel>
 #include <QPushButton>
 #include <QTimer>
 #include <QDialog>
+#include <QDockWidget>
 #include <QCoreApplication>
 #include <QMetaObject>
 #include <qmessagebox.h>
 #include <string>
 #include <chrono>
 #include "srtla-relay.h"
+#include "srtla-log.h"
+#include "stats-dock.h"
 
 OBS_DECLARE_MODULE()
 OBS_MODULE_USE_DEFAULT_LOCALE("obs-srtla-sender", "en-US")
@@ -42,6 +46,7 @@ SrtlaRelay* g_srtlaRelay = nullptr;
 
 // Function declarations
 static void add_srtla_menu_items();
+static void add_srtla_stats_dock();
 static void open_srtla_settings();
 static void start_srtla_sender();
 static void stop_srtla_sender();
@@ -104,6 +109,98 @@ public:
                                          "This ensures consistency between SRTLA relay and OBS streaming settings.", this);
         syncInfoLabel->setWordWrap(true);
         
+        // Create sender backend checkbox
+        nativeSenderCheckbox = new QCheckBox("Use built-in bonding engine (no srtla_send required)", this);
+        nativeSenderCheckbox->setChecked(g_srtlaRelay ? g_srtlaRelay->isNativeSenderEnabled() : true);
+        
+        // Create link scheduler selection, stored per OBS profile
+        schedulerCombo = new QComboBox(this);
+        schedulerCombo->addItem("Window (classic SRTLA)", (int)LinkSchedulerType::Window);
+        schedulerCombo->addItem("RTT-weighted", (int)LinkSchedulerType::RttWeighted);
+        schedulerCombo->addItem("Loss-penalised", (int)LinkSchedulerType::LossPenalised);
+        schedulerCombo->addItem("Priority (use cellular modems last)", (int)LinkSchedulerType::Priority);
+        LinkSchedulerType scheduler = g_srtlaRelay ? g_srtlaRelay->getLinkScheduler() : LinkSchedulerType::Window;
+        schedulerCombo->setCurrentIndex(schedulerCombo->findData((int)scheduler));
+        schedulerCombo->setEnabled(nativeSenderCheckbox->isChecked());
+        connect(nativeSenderCheckbox, &QCheckBox::toggled, schedulerCombo, &QComboBox::setEnabled);
+        
+        // Create round-robin DNS checkbox, only the built-in engine can use several addresses
+        spreadServersCheckbox = new QCheckBox("Spread links across all server addresses (round-robin DNS)", this);
+        spreadServersCheckbox->setChecked(g_srtlaRelay ? g_srtlaRelay->isSpreadServerAddressesEnabled() : false);
+        spreadServersCheckbox->setEnabled(nativeSenderCheckbox->isChecked());
+        connect(nativeSenderCheckbox, &QCheckBox::toggled, spreadServersCheckbox, &QCheckBox::setEnabled);
+        
+        // Create srtla_send log file checkbox, its output is otherwise only kept in memory
+        senderLogFileCheckbox = new QCheckBox("Keep srtla_send output in /tmp/srtla.log (rotated at 4 MiB)", this);
+        senderLogFileCheckbox->setChecked(g_srtlaRelay ? g_srtlaRelay->isSenderLogFileEnabled() : false);
+        senderLogFileCheckbox->setEnabled(!nativeSenderCheckbox->isChecked());
+        connect(nativeSenderCheckbox, &QCheckBox::toggled, [this](bool native) {
+            senderLogFileCheckbox->setEnabled(!native);
+        });
+        
+        // Create link quality gate checkbox and limits
+        linkGateCheckbox = new QCheckBox("Probe links before they carry the stream, demote degraded ones", this);
+        linkGateCheckbox->setChecked(g_srtlaRelay ? g_srtlaRelay->isLinkGateEnabled() : true);
+        
+        linkGateRttEdit = new QSpinBox(this);
+        linkGateRttEdit->setRange(50, 10000);
+        linkGateRttEdit->setSuffix(" ms");
+        linkGateRttEdit->setValue(g_srtlaRelay ? g_srtlaRelay->getLinkGateMaxRtt() : 1000);
+        
+        linkGateLossEdit = new QSpinBox(this);
+        linkGateLossEdit->setRange(0, 100);
+        linkGateLossEdit->setSuffix(" %");
+        linkGateLossEdit->setValue(g_srtlaRelay ? g_srtlaRelay->getLinkGateMaxLoss() : 20);
+        
+        QHBoxLayout *linkGateLayout = new QHBoxLayout;
+        linkGateLayout->addWidget(new QLabel("Max RTT:", this));
+        linkGateLayout->addWidget(linkGateRttEdit);
+        linkGateLayout->addWidget(new QLabel("Max loss:", this));
+        linkGateLayout->addWidget(linkGateLossEdit);
+        linkGateLayout->addStretch();
+        
+        auto updateLinkGateControls = [this]() {
+            bool enabled = nativeSenderCheckbox->isChecked() && linkGateCheckbox->isChecked();
+            linkGateCheckbox->setEnabled(nativeSenderCheckbox->isChecked());
+            linkGateRttEdit->setEnabled(enabled);
+            linkGateLossEdit->setEnabled(enabled);
+        };
+        connect(nativeSenderCheckbox, &QCheckBox::toggled, updateLinkGateControls);
+        connect(linkGateCheckbox, &QCheckBox::toggled, updateLinkGateControls);
+        updateLinkGateControls();
+        
+        // Create adaptive bitrate checkbox and limits
+        adaptiveBitrateCheckbox = new QCheckBox("Adapt encoder bitrate to bonded link capacity", this);
+        adaptiveBitrateCheckbox->setChecked(g_srtlaRelay ? g_srtlaRelay->isAdaptiveBitrateEnabled() : false);
+        
+        bitrateFloorEdit = new QSpinBox(this);
+        bitrateFloorEdit->setRange(100, 100000);
+        bitrateFloorEdit->setSuffix(" kbps");
+        bitrateFloorEdit->setValue(g_srtlaRelay ? g_srtlaRelay->getBitrateFloor() : 500);
+        
+        bitrateCeilingEdit = new QSpinBox(this);
+        bitrateCeilingEdit->setRange(0, 100000);
+        bitrateCeilingEdit->setSuffix(" kbps");
+        bitrateCeilingEdit->setSpecialValueText("Encoder setting");
+        bitrateCeilingEdit->setValue(g_srtlaRelay ? g_srtlaRelay->getBitrateCeiling() : 0);
+        
+        QHBoxLayout *bitrateLayout = new QHBoxLayout;
+        bitrateLayout->addWidget(new QLabel("Min:", this));
+        bitrateLayout->addWidget(bitrateFloorEdit);
+        bitrateLayout->addWidget(new QLabel("Max:", this));
+        bitrateLayout->addWidget(bitrateCeilingEdit);
+        bitrateLayout->addStretch();
+        
+        auto updateBitrateControls = [this]() {
+            bool enabled = nativeSenderCheckbox->isChecked() && adaptiveBitrateCheckbox->isChecked();
+            adaptiveBitrateCheckbox->setEnabled(nativeSenderCheckbox->isChecked());
+            bitrateFloorEdit->setEnabled(enabled);
+            bitrateCeilingEdit->setEnabled(enabled);
+        };
+        connect(nativeSenderCheckbox, &QCheckBox::toggled, updateBitrateControls);
+        connect(adaptiveBitrateCheckbox, &QCheckBox::toggled, updateBitrateControls);
+        updateBitrateControls();
+        
         // Create a layout for the fixed port checkbox and spinbox
         QHBoxLayout *portLayout = new QHBoxLayout;
         portLayout->addWidget(useFixedPortCheckbox);
@@ -157,11 +254,19 @@ public:
         formLayout->addRow("SRT Latency:", latencySlider);
         formLayout->addRow("", latencyLabel);
         formLayout->addRow("Local Port:", portLayout);
+        formLayout->addRow("Link Scheduler (this profile):", schedulerCombo);
+        formLayout->addRow("", linkGateCheckbox);
+        formLayout->addRow("Link Quality:", linkGateLayout);
+        formLayout->addRow("", adaptiveBitrateCheckbox);
+        formLayout->addRow("Encoder Bitrate:", bitrateLayout);
         
         // Main layout
         QVBoxLayout *mainLayout = new QVBoxLayout;
         mainLayout->addLayout(formLayout);
         mainLayout->addWidget(autoStartCheckbox);
+        mainLayout->addWidget(nativeSenderCheckbox);
+        mainLayout->addWidget(spreadServersCheckbox);
+        mainLayout->addWidget(senderLogFileCheckbox);
         mainLayout->addLayout(syncButtonLayout);  // Add sync checkbox and button
         mainLayout->addWidget(syncInfoLabel);     // Add sync description
         mainLayout->addWidget(portInfoLabel);
@@ -179,6 +284,16 @@ public:
         bool useFixedPort = useFixedPortCheckbox->isChecked();
         uint16_t localPort = localPortEdit->value();
         bool bidirectionalSync = bidirectionalSyncCheckbox->isChecked();
+        bool useNativeSender = nativeSenderCheckbox->isChecked();
+        bool spreadServers = spreadServersCheckbox->isChecked();
+        bool senderLogFile = senderLogFileCheckbox->isChecked();
+        LinkSchedulerType scheduler = (LinkSchedulerType)schedulerCombo->currentData().toInt();
+        bool linkGate = linkGateCheckbox->isChecked();
+        int linkGateRtt = linkGateRttEdit->value();
+        int linkGateLoss = linkGateLossEdit->value();
+        bool adaptiveBitrate = adaptiveBitrateCheckbox->isChecked();
+        int bitrateFloor = bitrateFloorEdit->value();
+        int bitrateCeiling = bitrateCeilingEdit->value();
         
         if (!g_srtlaRelay)
             return;
@@ -186,30 +301,41 @@ public:
         // Store old values to track changes
         bool syncWasEnabled = g_srtlaRelay->isBidirectionalSyncEnabled();
         uint16_t oldPort = g_srtlaRelay->getLocalPort();
+        std::string oldServer = g_srtlaRelay->getServer();
+        uint16_t oldServerPort = g_srtlaRelay->getPort();
         int oldLatency = g_srtlaRelay->getLatency();
         std::string oldStreamId = g_srtlaRelay->getStreamId();
+        bool oldNativeSender = g_srtlaRelay->isNativeSenderEnabled();
+        bool oldSpreadServers = g_srtlaRelay->isSpreadServerAddressesEnabled();
         
         // Get current OBS URL BEFORE making any changes (for notification)
         std::string currentOBSUrl = g_srtlaRelay->getCurrentOBSStreamServerURL();
         
-        // Update all settings
-        g_srtlaRelay->setServer(server);
-        g_srtlaRelay->setPort(port);
-        g_srtlaRelay->setStreamId(streamId);
-        g_srtlaRelay->setAutoStart(autoStart);
-        g_srtlaRelay->setLatency(latency);
-        g_srtlaRelay->setUseFixedPort(useFixedPort);
-        g_srtlaRelay->setLocalPort(localPort);
-        g_srtlaRelay->setBidirectionalSync(bidirectionalSync);
-        
-        // Always use fixed port when bidirectional sync is enabled
-        if (bidirectionalSync) {
-            g_srtlaRelay->setUseFixedPort(true);
+        // Update all settings, written to the settings file once at the end of the block
+        {
+            SrtlaRelay::SettingsBatch batch(*g_srtlaRelay);
+            g_srtlaRelay->setServer(server);
+            g_srtlaRelay->setPort(port);
+            g_srtlaRelay->setStreamId(streamId);
+            g_srtlaRelay->setAutoStart(autoStart);
+            g_srtlaRelay->setLatency(latency);
+            g_srtlaRelay->setUseFixedPort(useFixedPort);
+            g_srtlaRelay->setLocalPort(localPort);
+            g_srtlaRelay->setBidirectionalSync(bidirectionalSync);
+            g_srtlaRelay->setUseNativeSender(useNativeSender);
+            g_srtlaRelay->setSpreadServerAddresses(spreadServers);
+            g_srtlaRelay->setSenderLogFile(senderLogFile);
+            g_srtlaRelay->setLinkScheduler(scheduler);
+            g_srtlaRelay->setLinkGate(linkGate, linkGateRtt, linkGateLoss);
+            g_srtlaRelay->setBitrateLimits(bitrateFloor, bitrateCeiling);
+            g_srtlaRelay->setAdaptiveBitrate(adaptiveBitrate);
+            
+            // Always use fixed port when bidirectional sync is enabled
+            if (bidirectionalSync) {
+                g_srtlaRelay->setUseFixedPort(true);
+            }
         }
         
-        // Save settings to file
-        g_srtlaRelay->saveSettings();
-        
         blog(LOG_INFO, "SRTLA settings updated: server=%s, port=%d, stream_id=%s, latency=%d, use_fixed_port=%d, local_port=%d, bidirectional_sync=%d", 
              server.c_str(), port, streamId.c_str(), latency, useFixedPort, localPort, bidirectionalSync);
         
@@ -251,15 +377,15 @@ public:
             
             // Always update when settings are saved, to ensure latency is included
             blog(LOG_INFO, "Updating OBS service URL on settings save...");
-            if (g_srtlaRelay->syncToOBSService()) {
-                blog(LOG_INFO, "Successfully updated OBS service with new settings including latency");
-                
-                // Use the notification from syncToOBSService to avoid duplicates
-            }
+            // Runs in the background, syncToOBSService notifies when the URL changed
+            g_srtlaRelay->syncToOBSService();
         }
         
-        // If SRTLA is running and local port changed, restart it
-        if (g_srtlaRelay->isRunning() && oldPort != localPort) {
+        // If SRTLA is running and the server, local port or backend changed,
+        // restart it; only a new local port makes the built-in engine drop
+        // the stream for a moment
+        if (g_srtlaRelay->isRunning() && (oldPort != localPort || oldServer != server || oldServerPort != port ||
+                                          oldNativeSender != useNativeSender || oldSpreadServers != spreadServers)) {
             blog(LOG_INFO, "Restarting SRTLA with new port: %d", localPort);
             g_srtlaRelay->restartWithPort(localPort);
         }
@@ -277,6 +403,16 @@ private:
     QCheckBox *useFixedPortCheckbox;
     QSpinBox *localPortEdit;
     QCheckBox *bidirectionalSyncCheckbox;
+    QCheckBox *nativeSenderCheckbox;
+    QCheckBox *spreadServersCheckbox;
+    QCheckBox *senderLogFileCheckbox;
+    QComboBox *schedulerCombo;
+    QCheckBox *linkGateCheckbox;
+    QSpinBox *linkGateRttEdit;
+    QSpinBox *linkGateLossEdit;
+    QCheckBox *adaptiveBitrateCheckbox;
+    QSpinBox *bitrateFloorEdit;
+    QSpinBox *bitrateCeilingEdit;
 };
 
 // Register our service
@@ -440,6 +576,26 @@ static void add_srtla_menu_items() {
     update_menu_text();
 }
 
+#define SRTLA_STATS_DOCK_ID "srtla-link-stats"
+
+// Dock with live per-link statistics
+static void add_srtla_stats_dock() {
+    QMainWindow *main_window = (QMainWindow*)obs_frontend_get_main_window();
+    if (!main_window)
+        return;
+
+#if LIBOBS_API_MAJOR_VER >= 30
+    obs_frontend_add_dock_by_id(SRTLA_STATS_DOCK_ID, "SRTLA Links", new SrtlaStatsDock(main_window));
+#else
+    QDockWidget *dock = new QDockWidget("SRTLA Links", main_window);
+    dock->setObjectName(SRTLA_STATS_DOCK_ID);
+    dock->setWidget(new SrtlaStatsDock(dock));
+    dock->setFloating(true);
+    dock->hide();
+    obs_frontend_add_dock(dock);
+#endif
+}
+
 // Front-end event callback
 static void on_event(enum obs_frontend_event event, void *data) {
     UNUSED_PARAMETER(data);
@@ -505,6 +661,31 @@ static void on_event(enum obs_frontend_event event, void *data) {
         if (g_srtlaRelay && g_srtlaRelay->isBidirectionalSyncEnabled()) {
             blog(LOG_INFO, "Bidirectional sync is enabled, syncing settings");
             g_srtlaRelay->syncFromOBSService();
+            
+            // The streaming service is loaded now, persist our port into it
+            blog(LOG_INFO, "Syncing saved settings to OBS at startup");
+            g_srtlaRelay->syncToOBSService();
+        }
+    }
+    // Capture the encoder bitrate for adaptive control, and restore it afterwards
+    else if (event == OBS_FRONTEND_EVENT_STREAMING_STARTED) {
+        if (g_srtlaRelay) {
+            g_srtlaRelay->onStreamingStarted();
+        }
+    }
+    else if (event == OBS_FRONTEND_EVENT_STREAMING_STOPPED) {
+        if (g_srtlaRelay) {
+            g_srtlaRelay->onStreamingStopped();
+        }
+    }
+    // Link scheduling is chosen per profile
+    else if (event == OBS_FRONTEND_EVENT_PROFILE_CHANGED) {
+        if (g_srtlaRelay) {
+            g_srtlaRelay->onProfileChanged();
+            
+            // Each profile has its own streaming service
+            if (g_srtlaRelay->isBidirectionalSyncEnabled())
+                g_srtlaRelay->syncToOBSService();
         }
     }
     // Monitor changes to the service
@@ -521,6 +702,11 @@ static void on_event(enum obs_frontend_event event, void *data) {
 bool obs_module_load(void) {
     blog(LOG_INFO, "SRTLA Sender plugin loaded");
 
+    // Route log output of the bonding engine and helpers to the OBS log
+    srtla_log_set_handler([](int level, const char* message) {
+        blog(level, "[SRTLA] %s", message);
+    });
+
     // Create our plugin instance
     g_srtlaRelay = new SrtlaRelay();
     g_srtlaRelay->init();
@@ -530,6 +716,9 @@ bool obs_module_load(void) {
 
     // Add menu items
     add_srtla_menu_items();
+    
+    // Add the link statistics dock
+    add_srtla_stats_dock();
 
     // Hook into frontend events for auto start/stop
     obs_frontend_add_event_callback(on_event, nullptr);
@@ -537,12 +726,14 @@ bool obs_module_load(void) {
     // Set up a timer to periodically monitor service settings for changes
     QMainWindow *main_window = (QMainWindow*)obs_frontend_get_main_window();
     if (main_window) {
-        // First, before setting up timer, force sync settings from local storage to OBS
-        // This ensures port values are persisted at startup
-        if (g_srtlaRelay && g_srtlaRelay->isBidirectionalSyncEnabled()) {
-            blog(LOG_INFO, "Forcing initial sync of saved settings to OBS at startup");
-            g_srtlaRelay->syncToOBSService();
-        }
+        // Poll link statistics for the dock and the adaptive bitrate loop
+        QTimer *statsTimer = new QTimer(main_window);
+        statsTimer->setInterval(SRTLA_STATS_INTERVAL_MS);
+        QObject::connect(statsTimer, &QTimer::timeout, []() {
+            if (g_srtlaRelay)
+                g_srtlaRelay->pollLinkStats();
+        });
+        statsTimer->start();
         
         QTimer *serviceMonitorTimer = new QTimer(main_window);
         
@@ -687,10 +878,16 @@ bool obs_module_load(void) {
 void obs_module_unload(void) {
     blog(LOG_INFO, "SRTLA Sender plugin unloaded");
 
+#if LIBOBS_API_MAJOR_VER >= 30
+    obs_frontend_remove_dock(SRTLA_STATS_DOCK_ID);
+#endif
+
     if (g_srtlaRelay) {
         delete g_srtlaRelay;
         g_srtlaRelay = nullptr;
     }
+
+    srtla_log_set_handler(nullptr);
 }
 
 // Instead of redefining obs_get_module, we'll expose our sender instance via a different method
@@ -0,0 +1,161 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Child process output capture
+ *
+ * Keeps srtla_send's output in memory instead of an ever-growing file and
+ * recognises the events it reports.
+ *
+ * License: GPL-3.0
+ */
+
+#include "process-output.h"
+#include "srtla-log.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+ProcessOutput::ProcessOutput(size_t lines)
+    : m_ring(lines),
+      m_dropped(0),
+      m_lineLen(0),
+      m_spillMaxBytes(0),
+      m_spillBytes(0),
+      m_spillFd(-1) {
+}
+
+ProcessOutput::~ProcessOutput() {
+    if (m_spillFd >= 0) close(m_spillFd);
+}
+
+void ProcessOutput::setSpillFile(const std::string& path, size_t maxBytes) {
+    if (m_spillFd >= 0) {
+        close(m_spillFd);
+        m_spillFd = -1;
+    }
+    m_spillPath = path;
+    m_spillMaxBytes = maxBytes;
+}
+
+void ProcessOutput::append(const char* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (c == '\n') {
+            commitLine();
+        } else if (m_lineLen < PROCESS_OUTPUT_LINE_MAX) {
+            m_line[m_lineLen++] = c;
+        }
+    }
+}
+
+void ProcessOutput::finish() {
+    commitLine();
+    if (m_spillFd >= 0) {
+        close(m_spillFd);
+        m_spillFd = -1;
+    }
+}
+
+void ProcessOutput::commitLine() {
+    size_t len = m_lineLen;
+    m_lineLen = 0;
+    while (len > 0 && (m_line[len - 1] == '\r' || m_line[len - 1] == ' ')) len--;
+    if (len == 0) return;
+
+    if (!m_ring.push((const uint8_t*)m_line, len)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!m_spillPath.empty()) {
+        spill(m_line, len);
+    }
+}
+
+void ProcessOutput::spill(const char* data, size_t len) {
+    // Rotate before the file would grow past the limit
+    if (m_spillFd >= 0 && m_spillBytes + len + 1 > m_spillMaxBytes) {
+        close(m_spillFd);
+        m_spillFd = -1;
+        std::string rotated = m_spillPath + ".1";
+        if (rename(m_spillPath.c_str(), rotated.c_str()) != 0) {
+            unlink(m_spillPath.c_str());
+        }
+    }
+    if (m_spillFd < 0) {
+        m_spillFd = open(m_spillPath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (m_spillFd < 0) {
+            srtla_log(SRTLA_LOG_WARNING, "Cannot write %s: %s", m_spillPath.c_str(), strerror(errno));
+            m_spillPath.clear();
+            return;
+        }
+        struct stat st;
+        m_spillBytes = fstat(m_spillFd, &st) == 0 ? (size_t)st.st_size : 0;
+    }
+
+    char buf[PROCESS_OUTPUT_LINE_MAX + 1];
+    memcpy(buf, data, len);
+    buf[len] = '\n';
+    ssize_t ret = write(m_spillFd, buf, len + 1);
+    if (ret > 0) m_spillBytes += (size_t)ret;
+}
+
+bool ProcessOutput::pop(std::string& line) {
+    size_t len;
+    const uint8_t* data = m_ring.peek(len);
+    if (!data) return false;
+    line.assign((const char*)data, len);
+    m_ring.pop();
+    return true;
+}
+
+static bool contains(const std::string& haystack, const char* needle) {
+    return haystack.find(needle) != std::string::npos;
+}
+
+bool parseSrtlaSendEvent(const std::string& line, SrtlaSendEvent& event) {
+    std::string text = line;
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char)tolower(c); });
+
+    // Per-link lines start with "<address> (<connection pointer>): "
+    event.link.clear();
+    size_t paren = line.find(" (");
+    if (paren != std::string::npos && paren > 0 && line.find("): ", paren) != std::string::npos) {
+        event.link = line.substr(0, paren);
+    }
+
+    if (contains(text, "no available connections") || contains(text, "all connections failed")) {
+        event.type = SrtlaSendEvent::Type::ConnectionLost;
+    } else if (contains(text, "connection failed") || contains(text, "timed out")) {
+        event.type = SrtlaSendEvent::Type::LinkTimedOut;
+    } else if (contains(text, "group registered")) {
+        event.type = SrtlaSendEvent::Type::GroupRegistered;
+    } else if (contains(text, "connection established") || contains(text, "connection registered")) {
+        event.type = SrtlaSendEvent::Type::LinkRegistered;
+    } else if (contains(text, "failed") || contains(text, "error")) {
+        event.type = SrtlaSendEvent::Type::Error;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* srtlaSendEventName(SrtlaSendEvent::Type type) {
+    switch (type) {
+    case SrtlaSendEvent::Type::GroupRegistered:
+        return "group registered";
+    case SrtlaSendEvent::Type::LinkRegistered:
+        return "link registered";
+    case SrtlaSendEvent::Type::LinkTimedOut:
+        return "link timed out";
+    case SrtlaSendEvent::Type::ConnectionLost:
+        return "connection lost";
+    case SrtlaSendEvent::Type::Error:
+    default:
+        return "error";
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "packet-ring.h"
+
+// Longest output line kept; longer lines are truncated
+static constexpr size_t PROCESS_OUTPUT_LINE_MAX = 256;
+
+// Output of a child process, captured from its stdout/stderr pipe.
+//
+// The supervisor thread feeds raw output with append(). Complete lines go
+// to a fixed-size lock-free ring that one consumer drains with pop(), and
+// optionally to a spill file that is rotated once it reaches a size limit.
+// When the ring is full, new lines are dropped and counted, so a chatty
+// child never grows memory or blocks on its pipe.
+class ProcessOutput {
+public:
+    explicit ProcessOutput(size_t lines = 512);
+    ~ProcessOutput();
+
+    // Also write every line to path, moved to path.1 when it reaches
+    // maxBytes. An empty path disables it. Not while a producer is running.
+    void setSpillFile(const std::string& path, size_t maxBytes);
+
+    // Producer side: raw bytes read from the pipe
+    void append(const char* data, size_t len);
+
+    // Producer side: the pipe was closed, keep the unterminated last line
+    void finish();
+
+    // Consumer side: the oldest line not yet read, without its newline
+    bool pop(std::string& line);
+
+    // Lines lost to a full ring
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    void commitLine();
+    void spill(const char* data, size_t len);
+
+    PacketRing<PROCESS_OUTPUT_LINE_MAX> m_ring;
+    std::atomic<uint64_t> m_dropped;
+
+    // Producer only
+    char m_line[PROCESS_OUTPUT_LINE_MAX];
+    size_t m_lineLen;
+    std::string m_spillPath;
+    size_t m_spillMaxBytes;
+    size_t m_spillBytes;
+    int m_spillFd;
+};
+
+// Events srtla_send reports on its output
+struct SrtlaSendEvent {
+    enum class Type {
+        GroupRegistered,  // the receiver created our connection group
+        LinkRegistered,   // a link joined the group and carries data
+        LinkTimedOut,     // a link stopped answering and is reconnecting
+        ConnectionLost,   // no link is left to send on
+        Error             // anything else srtla_send reports as failing
+    };
+
+    Type type;
+    std::string link;  // address of the link the line is about, if any
+};
+
+// Recognises an srtla_send output line. False for lines that are not events.
+bool parseSrtlaSendEvent(const std::string& line, SrtlaSendEvent& event);
+
+const char* srtlaSendEventName(SrtlaSendEvent::Type type);
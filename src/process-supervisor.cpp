@@ -0,0 +1,395 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Child process supervisor
+ *
+ * Launches srtla_send without a shell and tracks it by pidfd, so the
+ * plugin always knows whether its own sender is alive.
+ *
+ * License: GPL-3.0
+ */
+
+#include "process-supervisor.h"
+#include "process-output.h"
+#include "srtla-log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+#ifndef SYS_pidfd_send_signal
+#define SYS_pidfd_send_signal 424
+#endif
+
+extern char** environ;
+
+// Restart backoff: doubles from the minimum up to the maximum, and resets
+// once a child has stayed up for the stable period
+static constexpr int RESTART_BACKOFF_MIN_MS = 20;
+static constexpr int RESTART_BACKOFF_MAX_MS = 5000;
+static constexpr int RESTART_STABLE_MS = 10000;
+
+// Time the child gets to exit after SIGTERM before it is killed
+static constexpr int STOP_GRACE_MS = 2000;
+
+// Exit polling interval on kernels without pidfd support (< 5.3)
+static constexpr int FALLBACK_POLL_MS = 100;
+
+ProcessSupervisor::ProcessSupervisor()
+    : m_output(nullptr),
+      m_outputFd(-1),
+      m_state(State::Stopped),
+      m_pid(-1),
+      m_pidFd(-1),
+      m_wakeFd(-1),
+      m_epollFd(-1),
+      m_stopRequested(false) {
+}
+
+ProcessSupervisor::~ProcessSupervisor() {
+    stop();
+}
+
+void ProcessSupervisor::setStateCallback(StateCallback callback) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stateCallback = std::move(callback);
+}
+
+void ProcessSupervisor::setState(State state) {
+    m_state = state;
+
+    StateCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        callback = m_stateCallback;
+    }
+    if (callback) {
+        callback(state, m_pid);
+    }
+}
+
+bool ProcessSupervisor::start(const std::vector<std::string>& argv, ProcessOutput* output) {
+    if (m_thread.joinable()) {
+        srtla_log(SRTLA_LOG_WARNING, "Process supervisor already running");
+        return false;
+    }
+    if (argv.empty()) {
+        return false;
+    }
+
+    m_argv = argv;
+    m_output = output;
+
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_wakeFd < 0 || m_epollFd < 0) {
+        srtla_log(SRTLA_LOG_ERROR, "Failed to create supervisor descriptors: %s", strerror(errno));
+        stop();
+        return false;
+    }
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = m_wakeFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &ev);
+
+    if (!spawnChild()) {
+        stop();
+        return false;
+    }
+
+    m_stopRequested = false;
+    setState(State::Running);
+    m_thread = std::thread(&ProcessSupervisor::supervisorThread, this);
+    return true;
+}
+
+void ProcessSupervisor::stop() {
+    if (m_thread.joinable()) {
+        m_stopRequested = true;
+        uint64_t one = 1;
+        ssize_t ret = write(m_wakeFd, &one, sizeof(one));
+        (void)ret;
+        m_thread.join();
+    } else if (m_pid > 0) {
+        // Thread never started, make sure the child does not linger
+        signal(SIGKILL);
+        reapChild();
+    }
+
+    if (m_epollFd >= 0) close(m_epollFd);
+    if (m_wakeFd >= 0) close(m_wakeFd);
+    m_epollFd = -1;
+    m_wakeFd = -1;
+
+    if (m_state != State::Stopped) {
+        setState(State::Stopped);
+    }
+}
+
+bool ProcessSupervisor::signal(int sig) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    pid_t pid = m_pid;
+    if (pid <= 0) return false;
+
+    // The pidfd cannot refer to a recycled PID, fall back to kill() without one
+    if (m_pidFd >= 0) {
+        return syscall(SYS_pidfd_send_signal, m_pidFd, sig, nullptr, 0) == 0;
+    }
+    return kill(pid, sig) == 0;
+}
+
+bool ProcessSupervisor::spawnChild() {
+    std::vector<char*> args;
+    for (auto& arg : m_argv) {
+        args.push_back(const_cast<char*>(arg.c_str()));
+    }
+    args.push_back(nullptr);
+
+    // A fresh pipe per child, so a restarted one never shares the old one's tail
+    int pipeFds[2] = {-1, -1};
+    if (m_output && pipe2(pipeFds, O_CLOEXEC) != 0) {
+        srtla_log(SRTLA_LOG_ERROR, "Failed to create output pipe: %s", strerror(errno));
+        return false;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (m_output) {
+        posix_spawn_file_actions_adddup2(&actions, pipeFds[1], STDOUT_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, pipeFds[1], STDERR_FILENO);
+    }
+
+    // Own process group, so signals sent to OBS's group do not hit the sender
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+    posix_spawnattr_setpgroup(&attr, 0);
+    sigset_t mask;
+    sigemptyset(&mask);
+    posix_spawnattr_setsigmask(&attr, &mask);
+    sigset_t defaults;
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGHUP);
+    sigaddset(&defaults, SIGTERM);
+    sigaddset(&defaults, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+
+    pid_t pid = -1;
+    int err = posix_spawn(&pid, args[0], &actions, &attr, args.data(), environ);
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+
+    // Only the child writes, so the pipe reports EOF once it is gone
+    if (pipeFds[1] >= 0) close(pipeFds[1]);
+
+    if (err != 0) {
+        if (pipeFds[0] >= 0) close(pipeFds[0]);
+        srtla_log(SRTLA_LOG_ERROR, "Failed to spawn %s: %s", args[0], strerror(err));
+        return false;
+    }
+
+    if (pipeFds[0] >= 0) {
+        fcntl(pipeFds[0], F_SETFL, O_NONBLOCK);
+        m_outputFd = pipeFds[0];
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = m_outputFd;
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_outputFd, &ev);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pid = pid;
+    m_pidFd = (int)syscall(SYS_pidfd_open, pid, 0);
+    if (m_pidFd >= 0) {
+        fcntl(m_pidFd, F_SETFD, FD_CLOEXEC);
+        epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = m_pidFd;
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_pidFd, &ev);
+    } else {
+        srtla_log(SRTLA_LOG_WARNING, "pidfd_open unavailable (%s), polling for child exit", strerror(errno));
+    }
+
+    srtla_log(SRTLA_LOG_INFO, "Started %s with PID %d", args[0], pid);
+    return true;
+}
+
+void ProcessSupervisor::readOutput() {
+    char buf[4096];
+    while (m_outputFd >= 0) {
+        ssize_t n = read(m_outputFd, buf, sizeof(buf));
+        if (n > 0) {
+            m_output->append(buf, (size_t)n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && errno == EAGAIN) {
+            break;
+        } else {
+            closeOutput();
+        }
+    }
+}
+
+void ProcessSupervisor::closeOutput() {
+    if (m_outputFd < 0) return;
+    if (m_epollFd >= 0) {
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, m_outputFd, nullptr);
+    }
+    close(m_outputFd);
+    m_outputFd = -1;
+    m_output->finish();
+}
+
+void ProcessSupervisor::reapChild() {
+    // Forget the child before reaping it, so signal() can never reach a recycled PID
+    pid_t pid;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_pidFd >= 0) {
+            if (m_epollFd >= 0) {
+                epoll_ctl(m_epollFd, EPOLL_CTL_DEL, m_pidFd, nullptr);
+            }
+            close(m_pidFd);
+            m_pidFd = -1;
+        }
+        pid = m_pid;
+        m_pid = -1;
+    }
+
+    // Whatever the child wrote before exiting, unless a grandchild holds the pipe open
+    readOutput();
+    closeOutput();
+
+    if (pid > 0) {
+        int status = 0;
+        if (waitpid(pid, &status, 0) == pid) {
+            if (WIFEXITED(status)) {
+                srtla_log(SRTLA_LOG_INFO, "Process %d exited with code %d", pid, WEXITSTATUS(status));
+            } else if (WIFSIGNALED(status)) {
+                srtla_log(SRTLA_LOG_INFO, "Process %d terminated by signal %d", pid, WTERMSIG(status));
+            }
+        }
+    }
+}
+
+void ProcessSupervisor::supervisorThread() {
+    using Clock = std::chrono::steady_clock;
+
+    int backoffMs = RESTART_BACKOFF_MIN_MS;
+    Clock::time_point startedAt = Clock::now();
+    Clock::time_point restartAt;
+    Clock::time_point killAt;
+    bool terminating = false;
+
+    while (true) {
+        Clock::time_point now = Clock::now();
+
+        // Stop requested: SIGTERM once, SIGKILL when the grace period runs out
+        if (m_stopRequested && m_pid > 0 && !terminating) {
+            signal(SIGTERM);
+            terminating = true;
+            killAt = now + std::chrono::milliseconds(STOP_GRACE_MS);
+        }
+        if (m_stopRequested && m_pid <= 0) {
+            break;
+        }
+        if (terminating && now >= killAt) {
+            srtla_log(SRTLA_LOG_WARNING, "Process %d ignored SIGTERM, killing it", (int)m_pid);
+            signal(SIGKILL);
+            killAt = now + std::chrono::milliseconds(STOP_GRACE_MS);
+        }
+
+        // Respawn once the backoff has elapsed
+        if (!m_stopRequested && m_state == State::Restarting && now >= restartAt) {
+            if (spawnChild()) {
+                startedAt = now;
+                setState(State::Running);
+            } else {
+                srtla_log(SRTLA_LOG_ERROR, "Giving up on restarting %s", m_argv[0].c_str());
+                setState(State::Stopped);
+                break;
+            }
+        }
+
+        // Sleep until the next deadline, the child's exit or a wake-up
+        int timeout = -1;
+        auto untilMs = [now](Clock::time_point t) {
+            return (int)std::max<long long>(0,
+                std::chrono::duration_cast<std::chrono::milliseconds>(t - now).count());
+        };
+        if (terminating) timeout = untilMs(killAt);
+        else if (m_state == State::Restarting) timeout = untilMs(restartAt);
+        if (m_pid > 0 && m_pidFd < 0) {
+            timeout = (timeout < 0) ? FALLBACK_POLL_MS : std::min(timeout, FALLBACK_POLL_MS);
+        }
+
+        epoll_event events[3];
+        int count = epoll_wait(m_epollFd, events, 3, timeout);
+        if (count < 0 && errno != EINTR) {
+            srtla_log(SRTLA_LOG_ERROR, "Supervisor epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        bool exited = false;
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.fd == m_wakeFd) {
+                uint64_t value;
+                ssize_t ret = read(m_wakeFd, &value, sizeof(value));
+                (void)ret;
+            } else if (events[i].data.fd == m_pidFd) {
+                exited = true;
+            } else if (events[i].data.fd == m_outputFd) {
+                readOutput();
+            }
+        }
+
+        // Without a pidfd, check for exit without blocking
+        if (!exited && m_pid > 0 && m_pidFd < 0) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            int status;
+            pid_t pid = m_pid;
+            if (waitpid(pid, &status, WNOHANG) == pid) {
+                srtla_log(SRTLA_LOG_INFO, "Process %d exited", pid);
+                m_pid = -1;
+                exited = true;
+            }
+        }
+
+        if (!exited) continue;
+
+        reapChild();
+        if (m_stopRequested) break;
+
+        // Crashed: restart quickly, backing off if it keeps dying
+        auto upMs = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - startedAt).count();
+        if (upMs >= RESTART_STABLE_MS) {
+            backoffMs = RESTART_BACKOFF_MIN_MS;
+        }
+        srtla_log(SRTLA_LOG_WARNING, "%s exited unexpectedly, restarting in %d ms", m_argv[0].c_str(), backoffMs);
+        restartAt = Clock::now() + std::chrono::milliseconds(backoffMs);
+        backoffMs = std::min(backoffMs * 2, RESTART_BACKOFF_MAX_MS);
+        setState(State::Restarting);
+    }
+
+    if (m_pid > 0) {
+        signal(SIGKILL);
+        reapChild();
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/types.h>
+
+class ProcessOutput;
+
+// Spawns a child process with posix_spawn and keeps it alive.
+//
+// The child is tracked through a pidfd, so its exit is noticed immediately
+// on the supervisor thread and exactly our own process is signalled. A
+// crashed child is restarted with exponential backoff.
+class ProcessSupervisor {
+public:
+    enum class State {
+        Stopped,     // not supervising anything
+        Running,     // child is alive
+        Restarting   // child exited, waiting for the backoff to respawn it
+    };
+
+    using StateCallback = std::function<void(State state, pid_t pid)>;
+
+    ProcessSupervisor();
+    ~ProcessSupervisor();
+
+    // Spawn argv[0] with the given arguments, capturing its stdout/stderr
+    // into output through a pipe; without one the child inherits ours.
+    // output must outlive stop(). Returns false if the first spawn fails.
+    bool start(const std::vector<std::string>& argv, ProcessOutput* output = nullptr);
+
+    // Terminate the child (SIGTERM, then SIGKILL after a grace period) and stop supervising
+    void stop();
+
+    // Whether a child is being supervised (alive or about to be restarted)
+    bool isSupervising() const { return m_state != State::Stopped; }
+
+    // Current child PID, or -1
+    pid_t pid() const { return m_pid; }
+
+    // Send a signal to our child only
+    bool signal(int sig);
+
+    // Called from the supervisor thread on every state change
+    void setStateCallback(StateCallback callback);
+
+private:
+    bool spawnChild();
+    void reapChild();
+    void readOutput();
+    void closeOutput();
+    void supervisorThread();
+    void setState(State state);
+
+    std::vector<std::string> m_argv;
+    ProcessOutput* m_output;
+    int m_outputFd;  // read end of the child's stdout/stderr pipe
+
+    std::atomic<State> m_state;
+    std::atomic<pid_t> m_pid;
+    int m_pidFd;
+    int m_wakeFd;
+    int m_epollFd;
+
+    // Guards the callback, and the PID/pidfd against signal() from other threads
+    std::mutex m_mutex;
+    StateCallback m_stateCallback;
+
+    std::thread m_thread;
+    std::atomic<bool> m_stopRequested;
+};
@@ -0,0 +1,123 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Profile stream URL cache
+ *
+ * Keeps the stream URL of each OBS profile in memory, so asking for the
+ * active profile's URL does not mean parsing its service.json every time.
+ *
+ * License: GPL-3.0
+ */
+
+#include "profile-url-cache.h"
+#include "srtla-log.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+
+static const char SERVICE_FILE[] = "service.json";
+
+ProfileUrlCache::ProfileUrlCache(Loader loader)
+    : m_loader(std::move(loader)) {
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0) {
+        srtla_log(SRTLA_LOG_WARNING, "inotify unavailable (%s), checking service.json on every lookup",
+                  strerror(errno));
+    }
+}
+
+ProfileUrlCache::~ProfileUrlCache() {
+    if (m_inotifyFd >= 0) {
+        close(m_inotifyFd);
+    }
+}
+
+std::string ProfileUrlCache::lookup(const std::string& profileDir) {
+    if (m_inotifyFd >= 0) {
+        watchDir(profileDir);
+        drainEvents();
+    }
+
+    std::string path = profileDir + "/" + SERVICE_FILE;
+    Entry& entry = m_entries[path];
+    if (entry.valid && m_inotifyFd >= 0) {
+        return entry.url;
+    }
+
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        entry = Entry();
+        return std::string();
+    }
+
+    // Without inotify, the file identity and mtime tell whether it changed;
+    // an inotify invalidation always means a reload, as a rewrite within the
+    // same timestamp tick can leave mtime and size unchanged
+    bool unchanged = m_inotifyFd < 0 && entry.inode == st.st_ino && entry.size == st.st_size &&
+                     entry.mtimeSec == st.st_mtim.tv_sec && entry.mtimeNsec == st.st_mtim.tv_nsec;
+    if (!unchanged) {
+        entry.url = m_loader(path);
+        entry.inode = st.st_ino;
+        entry.mtimeSec = st.st_mtim.tv_sec;
+        entry.mtimeNsec = st.st_mtim.tv_nsec;
+        entry.size = st.st_size;
+    }
+    entry.valid = true;
+    return entry.url;
+}
+
+void ProfileUrlCache::watchDir(const std::string& dir) {
+    if (m_watchedDirs.count(dir)) return;
+
+    // Watch the directory, not the file: OBS replaces service.json by renaming over it
+    int wd = inotify_add_watch(m_inotifyFd, dir.c_str(),
+                               IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF);
+    if (wd < 0) {
+        // Missing profile directory: nothing to cache, stat() reports it
+        return;
+    }
+    m_watchDirs[wd] = dir;
+    m_watchedDirs[dir] = wd;
+}
+
+void ProfileUrlCache::drainEvents() {
+    alignas(inotify_event) char buf[4096];
+    while (true) {
+        ssize_t len = read(m_inotifyFd, buf, sizeof(buf));
+        if (len <= 0) break;
+
+        for (ssize_t off = 0; off < len;) {
+            const inotify_event* ev = (const inotify_event*)(buf + off);
+            off += sizeof(inotify_event) + ev->len;
+
+            // Events were lost, any file may have changed
+            if (ev->mask & IN_Q_OVERFLOW) {
+                for (auto& entry : m_entries) {
+                    entry.second.valid = false;
+                }
+                continue;
+            }
+
+            auto it = m_watchDirs.find(ev->wd);
+            if (it == m_watchDirs.end()) continue;
+
+            // The profile directory itself went away, forget all about it
+            if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                m_entries.erase(it->second + "/" + SERVICE_FILE);
+                m_watchedDirs.erase(it->second);
+                m_watchDirs.erase(it);
+                continue;
+            }
+
+            if (ev->len > 0 && strcmp(ev->name, SERVICE_FILE) == 0) {
+                auto entry = m_entries.find(it->second + "/" + SERVICE_FILE);
+                if (entry != m_entries.end()) {
+                    entry->second.valid = false;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <ctime>
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+#include <sys/types.h>
+
+// Cache of the stream URL stored in each OBS profile's service.json.
+//
+// Entries are keyed by file path and remember the file's inode, mtime and
+// size. The profile directories are watched with inotify, so a lookup only
+// goes back to the file after OBS actually rewrote it; without inotify
+// every lookup falls back to one stat() call.
+class ProfileUrlCache {
+public:
+    // Reads the URL out of a service.json file, empty if there is none
+    using Loader = std::function<std::string(const std::string& path)>;
+
+    explicit ProfileUrlCache(Loader loader);
+    ~ProfileUrlCache();
+
+    ProfileUrlCache(const ProfileUrlCache&) = delete;
+    ProfileUrlCache& operator=(const ProfileUrlCache&) = delete;
+
+    // URL from profileDir/service.json, empty if the file or URL is missing
+    std::string lookup(const std::string& profileDir);
+
+private:
+    struct Entry {
+        std::string url;
+        ino_t inode = 0;
+        time_t mtimeSec = 0;
+        long mtimeNsec = 0;
+        off_t size = -1;
+        bool valid = false;   // cleared by inotify when the file changes
+    };
+
+    void drainEvents();
+    void watchDir(const std::string& dir);
+
+    Loader m_loader;
+    std::unordered_map<std::string, Entry> m_entries;     // by service.json path
+    std::unordered_map<int, std::string> m_watchDirs;     // inotify wd -> profile dir
+    std::unordered_map<std::string, int> m_watchedDirs;   // profile dir -> wd
+    int m_inotifyFd;
+};
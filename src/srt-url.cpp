@@ -0,0 +1,288 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * SRT URL parsing and formatting
+ *
+ * Reads and writes srt:// URLs with the full set of SRT options. Both
+ * directions work on caller-provided buffers and never allocate.
+ *
+ * License: GPL-3.0
+ */
+
+#include "srt-url.h"
+
+#include <charconv>
+#include <climits>
+
+static constexpr std::string_view SRT_SCHEME = "srt://";
+
+static char lowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+}
+
+static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (lowerAscii(a[i]) != lowerAscii(b[i])) return false;
+    }
+    return true;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = lowerAscii(c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Only what would end a query value or break decoding, plus anything not
+// printable ASCII. Receivers match streamids such as "#!::r=live,m=publish"
+// literally, so the rest of the value is written as it is.
+static bool needsEncoding(unsigned char c) {
+    return c <= ' ' || c >= 0x7f || c == '%' || c == '&';
+}
+
+// Decode value into dst, a malformed escape is kept as it is
+static std::string_view percentDecode(std::string_view value, char* dst) {
+    size_t len = 0;
+    for (size_t i = 0; i < value.size(); i++) {
+        int hi, lo;
+        if (value[i] == '%' && i + 2 < value.size() &&
+            (hi = hexValue(value[i + 1])) >= 0 && (lo = hexValue(value[i + 2])) >= 0) {
+            dst[len++] = char(hi << 4 | lo);
+            i += 2;
+        } else {
+            dst[len++] = value[i];
+        }
+    }
+    return std::string_view(dst, len);
+}
+
+// Whole value as a decimal integer within [min, max]
+static bool parseInteger(std::string_view value, int64_t min, int64_t max, int64_t& result) {
+    int64_t parsed;
+    auto res = std::from_chars(value.data(), value.data() + value.size(), parsed);
+    if (res.ec != std::errc() || res.ptr != value.data() + value.size() || parsed < min || parsed > max) {
+        return false;
+    }
+    result = parsed;
+    return true;
+}
+
+static void setInt(std::optional<int>& field, std::string_view value, int64_t min, int64_t max) {
+    int64_t parsed;
+    if (parseInteger(value, min, max, parsed)) {
+        field = int(parsed);
+    }
+}
+
+static void parseOption(std::string_view name, std::string_view value, SrtUrl& out, char*& scratch) {
+    int64_t parsed;
+    if (equalsIgnoreCase(name, "streamid")) {
+        out.streamId = percentDecode(value, scratch);
+        scratch += out.streamId.size();
+    } else if (equalsIgnoreCase(name, "passphrase")) {
+        out.passphrase = percentDecode(value, scratch);
+        scratch += out.passphrase.size();
+    } else if (equalsIgnoreCase(name, "latency") || equalsIgnoreCase(name, "delay")) {
+        setInt(out.latency, value, 0, INT_MAX);
+    } else if (equalsIgnoreCase(name, "pbkeylen")) {
+        if (parseInteger(value, 0, 32, parsed) && (parsed == 0 || parsed == 16 || parsed == 24 || parsed == 32)) {
+            out.pbkeylen = int(parsed);
+        }
+    } else if (equalsIgnoreCase(name, "maxbw")) {
+        if (parseInteger(value, -1, INT64_MAX, parsed)) {
+            out.maxbw = parsed;
+        }
+    } else if (equalsIgnoreCase(name, "oheadbw")) {
+        setInt(out.oheadbw, value, 5, 100);
+    } else if (equalsIgnoreCase(name, "rcvbuf")) {
+        setInt(out.rcvbuf, value, 1, INT_MAX);
+    } else if (equalsIgnoreCase(name, "sndbuf")) {
+        setInt(out.sndbuf, value, 1, INT_MAX);
+    } else if (equalsIgnoreCase(name, "tlpktdrop")) {
+        if (value == "1" || equalsIgnoreCase(value, "true") || equalsIgnoreCase(value, "on")) {
+            out.tlpktdrop = true;
+        } else if (value == "0" || equalsIgnoreCase(value, "false") || equalsIgnoreCase(value, "off")) {
+            out.tlpktdrop = false;
+        }
+    } else if (equalsIgnoreCase(name, "mode")) {
+        // "client" and "server" are the FFmpeg spellings
+        if (equalsIgnoreCase(value, "caller") || equalsIgnoreCase(value, "client")) {
+            out.mode = SrtMode::Caller;
+        } else if (equalsIgnoreCase(value, "listener") || equalsIgnoreCase(value, "server")) {
+            out.mode = SrtMode::Listener;
+        } else if (equalsIgnoreCase(value, "rendezvous")) {
+            out.mode = SrtMode::Rendezvous;
+        }
+    }
+}
+
+bool parseSrtUrl(std::string_view url, SrtUrl& out, char* scratch, size_t scratchSize) {
+    if (url.size() < SRT_SCHEME.size() || !equalsIgnoreCase(url.substr(0, SRT_SCHEME.size()), SRT_SCHEME) ||
+        scratchSize < url.size()) {
+        return false;
+    }
+    out = SrtUrl();
+
+    std::string_view rest = url.substr(SRT_SCHEME.size());
+    size_t queryPos = rest.find('?');
+    std::string_view authority = rest.substr(0, queryPos);
+    std::string_view query = queryPos == std::string_view::npos ? std::string_view() : rest.substr(queryPos + 1);
+
+    // Host, an IPv6 literal is bracketed; a path after the authority is ignored
+    std::string_view portText;
+    if (!authority.empty() && authority[0] == '[') {
+        size_t close = authority.find(']');
+        if (close == std::string_view::npos) return false;
+        out.host = authority.substr(1, close - 1);
+        std::string_view after = authority.substr(close + 1);
+        if (!after.empty() && after[0] == ':') {
+            portText = after.substr(1);
+        } else if (!after.empty() && after[0] != '/') {
+            return false;
+        }
+    } else {
+        authority = authority.substr(0, authority.find('/'));
+        size_t colon = authority.find(':');
+        out.host = authority.substr(0, colon);
+        if (colon != std::string_view::npos) {
+            portText = authority.substr(colon + 1);
+        }
+    }
+    portText = portText.substr(0, portText.find('/'));
+
+    int64_t port;
+    if (parseInteger(portText, 1, 65535, port)) {
+        out.port = uint16_t(port);
+    }
+
+    while (!query.empty()) {
+        size_t amp = query.find('&');
+        std::string_view param = query.substr(0, amp);
+        query = amp == std::string_view::npos ? std::string_view() : query.substr(amp + 1);
+
+        size_t eq = param.find('=');
+        if (eq == std::string_view::npos) continue;
+        parseOption(param.substr(0, eq), param.substr(eq + 1), out, scratch);
+    }
+    return true;
+}
+
+namespace {
+
+// snprintf-style output: counts everything, stores what fits
+struct UrlWriter {
+    char* out;
+    size_t size;
+    size_t len = 0;
+    bool hasQuery = false;
+
+    void put(char c) {
+        if (len + 1 < size) out[len] = c;
+        len++;
+    }
+
+    void put(std::string_view s) {
+        for (char c : s) put(c);
+    }
+
+    void putInteger(int64_t value) {
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), value);
+        put(std::string_view(buf, size_t(res.ptr - buf)));
+    }
+
+    void putEncoded(std::string_view s) {
+        static const char hex[] = "0123456789ABCDEF";
+        for (char c : s) {
+            unsigned char u = (unsigned char)c;
+            if (needsEncoding(u)) {
+                put('%');
+                put(hex[u >> 4]);
+                put(hex[u & 0xf]);
+            } else {
+                put(c);
+            }
+        }
+    }
+
+    void option(const char* name) {
+        put(hasQuery ? '&' : '?');
+        put(name);
+        put('=');
+        hasQuery = true;
+    }
+
+    void finish() {
+        if (size > 0) out[len < size ? len : size - 1] = '\0';
+    }
+};
+
+} // namespace
+
+size_t formatSrtUrl(const SrtUrl& url, char* out, size_t outSize) {
+    UrlWriter w{out, outSize};
+    w.put(SRT_SCHEME);
+
+    // Brackets whenever the host would otherwise end early or look like a port
+    bool bracket = url.host.find_first_of(":/") != std::string_view::npos ||
+                   (!url.host.empty() && url.host[0] == '[');
+    if (bracket) w.put('[');
+    w.put(url.host);
+    if (bracket) w.put(']');
+    if (url.port > 0) {
+        w.put(':');
+        w.putInteger(url.port);
+    }
+
+    if (!url.streamId.empty()) {
+        w.option("streamid");
+        w.putEncoded(url.streamId);
+    }
+    if (url.latency) {
+        w.option("latency");
+        w.putInteger(*url.latency);
+    }
+    if (!url.passphrase.empty()) {
+        w.option("passphrase");
+        w.putEncoded(url.passphrase);
+    }
+    if (url.pbkeylen) {
+        w.option("pbkeylen");
+        w.putInteger(*url.pbkeylen);
+    }
+    if (url.maxbw) {
+        w.option("maxbw");
+        w.putInteger(*url.maxbw);
+    }
+    if (url.oheadbw) {
+        w.option("oheadbw");
+        w.putInteger(*url.oheadbw);
+    }
+    if (url.rcvbuf) {
+        w.option("rcvbuf");
+        w.putInteger(*url.rcvbuf);
+    }
+    if (url.sndbuf) {
+        w.option("sndbuf");
+        w.putInteger(*url.sndbuf);
+    }
+    if (url.tlpktdrop) {
+        w.option("tlpktdrop");
+        w.put(*url.tlpktdrop ? '1' : '0');
+    }
+    if (url.mode) {
+        w.option("mode");
+        w.put(*url.mode == SrtMode::Caller ? "caller" : *url.mode == SrtMode::Listener ? "listener" : "rendezvous");
+    }
+
+    w.finish();
+    return w.len;
+}
+
+bool operator==(const SrtUrl& a, const SrtUrl& b) {
+    return a.host == b.host && a.port == b.port && a.streamId == b.streamId &&
+           a.passphrase == b.passphrase && a.latency == b.latency && a.pbkeylen == b.pbkeylen &&
+           a.maxbw == b.maxbw && a.oheadbw == b.oheadbw && a.rcvbuf == b.rcvbuf &&
+           a.sndbuf == b.sndbuf && a.tlpktdrop == b.tlpktdrop && a.mode == b.mode;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// SRT connection mode, the "mode" URL option
+enum class SrtMode {
+    Caller,
+    Listener,
+    Rendezvous
+};
+
+// Contents of an srt://host:port?option=value&... URL.
+//
+// Strings are views: the host into the parsed URL, streamId and passphrase
+// into the caller's scratch buffer, where they are stored percent-decoded.
+// Options missing from the URL, or with a value out of range, are unset.
+struct SrtUrl {
+    std::string_view host;         // IPv6 literals without the brackets
+    uint16_t port = 0;             // 0 if missing or invalid
+    std::string_view streamId;
+    std::string_view passphrase;
+    std::optional<int> latency;    // milliseconds, as used throughout the plugin
+    std::optional<int> pbkeylen;   // 0, 16, 24 or 32
+    std::optional<int64_t> maxbw;  // bytes per second, -1 unlimited, 0 relative to input
+    std::optional<int> oheadbw;    // percent overhead, 5 to 100
+    std::optional<int> rcvbuf;     // bytes
+    std::optional<int> sndbuf;     // bytes
+    std::optional<bool> tlpktdrop;
+    std::optional<SrtMode> mode;
+};
+
+bool operator==(const SrtUrl& a, const SrtUrl& b);
+inline bool operator!=(const SrtUrl& a, const SrtUrl& b) { return !(a == b); }
+
+// Parse an SRT URL without allocating. scratch receives the decoded string
+// options and must hold at least url.size() bytes; it has to outlive out.
+// Option names are case-insensitive, "delay" is accepted for latency, and
+// unknown options are skipped. Returns false if url is not an srt:// URL
+// or cannot be parsed.
+bool parseSrtUrl(std::string_view url, SrtUrl& out, char* scratch, size_t scratchSize);
+
+// Format url into out, percent-encoding the string options, and always
+// NUL-terminate unless outSize is 0. Like snprintf, returns the full length
+// excluding the terminator, so a result >= outSize means it was truncated.
+// out may be null when outSize is 0.
+size_t formatSrtUrl(const SrtUrl& url, char* out, size_t outSize);
@@ -0,0 +1,29 @@
+#include "srtla-log.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+
+static std::mutex g_logMutex;
+static SrtlaLogHandler g_logHandler;
+
+void srtla_log_set_handler(SrtlaLogHandler handler) {
+    std::lock_guard<std::mutex> lock(g_logMutex);
+    g_logHandler = std::move(handler);
+}
+
+void srtla_log(int level, const char* format, ...) {
+    char message[1024];
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    std::lock_guard<std::mutex> lock(g_logMutex);
+    if (g_logHandler) {
+        g_logHandler(level, message);
+    } else {
+        fprintf(stderr, "[srtla] %s\n", message);
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <functional>
+
+// Log levels use the same values as OBS (LOG_ERROR, LOG_WARNING, ...)
+// so the plugin can forward messages to blog() unchanged.
+enum SrtlaLogLevel {
+    SRTLA_LOG_ERROR = 100,
+    SRTLA_LOG_WARNING = 200,
+    SRTLA_LOG_INFO = 300,
+    SRTLA_LOG_DEBUG = 400
+};
+
+// Receives every formatted log line from the OBS-independent modules
+using SrtlaLogHandler = std::function<void(int level, const char* message)>;
+
+// Install the log handler; without one, messages go to stderr
+void srtla_log_set_handler(SrtlaLogHandler handler);
+
+// printf-style logging used by the bonding engine and helpers
+void srtla_log(int level, const char* format, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
@@ -0,0 +1,86 @@
+#pragma once
+
+// SRTLA wire protocol constants and helpers, compatible with BELABOX srtla
+
+#include <cstddef>
+#include <cstdint>
+
+// SRTLA control packet types (first 16 bits, big endian)
+#define SRTLA_TYPE_KEEPALIVE 0x9000
+#define SRTLA_TYPE_ACK       0x9100
+#define SRTLA_TYPE_REG1      0x9200
+#define SRTLA_TYPE_REG2      0x9201
+#define SRTLA_TYPE_REG3      0x9202
+#define SRTLA_TYPE_REG_ERR   0x9210
+#define SRTLA_TYPE_REG_NGP   0x9211
+#define SRTLA_TYPE_REG_NAK   0x9212
+
+// SRT control packet types we need to look at
+#define SRT_TYPE_HANDSHAKE 0x8000
+#define SRT_TYPE_ACK       0x8002
+#define SRT_TYPE_NAK       0x8003
+#define SRT_TYPE_SHUTDOWN  0x8005
+
+#define SRTLA_ID_LEN        256
+#define SRTLA_TYPE_REG1_LEN (2 + SRTLA_ID_LEN)
+#define SRTLA_TYPE_REG2_LEN (2 + SRTLA_ID_LEN)
+#define SRTLA_TYPE_REG3_LEN 2
+#define SRTLA_ACK_HDR_LEN   4
+#define SRTLA_KEEPALIVE_LEN 6   // type and a 32-bit microsecond send time, echoed back for RTT
+#define SRT_MIN_LEN         16
+#define SRTLA_MTU           1500
+
+// Congestion window (scaled by SRTLA_WINDOW_MULT), same tuning as srtla_send
+#define SRTLA_WINDOW_MIN  1
+#define SRTLA_WINDOW_DEF  20
+#define SRTLA_WINDOW_MAX  60
+#define SRTLA_WINDOW_MULT 1000
+#define SRTLA_WINDOW_DECR 100
+#define SRTLA_WINDOW_INCR 30
+
+// Timing, in milliseconds
+#define SRTLA_CONN_TIMEOUT_MS  4000
+#define SRTLA_REG_TIMEOUT_MS   4000
+#define SRTLA_IDLE_TIME_MS     1000
+#define SRTLA_HOUSEKEEPING_MS  1000
+#define SRTLA_PROBE_INTERVAL_MS 100    // keepalive probes of links not yet admitted
+#define SRTLA_DEMOTE_AFTER_MS  3000    // how long an admitted link may stay degraded
+#define SRTLA_HANDOVER_SETTLE_MS  2000  // warm restart: wait this long for every link to register
+#define SRTLA_HANDOVER_TIMEOUT_MS 5000  // warm restart: take over even with no link registered
+#define SRTLA_STATS_INTERVAL_MS 250
+
+// Per-packet smoothing factor (1/N) of the link loss estimate
+#define SRTLA_LOSS_SMOOTHING   32.0
+
+inline uint16_t srtla_read_be16(const uint8_t* buf) {
+    return (uint16_t)((buf[0] << 8) | buf[1]);
+}
+
+inline uint32_t srtla_read_be32(const uint8_t* buf) {
+    return ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) |
+           ((uint32_t)buf[2] << 8) | (uint32_t)buf[3];
+}
+
+inline void srtla_write_be16(uint8_t* buf, uint16_t value) {
+    buf[0] = (uint8_t)(value >> 8);
+    buf[1] = (uint8_t)value;
+}
+
+inline void srtla_write_be32(uint8_t* buf, uint32_t value) {
+    buf[0] = (uint8_t)(value >> 24);
+    buf[1] = (uint8_t)(value >> 16);
+    buf[2] = (uint8_t)(value >> 8);
+    buf[3] = (uint8_t)value;
+}
+
+// Packet type: SRTLA/SRT control packets have the top bit set
+inline uint16_t srtla_packet_type(const uint8_t* buf, size_t len) {
+    if (len < 2) return 0;
+    return srtla_read_be16(buf);
+}
+
+// SRT data packets carry the sequence number in the first 32 bits (top bit clear)
+inline int32_t srt_data_seq(const uint8_t* buf, size_t len) {
+    if (len < SRT_MIN_LEN || (buf[0] & 0x80)) return -1;
+    return (int32_t)srtla_read_be32(buf);
+}
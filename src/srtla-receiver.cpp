@@ -0,0 +1,580 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Local SRTLA receiver stand-in
+ *
+ * The receiver half of SRTLA, compatible with BELABOX srtla_rec, for
+ * running the bonding engine end to end on loopback in tests, benchmarks
+ * and local debugging.
+ *
+ * License: GPL-3.0
+ */
+
+#include "srtla-receiver.h"
+#include "srtla-log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+static constexpr int MAX_EPOLL_EVENTS = 16;
+static constexpr int SOCKET_BUFFER_SIZE = 4 * 1024 * 1024;
+
+// SRT sequence numbers are 31 bits and wrap
+static constexpr int32_t SEQ_MASK = 0x7fffffff;
+
+static int32_t seqDiff(int32_t a, int32_t b) {
+    int32_t d = (a - b) & SEQ_MASK;
+    return d >= 0x40000000 ? d - 0x80000000 : d;
+}
+
+static int32_t seqNext(int32_t seq) {
+    return (seq + 1) & SEQ_MASK;
+}
+
+static bool sameAddr(const sockaddr_in6& a, const sockaddr_in6& b) {
+    return memcmp(&a.sin6_addr, &b.sin6_addr, sizeof(a.sin6_addr)) == 0 && a.sin6_port == b.sin6_port;
+}
+
+// IPv4 peers of the dual-stack socket show up as ::ffff:a.b.c.d
+static std::string formatAddr(const sockaddr_in6& addr) {
+    char ip[INET6_ADDRSTRLEN];
+    if (IN6_IS_ADDR_V4MAPPED(&addr.sin6_addr)) {
+        inet_ntop(AF_INET, &addr.sin6_addr.s6_addr[12], ip, sizeof(ip));
+        return std::string(ip) + ":" + std::to_string(ntohs(addr.sin6_port));
+    }
+    inet_ntop(AF_INET6, &addr.sin6_addr, ip, sizeof(ip));
+    return "[" + std::string(ip) + "]:" + std::to_string(ntohs(addr.sin6_port));
+}
+
+SrtlaReceiver::SrtlaReceiver()
+    : m_fd(-1),
+      m_wakeFd(-1),
+      m_epollFd(-1),
+      m_port(0),
+      m_reassemblyPackets(0),
+      m_reassemblyHoldMs(0),
+      m_reorderDepthSum(0),
+      m_running(false),
+      m_stopRequested(false) {
+    memset(&m_sinkAddr, 0, sizeof(m_sinkAddr));
+}
+
+SrtlaReceiver::~SrtlaReceiver() {
+    stop();
+}
+
+void SrtlaReceiver::setReassembly(size_t packets, int holdMs) {
+    if (m_running) return;
+    size_t size = 0;
+    if (packets > 0) {
+        size = 1;
+        while (size < packets) size <<= 1;
+    }
+    m_reassemblyPackets = size;
+    m_reassemblyHoldMs = std::max(holdMs, 1);
+}
+
+bool SrtlaReceiver::start(const std::string& bindIp, uint16_t port, const std::string& sinkIp, uint16_t sinkPort) {
+    if (m_running) {
+        srtla_log(SRTLA_LOG_WARNING, "SRTLA receiver already running");
+        return false;
+    }
+
+    // One dual-stack socket; an IPv4 bind address becomes its mapped form
+    sockaddr_in6 bindAddr;
+    memset(&bindAddr, 0, sizeof(bindAddr));
+    bindAddr.sin6_family = AF_INET6;
+    bindAddr.sin6_port = htons(port);
+    in_addr bindV4;
+    bool validBind = inet_pton(AF_INET6, bindIp.c_str(), &bindAddr.sin6_addr) == 1;
+    if (!validBind && inet_pton(AF_INET, bindIp.c_str(), &bindV4) == 1) {
+        bindAddr.sin6_addr.s6_addr[10] = 0xff;
+        bindAddr.sin6_addr.s6_addr[11] = 0xff;
+        memcpy(&bindAddr.sin6_addr.s6_addr[12], &bindV4, sizeof(bindV4));
+        validBind = true;
+    }
+    m_sinkAddr.sin_family = AF_INET;
+    m_sinkAddr.sin_port = htons(sinkPort);
+    if (!validBind || inet_pton(AF_INET, sinkIp.c_str(), &m_sinkAddr.sin_addr) != 1) {
+        srtla_log(SRTLA_LOG_ERROR, "Invalid SRTLA receiver address %s or sink %s", bindIp.c_str(), sinkIp.c_str());
+        return false;
+    }
+
+    m_fd = socket(AF_INET6, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_fd < 0) {
+        srtla_log(SRTLA_LOG_ERROR, "Failed to create SRTLA receiver socket: %s", strerror(errno));
+        return false;
+    }
+    int bufSize = SOCKET_BUFFER_SIZE;
+    setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize));
+    setsockopt(m_fd, SOL_SOCKET, SO_SNDBUF, &bufSize, sizeof(bufSize));
+    int v6Only = 0;
+    setsockopt(m_fd, IPPROTO_IPV6, IPV6_V6ONLY, &v6Only, sizeof(v6Only));
+
+    if (bind(m_fd, (sockaddr*)&bindAddr, sizeof(bindAddr)) < 0) {
+        srtla_log(SRTLA_LOG_ERROR, "Failed to bind SRTLA receiver to %s:%d: %s", bindIp.c_str(), port, strerror(errno));
+        stop();
+        return false;
+    }
+    socklen_t addrLen = sizeof(bindAddr);
+    getsockname(m_fd, (sockaddr*)&bindAddr, &addrLen);
+    m_port = ntohs(bindAddr.sin6_port);
+
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_wakeFd < 0 || m_epollFd < 0) {
+        srtla_log(SRTLA_LOG_ERROR, "Failed to create receiver event descriptors: %s", strerror(errno));
+        stop();
+        return false;
+    }
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = &m_fd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_fd, &ev);
+    ev.data.ptr = &m_wakeFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &ev);
+
+    m_stats = ReceiverStats();
+    m_reorderDepthSum = 0;
+    publishStats();
+
+    m_stopRequested = false;
+    m_running = true;
+    m_thread = std::thread(&SrtlaReceiver::run, this);
+
+    srtla_log(SRTLA_LOG_INFO, "SRTLA receiver listening on %s:%d, forwarding to %s:%d",
+              bindIp.c_str(), m_port, sinkIp.c_str(), sinkPort);
+    return true;
+}
+
+void SrtlaReceiver::stop() {
+    if (m_thread.joinable()) {
+        m_stopRequested = true;
+        uint64_t one = 1;
+        ssize_t ret = write(m_wakeFd, &one, sizeof(one));
+        (void)ret;
+        m_thread.join();
+    }
+
+    while (!m_groups.empty()) {
+        removeGroup(*m_groups.back());
+    }
+    if (m_running) {
+        publishStats();
+    }
+
+    if (m_epollFd >= 0) close(m_epollFd);
+    if (m_wakeFd >= 0) close(m_wakeFd);
+    if (m_fd >= 0) close(m_fd);
+    m_epollFd = -1;
+    m_wakeFd = -1;
+    m_fd = -1;
+
+    if (m_running) {
+        srtla_log(SRTLA_LOG_INFO, "SRTLA receiver on port %d stopped", m_port);
+    }
+    m_running = false;
+}
+
+ReceiverStats SrtlaReceiver::stats() {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_published;
+}
+
+void SrtlaReceiver::run() {
+    epoll_event events[MAX_EPOLL_EVENTS];
+    Clock::time_point nextHousekeeping = Clock::now();
+
+    while (!m_stopRequested) {
+        Clock::time_point now = Clock::now();
+        if (now >= nextHousekeeping) {
+            housekeeping(now);
+            nextHousekeeping = now + std::chrono::milliseconds(SRTLA_HOUSEKEEPING_MS);
+        }
+
+        // Wake up in time to give up on gaps that hold packets back
+        int timeout = (int)std::chrono::duration_cast<std::chrono::milliseconds>(nextHousekeeping - now).count();
+        for (auto& group : m_groups) {
+            if (group->buffered > 0) {
+                timeout = std::min(timeout, m_reassemblyHoldMs);
+            }
+        }
+
+        int count = epoll_wait(m_epollFd, events, MAX_EPOLL_EVENTS, std::max(timeout, 0));
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            srtla_log(SRTLA_LOG_ERROR, "SRTLA receiver epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < count; i++) {
+            void* tag = events[i].data.ptr;
+            if (tag == &m_wakeFd) {
+                uint64_t value;
+                ssize_t ret = read(m_wakeFd, &value, sizeof(value));
+                (void)ret;
+            } else if (tag == &m_fd) {
+                readSocket();
+            } else {
+                readSink(*static_cast<Group*>(tag));
+            }
+        }
+
+        now = Clock::now();
+        for (auto& group : m_groups) {
+            if (group->buffered > 0) {
+                releaseInOrder(*group, now);
+            }
+        }
+        publishStats();
+    }
+}
+
+void SrtlaReceiver::readSocket() {
+    uint8_t buf[SRTLA_MTU];
+    while (true) {
+        sockaddr_in6 from;
+        socklen_t fromLen = sizeof(from);
+        ssize_t n = recvfrom(m_fd, buf, sizeof(buf), 0, (sockaddr*)&from, &fromLen);
+        if (n <= 0) break;
+        if (fromLen != sizeof(from) || from.sin6_family != AF_INET6) continue;
+        handlePacket(buf, (size_t)n, from, Clock::now());
+    }
+
+    // Partial ACK batches go out once the socket is drained, so a light
+    // stream is acknowledged promptly and a heavy one in full batches
+    flushAcks();
+}
+
+void SrtlaReceiver::readSink(Group& group) {
+    uint8_t buf[SRTLA_MTU];
+    while (true) {
+        ssize_t n = recv(group.sinkFd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+
+        // SRT ACKs go out on every link so each one can measure its RTT,
+        // everything else on the link the group last heard from
+        if (srtla_packet_type(buf, (size_t)n) == SRT_TYPE_ACK) {
+            for (auto& link : group.links) {
+                sendTo(link->addr, buf, (size_t)n);
+            }
+        } else if (group.lastActive) {
+            sendTo(group.lastActive->addr, buf, (size_t)n);
+        }
+    }
+}
+
+void SrtlaReceiver::handlePacket(const uint8_t* buf, size_t len, const sockaddr_in6& from, Clock::time_point now) {
+    uint16_t type = srtla_packet_type(buf, len);
+    if (type == SRTLA_TYPE_REG1) {
+        handleReg1(buf, len, from, now);
+        return;
+    }
+    if (type == SRTLA_TYPE_REG2) {
+        handleReg2(buf, len, from, now);
+        return;
+    }
+
+    // Everything else is only accepted from registered links
+    Link* link = findLink(from);
+    if (!link) return;
+    link->lastReceived = now;
+    link->group->lastReceived = now;
+
+    if (type == SRTLA_TYPE_KEEPALIVE) {
+        sendTo(from, buf, len);
+        return;
+    }
+    if ((type & 0xff00) >= 0x9000) {
+        return;  // other SRTLA control packets mean nothing to a receiver
+    }
+    handleData(*link, buf, len, now);
+}
+
+void SrtlaReceiver::handleReg1(const uint8_t* buf, size_t len, const sockaddr_in6& from, Clock::time_point now) {
+    if (len != SRTLA_TYPE_REG1_LEN) return;
+    if (findLink(from) || m_groups.size() >= MAX_GROUPS) {
+        sendCode(from, SRTLA_TYPE_REG_ERR);
+        return;
+    }
+
+    auto group = std::make_unique<Group>();
+    memcpy(group->id, buf + 2, SRTLA_ID_LEN / 2);
+    std::random_device rd;
+    std::independent_bits_engine<std::mt19937, 8, uint16_t> bytes(rd());
+    for (size_t i = SRTLA_ID_LEN / 2; i < SRTLA_ID_LEN; i++) {
+        group->id[i] = (uint8_t)bytes();
+    }
+    std::fill(std::begin(group->recentSeqs), std::end(group->recentSeqs), -1);
+    group->slots.resize(m_reassemblyPackets);
+    group->created = now;
+    group->lastReceived = now;
+
+    // The group's own connection to the SRT sink
+    group->sinkFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (group->sinkFd < 0 || connect(group->sinkFd, (sockaddr*)&m_sinkAddr, sizeof(m_sinkAddr)) < 0) {
+        srtla_log(SRTLA_LOG_ERROR, "Failed to open SRT sink socket: %s", strerror(errno));
+        if (group->sinkFd >= 0) close(group->sinkFd);
+        sendCode(from, SRTLA_TYPE_REG_ERR);
+        return;
+    }
+    int bufSize = SOCKET_BUFFER_SIZE;
+    setsockopt(group->sinkFd, SOL_SOCKET, SO_SNDBUF, &bufSize, sizeof(bufSize));
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = group.get();
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, group->sinkFd, &ev);
+
+    uint8_t reply[SRTLA_TYPE_REG2_LEN];
+    srtla_write_be16(reply, SRTLA_TYPE_REG2);
+    memcpy(reply + 2, group->id, SRTLA_ID_LEN);
+    sendTo(from, reply, sizeof(reply));
+
+    m_groups.push_back(std::move(group));
+    srtla_log(SRTLA_LOG_INFO, "SRTLA receiver created group %zu", m_groups.size());
+}
+
+void SrtlaReceiver::handleReg2(const uint8_t* buf, size_t len, const sockaddr_in6& from, Clock::time_point now) {
+    if (len != SRTLA_TYPE_REG2_LEN) return;
+
+    Group* group = nullptr;
+    for (auto& g : m_groups) {
+        if (memcmp(g->id, buf + 2, SRTLA_ID_LEN) == 0) {
+            group = g.get();
+            break;
+        }
+    }
+    if (!group) {
+        sendCode(from, SRTLA_TYPE_REG_NGP);
+        return;
+    }
+
+    Link* existing = findLink(from);
+    if (existing && existing->group != group) {
+        sendCode(from, SRTLA_TYPE_REG_ERR);
+        return;
+    }
+    if (!existing) {
+        if (group->links.size() >= MAX_LINKS_PER_GROUP) {
+            sendCode(from, SRTLA_TYPE_REG_ERR);
+            return;
+        }
+        auto link = std::make_unique<Link>();
+        link->addr = from;
+        link->group = group;
+        link->lastReceived = now;
+        group->links.push_back(std::move(link));
+
+        srtla_log(SRTLA_LOG_INFO, "SRTLA receiver registered link %s", formatAddr(from).c_str());
+    }
+    group->lastReceived = now;
+    sendCode(from, SRTLA_TYPE_REG3);
+}
+
+void SrtlaReceiver::handleData(Link& link, const uint8_t* buf, size_t len, Clock::time_point now) {
+    Group& group = *link.group;
+    group.lastActive = &link;
+
+    int32_t seq = srt_data_seq(buf, len);
+    if (seq < 0) {
+        // SRT control traffic (handshake, ACKACK, ...) is passed straight on
+        send(group.sinkFd, buf, len, 0);
+        return;
+    }
+
+    link.packets++;
+    link.acks[link.ackCount++] = (uint32_t)seq;
+    if (link.ackCount == ACK_BATCH) {
+        sendAcks(link);
+    }
+
+    m_stats.packets++;
+    m_stats.bytes += len;
+
+    int32_t& recent = group.recentSeqs[seq & 8191];
+    if (recent == seq) {
+        m_stats.duplicates++;
+        return;
+    }
+    recent = seq;
+    trackArrival(group, seq);
+
+    if (group.slots.empty()) {
+        send(group.sinkFd, buf, len, 0);
+    } else {
+        reassemble(group, seq, buf, len, now);
+    }
+}
+
+void SrtlaReceiver::trackArrival(Group& group, int32_t seq) {
+    if (!group.haveHighest) {
+        group.haveHighest = true;
+        group.highestSeq = seq;
+        return;
+    }
+    int32_t behind = seqDiff(group.highestSeq, seq);
+    if (behind < 0) {
+        group.highestSeq = seq;
+    } else if (behind > 0) {
+        m_stats.reordered++;
+        m_reorderDepthSum += (uint64_t)behind;
+        m_stats.maxReorderDepth = std::max(m_stats.maxReorderDepth, (int)behind);
+        m_stats.meanReorderDepth = (double)m_reorderDepthSum / m_stats.reordered;
+    }
+}
+
+void SrtlaReceiver::reassemble(Group& group, int32_t seq, const uint8_t* buf, size_t len, Clock::time_point now) {
+    size_t mask = group.slots.size() - 1;
+    if (!group.haveNext) {
+        group.haveNext = true;
+        group.nextSeq = seq;
+    }
+
+    // Already given up on: late, but SRT may still use it
+    if (seqDiff(seq, group.nextSeq) < 0) {
+        m_stats.late++;
+        send(group.sinkFd, buf, len, 0);
+        return;
+    }
+
+    // Too far ahead for the window: release or skip the oldest positions
+    while (seqDiff(seq, group.nextSeq) >= (int32_t)group.slots.size()) {
+        Slot& slot = group.slots[group.nextSeq & mask];
+        if (slot.seq == group.nextSeq) {
+            send(group.sinkFd, slot.data, slot.len, 0);
+            slot.seq = -1;
+            group.buffered--;
+        }
+        group.nextSeq = seqNext(group.nextSeq);
+        group.blockedSince = Clock::time_point();
+    }
+
+    Slot& slot = group.slots[seq & mask];
+    slot.seq = seq;
+    slot.len = len;
+    memcpy(slot.data, buf, len);
+    group.buffered++;
+    releaseInOrder(group, now);
+}
+
+void SrtlaReceiver::releaseInOrder(Group& group, Clock::time_point now) {
+    size_t mask = group.slots.size() - 1;
+    while (group.buffered > 0) {
+        Slot& slot = group.slots[group.nextSeq & mask];
+        if (slot.seq == group.nextSeq) {
+            send(group.sinkFd, slot.data, slot.len, 0);
+            slot.seq = -1;
+            group.buffered--;
+            group.nextSeq = seqNext(group.nextSeq);
+            group.blockedSince = Clock::time_point();
+            continue;
+        }
+
+        // A gap: wait up to the hold time for it, then skip it
+        if (group.blockedSince == Clock::time_point()) {
+            group.blockedSince = now;
+            break;
+        }
+        if (now - group.blockedSince < std::chrono::milliseconds(m_reassemblyHoldMs)) {
+            break;
+        }
+        group.nextSeq = seqNext(group.nextSeq);
+    }
+}
+
+void SrtlaReceiver::sendAcks(Link& link) {
+    uint8_t pkt[SRTLA_ACK_HDR_LEN + ACK_BATCH * 4];
+    srtla_write_be32(pkt, (uint32_t)SRTLA_TYPE_ACK << 16);
+    for (size_t i = 0; i < link.ackCount; i++) {
+        srtla_write_be32(pkt + SRTLA_ACK_HDR_LEN + i * 4, link.acks[i]);
+    }
+    sendTo(link.addr, pkt, SRTLA_ACK_HDR_LEN + link.ackCount * 4);
+    link.ackCount = 0;
+}
+
+void SrtlaReceiver::flushAcks() {
+    for (auto& group : m_groups) {
+        for (auto& link : group->links) {
+            if (link->ackCount > 0) {
+                sendAcks(*link);
+            }
+        }
+    }
+}
+
+void SrtlaReceiver::housekeeping(Clock::time_point now) {
+    auto timeout = std::chrono::milliseconds(SRTLA_CONN_TIMEOUT_MS);
+    for (size_t g = 0; g < m_groups.size();) {
+        Group& group = *m_groups[g];
+        auto& links = group.links;
+        for (size_t i = 0; i < links.size();) {
+            if (now - links[i]->lastReceived > timeout) {
+                srtla_log(SRTLA_LOG_INFO, "SRTLA receiver dropped idle link");
+                if (group.lastActive == links[i].get()) group.lastActive = nullptr;
+                links.erase(links.begin() + i);
+            } else {
+                i++;
+            }
+        }
+
+        if (links.empty() && now - group.lastReceived > timeout) {
+            srtla_log(SRTLA_LOG_INFO, "SRTLA receiver dropped idle group");
+            removeGroup(group);
+        } else {
+            g++;
+        }
+    }
+}
+
+void SrtlaReceiver::removeGroup(Group& group) {
+    if (group.sinkFd >= 0) {
+        if (m_epollFd >= 0) {
+            epoll_ctl(m_epollFd, EPOLL_CTL_DEL, group.sinkFd, nullptr);
+        }
+        close(group.sinkFd);
+    }
+    m_groups.erase(std::find_if(m_groups.begin(), m_groups.end(),
+                                [&group](const std::unique_ptr<Group>& g) { return g.get() == &group; }));
+}
+
+void SrtlaReceiver::publishStats() {
+    m_stats.groups = m_groups.size();
+    m_stats.linkPackets.clear();
+    for (auto& group : m_groups) {
+        for (auto& link : group->links) {
+            m_stats.linkPackets.push_back(link->packets);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_published = m_stats;
+}
+
+SrtlaReceiver::Link* SrtlaReceiver::findLink(const sockaddr_in6& addr) {
+    for (auto& group : m_groups) {
+        for (auto& link : group->links) {
+            if (sameAddr(link->addr, addr)) return link.get();
+        }
+    }
+    return nullptr;
+}
+
+void SrtlaReceiver::sendTo(const sockaddr_in6& addr, const uint8_t* buf, size_t len) {
+    sendto(m_fd, buf, len, 0, (const sockaddr*)&addr, sizeof(addr));
+}
+
+void SrtlaReceiver::sendCode(const sockaddr_in6& addr, uint16_t type) {
+    uint8_t pkt[2];
+    srtla_write_be16(pkt, type);
+    sendTo(addr, pkt, sizeof(pkt));
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+
+#include "srtla-protocol.h"
+
+// Statistics of a running receiver
+struct ReceiverStats {
+    uint64_t packets = 0;        // SRT data packets accepted from the links
+    uint64_t bytes = 0;
+    uint64_t duplicates = 0;     // same sequence number received again
+    uint64_t reordered = 0;      // arrived after a higher sequence number
+    uint64_t late = 0;           // arrived after reassembly had given up on it
+    int maxReorderDepth = 0;     // furthest a packet arrived behind the highest sequence
+    double meanReorderDepth = 0.0;  // over the reordered packets
+    size_t groups = 0;
+    std::vector<uint64_t> linkPackets;  // data packets per registered link
+};
+
+// Local SRTLA receiver, a stand-in for the relay server so the sender can
+// be exercised end to end on one machine without network access.
+//
+// Speaks the receiver side of the protocol like BELABOX srtla_rec: group
+// and link registration, keepalive echo and batched SRTLA ACKs. The bonded
+// SRT stream of each group is passed on to a local SRT sink over its own
+// UDP socket, and traffic from the sink goes back over the group's links.
+// With a reassembly window, data reaches the sink in sequence order.
+class SrtlaReceiver {
+public:
+    SrtlaReceiver();
+    ~SrtlaReceiver();
+
+    // Listen on bindIp:port (0 picks a free port) and forward to
+    // sinkIp:sinkPort. Returns false if the socket cannot be bound.
+    // bindIp "::" takes links over both IPv4 and IPv6.
+    bool start(const std::string& bindIp, uint16_t port, const std::string& sinkIp, uint16_t sinkPort);
+    void stop();
+
+    bool isRunning() const { return m_running; }
+
+    // Port actually bound, valid after start()
+    uint16_t port() const { return m_port; }
+
+    // Hold up to packets out-of-order packets, for at most holdMs, to hand
+    // the sink an ordered stream. 0 forwards in arrival order like srtla_rec.
+    // Must be set before start().
+    void setReassembly(size_t packets, int holdMs);
+
+    // Snapshot of the statistics, safe from any thread
+    ReceiverStats stats();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Data sequence numbers acknowledged per SRTLA ACK, as in srtla_rec
+    static constexpr size_t ACK_BATCH = 10;
+    static constexpr size_t MAX_GROUPS = 200;
+    static constexpr size_t MAX_LINKS_PER_GROUP = 16;
+
+    struct Group;
+
+    struct Link {
+        sockaddr_in6 addr;     // IPv4 links as mapped addresses
+        Group* group = nullptr;
+        Clock::time_point lastReceived;
+        uint64_t packets = 0;
+        uint32_t acks[ACK_BATCH];
+        size_t ackCount = 0;
+    };
+
+    struct Slot {
+        int32_t seq = -1;
+        size_t len = 0;
+        uint8_t data[SRTLA_MTU];
+    };
+
+    struct Group {
+        uint8_t id[SRTLA_ID_LEN];
+        int sinkFd = -1;
+        std::vector<std::unique_ptr<Link>> links;
+        Link* lastActive = nullptr;
+        Clock::time_point created;
+        Clock::time_point lastReceived;
+
+        // Arrival tracking
+        bool haveHighest = false;
+        int32_t highestSeq = 0;
+        int32_t recentSeqs[8192];  // duplicate detection, indexed by seq
+
+        // Reassembly ring, indexed by seq
+        std::vector<Slot> slots;
+        bool haveNext = false;
+        int32_t nextSeq = 0;
+        size_t buffered = 0;
+        Clock::time_point blockedSince;  // when a gap started holding packets back
+    };
+
+    void run();
+    void readSocket();
+    void readSink(Group& group);
+    void handlePacket(const uint8_t* buf, size_t len, const sockaddr_in6& from, Clock::time_point now);
+    void handleReg1(const uint8_t* buf, size_t len, const sockaddr_in6& from, Clock::time_point now);
+    void handleReg2(const uint8_t* buf, size_t len, const sockaddr_in6& from, Clock::time_point now);
+    void handleData(Link& link, const uint8_t* buf, size_t len, Clock::time_point now);
+    void trackArrival(Group& group, int32_t seq);
+    void reassemble(Group& group, int32_t seq, const uint8_t* buf, size_t len, Clock::time_point now);
+    void releaseInOrder(Group& group, Clock::time_point now);
+    void sendAcks(Link& link);
+    void flushAcks();
+    void housekeeping(Clock::time_point now);
+    void removeGroup(Group& group);
+    void publishStats();
+
+    Link* findLink(const sockaddr_in6& addr);
+    void sendTo(const sockaddr_in6& addr, const uint8_t* buf, size_t len);
+    void sendCode(const sockaddr_in6& addr, uint16_t type);
+
+    int m_fd;
+    int m_wakeFd;
+    int m_epollFd;
+    uint16_t m_port;
+    sockaddr_in m_sinkAddr;
+    size_t m_reassemblyPackets;
+    int m_reassemblyHoldMs;
+
+    std::vector<std::unique_ptr<Group>> m_groups;   // receiver thread only
+    ReceiverStats m_stats;                          // receiver thread only
+    uint64_t m_reorderDepthSum;
+
+    std::mutex m_statsMutex;
+    ReceiverStats m_published;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_stopRequested;
+};
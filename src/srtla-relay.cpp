@@ -10,17 +10,18 @@
  */
 
 #include "srtla-relay.h"
+#include "atomic-file.h"
+#include "srt-url.h"
 #include <obs-module.h>
 #include <obs-frontend-api.h>
 #include <random>
 #include <filesystem>
 #include <fstream>
-#include <thread>
 #include <chrono>
-#include <netdb.h>
 #include <arpa/inet.h>
 #include <cctype>
 #include <algorithm>
+#include <iterator>
 
 // Include Qt headers
 #include <QtWidgets/QMainWindow>
@@ -28,27 +29,53 @@
 #include <QtCore/QCoreApplication>
 #include <QtCore/QString>
 #include <QtCore/QMetaObject>
+#include <QtCore/QTimer>
 
 #include <signal.h>
 #include <unistd.h>
 #include <sys/stat.h>
-#define PROCESS_KILL(pid) kill(pid, SIGTERM)
 
 namespace fs = std::filesystem;
 
+// Quiet time after the last setting change before the settings file is written
+static constexpr int SETTINGS_FLUSH_DELAY_MS = 500;
+
+// Optional copy of srtla_send's output, moved to .1 at the size limit
+#define SENDER_LOG_PATH "/tmp/srtla.log"
+static constexpr size_t SENDER_LOG_MAX_BYTES = 4 * 1024 * 1024;
+
 // Forward declarations for callbacks
 static bool srtla_service_selected(obs_properties_t *props, obs_property_t *property, obs_data_t *settings);
 static bool apply_srtla_settings(obs_properties_t *props, obs_property_t *property, void *data);
+static std::string readServiceFileUrl(const std::string& path);
 
 SrtlaRelay::SrtlaRelay()
     : m_port(3000), 
       m_localPort(9000),  // Default to port 9000
       m_processRunning(false),
       m_processId(-1),
+      m_senderOutputDropped(0),
+      m_externalStatusPid(-1),
+      m_senderLogFile(false),
       m_autoStart(false),
       m_latency(2000),
       m_bidirectionalSync(true), // Default bidirectional sync on
-      m_useFixedPort(true) {  // Default to using fixed port
+      m_useFixedPort(true),  // Default to using fixed port
+      m_useNativeSender(true),  // Default to the built-in bonding engine
+      m_senderServerPort(0),
+      m_spreadServerAddresses(false),
+      m_linkGate(true),  // Default to probing links before they carry the stream
+      m_linkGateMaxRttMs(1000),
+      m_linkGateMaxLossPct(20),
+      m_adaptiveBitrate(false),
+      m_bitrateFloorKbps(500),
+      m_bitrateCeilingKbps(0),  // Default to the encoder's configured bitrate
+      m_encoderBaseKbps(-1),
+      m_settingsDirty(false),
+      m_settingsBatchDepth(0),
+      m_settingsTimer(nullptr) {
+    
+    m_linkStats.read(m_latestStats);
           
     // Create directory for IP list file if it doesn't exist
     std::string tempPath;
@@ -61,7 +88,8 @@ SrtlaRelay::SrtlaRelay()
     if (home) {
         std::string expandedPath = std::string(home) + "/srtla_relay_temp";
         
-        // Only use this path internally for file operations, keep the ~ version for display
+        // srtla_send and our own rewrites must agree on the file, so use the expanded path
+        tempPath = expandedPath;
         if (!fs::exists(expandedPath)) {
             try {
                 fs::create_directories(expandedPath);
@@ -88,6 +116,15 @@ SrtlaRelay::SrtlaRelay()
 
     blog(LOG_INFO, "Using IP bank file: %s", m_ipListPath.c_str());
     
+    // Profile service.json writes run here, off the Qt UI thread
+    m_syncQueue = std::make_unique<JobQueue>();
+    
+    // Server names are resolved in the background and cached across restarts
+    m_resolver = std::make_unique<DnsResolver>();
+    
+    // Stream URLs of the OBS profiles, reparsed only when OBS rewrites them
+    m_profileUrls = std::make_unique<ProfileUrlCache>(readServiceFileUrl);
+    
     // Create network monitor
     m_networkMonitor = std::make_unique<NetworkMonitor>();
     
@@ -98,6 +135,14 @@ SrtlaRelay::SrtlaRelay()
 }
 
 SrtlaRelay::~SrtlaRelay() {
+    // Finish pending service syncs before anything they use goes away
+    m_syncQueue.reset();
+    
+    // Write out a pending debounced change
+    delete m_settingsTimer;
+    m_settingsTimer = nullptr;
+    flushSettings();
+    
     stopSrtlaProcess();
     
     // Clean up temp files
@@ -118,6 +163,17 @@ void SrtlaRelay::init() {
     // Load settings
     loadSettings();
     
+    // Setter changes are coalesced and written once things settle
+    m_settingsTimer = new QTimer();
+    m_settingsTimer->setSingleShot(true);
+    m_settingsTimer->setInterval(SETTINGS_FLUSH_DELAY_MS);
+    QObject::connect(m_settingsTimer, &QTimer::timeout, [this]() { flushSettings(); });
+    
+    // Remember the active profile for per-profile settings
+    char *profile = obs_frontend_get_current_profile();
+    m_currentProfile = profile ? profile : "";
+    bfree(profile);
+    
     // Service type is registered in obs_module_load in plugin-main.cpp
     
     // Set up properties
@@ -138,9 +194,26 @@ bool SrtlaRelay::saveSettings() {
     obs_data_set_bool(settings, "srtla_use_fixed_port", m_useFixedPort);
     obs_data_set_int(settings, "srtla_local_port", m_localPort);
     obs_data_set_bool(settings, "srtla_bidirectional_sync", m_bidirectionalSync);
+    obs_data_set_bool(settings, "srtla_native_sender", m_useNativeSender);
+    obs_data_set_bool(settings, "srtla_send_log_file", m_senderLogFile);
+    obs_data_set_bool(settings, "srtla_spread_server_addresses", m_spreadServerAddresses);
+    obs_data_set_bool(settings, "srtla_link_gate", m_linkGate);
+    obs_data_set_int(settings, "srtla_link_gate_max_rtt", m_linkGateMaxRttMs);
+    obs_data_set_int(settings, "srtla_link_gate_max_loss", m_linkGateMaxLossPct);
+    
+    obs_data_set_bool(settings, "srtla_adaptive_bitrate", m_adaptiveBitrate);
+    obs_data_set_int(settings, "srtla_bitrate_floor", m_bitrateFloorKbps);
+    obs_data_set_int(settings, "srtla_bitrate_ceiling", m_bitrateCeilingKbps);
+    
+    obs_data_t *schedulers = obs_data_create();
+    for (const auto& entry : m_profileSchedulers) {
+        obs_data_set_string(schedulers, entry.first.c_str(), linkSchedulerName(entry.second));
+    }
+    obs_data_set_obj(settings, "srtla_link_schedulers", schedulers);
+    obs_data_release(schedulers);
     
-    blog(LOG_INFO, "Settings values being saved: server=%s, port=%d, stream_id=%s, latency=%d, use_fixed_port=%d, local_port=%d, bidirectional_sync=%d", 
-         m_server.c_str(), m_port, m_streamId.c_str(), m_latency, m_useFixedPort, m_localPort, m_bidirectionalSync);
+    blog(LOG_INFO, "Settings values being saved: server=%s, port=%d, stream_id=%s, latency=%d, use_fixed_port=%d, local_port=%d, bidirectional_sync=%d, native_sender=%d", 
+         m_server.c_str(), m_port, m_streamId.c_str(), m_latency, m_useFixedPort, m_localPort, m_bidirectionalSync, m_useNativeSender);
     
     // Use a location in the user's home directory where we have write permissions
     const char* home = getenv("HOME");
@@ -153,9 +226,17 @@ bool SrtlaRelay::saveSettings() {
     }
     
     std::string configPath = configDir + "/srtla_settings.json";
+    std::string json = obs_data_get_json(settings);
+    obs_data_release(settings);
+    
+    // Flushes can come from the UI timer and from service callbacks on other threads
+    std::lock_guard<std::mutex> lock(m_settingsMutex);
     
-    // Check if config file already exists
-    bool fileExists = fs::exists(configPath);
+    // Nothing to write if the file already holds exactly this, spares SD cards
+    if (json == m_savedSettingsJson) {
+        m_settingsDirty = false;
+        return true;
+    }
     
     // Ensure config directory exists
     if (!fs::exists(configDir)) {
@@ -163,15 +244,42 @@ bool SrtlaRelay::saveSettings() {
             fs::create_directories(configDir);
         } catch (const fs::filesystem_error&) {
             blog(LOG_ERROR, "Failed to create config directory: %s", configDir.c_str());
-            obs_data_release(settings);
             return false;
         }
     }
     
-    obs_data_save_json(settings, configPath.c_str());
-    obs_data_release(settings);
+    // A failed write stays dirty so the next flush retries it
+    if (!atomicWriteFile(configPath, json)) {
+        return false;
+    }
+    m_savedSettingsJson = json;
+    m_settingsDirty = false;
+    return true;
+}
+
+void SrtlaRelay::markSettingsDirty() {
+    m_settingsDirty = true;
     
-    return fileExists;
+    // Inside a batch the batch writes once at its end, otherwise debounce
+    if (m_settingsBatchDepth == 0 && m_settingsTimer) {
+        QMetaObject::invokeMethod(m_settingsTimer, "start", Qt::QueuedConnection);
+    }
+}
+
+void SrtlaRelay::flushSettings() {
+    if (m_settingsDirty) {
+        saveSettings();
+    }
+}
+
+SrtlaRelay::SettingsBatch::SettingsBatch(SrtlaRelay& relay) : m_relay(relay) {
+    m_relay.m_settingsBatchDepth++;
+}
+
+SrtlaRelay::SettingsBatch::~SettingsBatch() {
+    if (--m_relay.m_settingsBatchDepth == 0) {
+        m_relay.flushSettings();
+    }
 }
 
 void SrtlaRelay::loadSettings() {
@@ -193,6 +301,16 @@ void SrtlaRelay::loadSettings() {
     m_latency = 2000;  // Default latency: 2000ms
     m_useFixedPort = true;  // Default to using fixed port
     m_localPort = 9000;  // Default local port: 9000
+    m_useNativeSender = true;  // Default to the built-in bonding engine
+    m_senderLogFile = false;
+    m_spreadServerAddresses = false;
+    m_linkGate = true;
+    m_linkGateMaxRttMs = 1000;
+    m_linkGateMaxLossPct = 20;
+    m_profileSchedulers.clear();  // Classic window scheduler everywhere
+    m_adaptiveBitrate = false;
+    m_bitrateFloorKbps = 500;
+    m_bitrateCeilingKbps = 0;
     
     // Check if config file exists
     if (!fs::exists(configPath)) {
@@ -228,18 +346,64 @@ void SrtlaRelay::loadSettings() {
             m_bidirectionalSync = true; // Default to enabled if not set
         }
         
+        // Load sender backend (default to the built-in engine)
+        if (obs_data_has_user_value(settings, "srtla_native_sender")) {
+            m_useNativeSender = obs_data_get_bool(settings, "srtla_native_sender");
+        }
+        m_senderLogFile = obs_data_get_bool(settings, "srtla_send_log_file");
+        m_spreadServerAddresses = obs_data_get_bool(settings, "srtla_spread_server_addresses");
+        
+        // Load the link quality gate (default on)
+        if (obs_data_has_user_value(settings, "srtla_link_gate")) {
+            m_linkGate = obs_data_get_bool(settings, "srtla_link_gate");
+        }
+        if (obs_data_has_user_value(settings, "srtla_link_gate_max_rtt")) {
+            m_linkGateMaxRttMs = std::max((int)obs_data_get_int(settings, "srtla_link_gate_max_rtt"), 50);
+        }
+        if (obs_data_has_user_value(settings, "srtla_link_gate_max_loss")) {
+            m_linkGateMaxLossPct = std::min(std::max((int)obs_data_get_int(settings, "srtla_link_gate_max_loss"), 0), 100);
+        }
+        
+        // Load adaptive bitrate settings (off by default, it changes the encoder)
+        m_adaptiveBitrate = obs_data_get_bool(settings, "srtla_adaptive_bitrate");
+        if (obs_data_has_user_value(settings, "srtla_bitrate_floor")) {
+            m_bitrateFloorKbps = (int)obs_data_get_int(settings, "srtla_bitrate_floor");
+        }
+        m_bitrateCeilingKbps = (int)obs_data_get_int(settings, "srtla_bitrate_ceiling");
+        if (m_bitrateFloorKbps < 100) m_bitrateFloorKbps = 100;
+        if (m_bitrateCeilingKbps < 0) m_bitrateCeilingKbps = 0;
+        
+        // Load link scheduler per profile, ignoring unknown strategy names
+        obs_data_t *schedulers = obs_data_get_obj(settings, "srtla_link_schedulers");
+        if (schedulers) {
+            for (obs_data_item_t *item = obs_data_first(schedulers); item; obs_data_item_next(&item)) {
+                LinkSchedulerType type;
+                const char* name = obs_data_item_get_string(item);
+                if (name && linkSchedulerFromName(name, type)) {
+                    m_profileSchedulers[obs_data_item_get_name(item)] = type;
+                }
+            }
+            obs_data_release(schedulers);
+        }
+        
         obs_data_release(settings);
     }
 }
 
 bool SrtlaRelay::restartWithPort(uint16_t port) {
+    // Set the port
+    m_localPort = port;
+    
+    // The SRT client only stays connected to the same port
+    if (m_processRunning && m_useNativeSender && warmRestart()) {
+        return true;
+    }
+    
     // If running, stop first
     if (m_processRunning) {
         stopSrtlaProcess();
     }
     
-    // Set the port
-    m_localPort = port;
     blog(LOG_INFO, "Restarting SRTLA process with port: %d", m_localPort);
     
     // Start the process with the specified port
@@ -270,121 +434,223 @@ bool SrtlaRelay::startSrtlaProcess() {
         blog(LOG_INFO, "Using fixed local port: %d", m_localPort);
     }
     
-    // Get the real path (with ~ expanded) for the IP bank file
-    const char* home = getenv("HOME");
-    std::string realIpPath;
-    if (home) {
-        realIpPath = std::string(home) + "/srtla_relay_temp/ip_bank.txt";
-    } else {
-        realIpPath = "/tmp/srtla_relay_temp/ip_bank.txt";
-    }
-    
-    // Ensure the directory exists
-    std::string dirPath = fs::path(realIpPath).parent_path().string();
-    if (!fs::exists(dirPath)) {
-        try {
-            fs::create_directories(dirPath);
-            blog(LOG_INFO, "Created directory for IP bank: %s", dirPath.c_str());
-        } catch (const fs::filesystem_error&) {
-            blog(LOG_ERROR, "Failed to create directory for IP bank: %s", dirPath.c_str());
-            return false;
+    // Get all network interfaces
+    std::vector<NetworkInterface> interfaces = m_networkMonitor->detectNetworkInterfaces();
+    std::vector<LinkConfig> links = collectLinks(interfaces);
+    std::vector<std::string> linkIps = collectLinkIps(interfaces);
+    
+    // Never wait on DNS here: use a cached result, or start without the
+    // server address and hand it over once the background lookup finishes
+    std::vector<std::string> serverIps;
+    bool isAddress = DnsResolver::isAddress(m_server);
+    if (isAddress) {
+        serverIps.push_back(m_server);
+    } else if (!m_resolver->lookup(m_server, serverIps)) {
+        blog(LOG_INFO, "Resolving %s in the background", m_server.c_str());
+    }
+    
+    // Built-in engine: bond directly from this process, no IP bank file or child process
+    if (m_useNativeSender) {
+        if (linkIps.empty()) {
+            blog(LOG_WARNING, "No usable network interfaces yet, links will be added as they come up");
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(m_senderMutex);
+            m_nativeSender = createNativeSender();
+            
+            // Testing aid: record the links' conditions for later replay
+            const char* tracePath = getenv("SRTLA_TRACE_RECORD");
+            if (tracePath && *tracePath) {
+                std::lock_guard<std::mutex> traceLock(m_traceMutex);
+                m_traceRecorder = std::make_unique<LinkTraceRecorder>();
+                m_traceRecordPath = tracePath;
+                blog(LOG_INFO, "Recording link trace to %s", tracePath);
+            }
+            if (!m_nativeSender->start(m_localPort, serverIps, m_port, links)) {
+                blog(LOG_ERROR, "Failed to start built-in SRTLA sender");
+                m_nativeSender.reset();
+                return false;
+            }
+            
+            m_senderServer = m_server;
+            m_senderServerPort = m_port;
+            m_linkIps = std::set<std::string>(linkIps.begin(), linkIps.end());
+            m_linkInterfaces.clear();
+            for (const auto& link : links) {
+                m_linkInterfaces[link.sourceIp] = link.ifIndex;
+            }
+            m_processRunning = true;
+        }
+        
+        // Follow DNS changes for as long as the engine runs
+        if (!isAddress) {
+            m_resolver->watch(m_server, [this](const std::vector<std::string>& addresses) {
+                onServerResolved(addresses);
+            });
         }
+        return true;
     }
     
     // Create the IP list file with dynamically detected network interfaces
-    std::ofstream ipFile(realIpPath);
-    if (!ipFile.is_open()) {
-        blog(LOG_ERROR, "Failed to create IP list file: %s", realIpPath.c_str());
+    if (!writeIpBankFile(linkIps)) {
         return false;
     }
+    m_linkIps = std::set<std::string>(linkIps.begin(), linkIps.end());
     
-    // Get all network interfaces
-    std::vector<NetworkInterface> interfaces = m_networkMonitor->detectNetworkInterfaces();
+    // srtla_send takes a single address, launch it once one is known
+    if (serverIps.empty()) {
+        m_processRunning = true;
+        m_resolver->watch(m_server, [this](const std::vector<std::string>& addresses) {
+            onServerResolved(addresses);
+        });
+        return true;
+    }
     
-    bool added = false;
-    std::string ipList;
+    std::lock_guard<std::mutex> lock(m_senderMutex);
+    return launchExternalSender(serverIps[0]);
+}
+
+bool SrtlaRelay::launchExternalSender(const std::string& serverIp) {
+    // Launch srtla_send directly, the supervisor owns the exact PID and restarts it on crash
+    std::vector<std::string> argv = {
+        "/usr/bin/srtla_send",
+        std::to_string(m_localPort),
+        serverIp,
+        std::to_string(m_port),
+        m_ipListPath
+    };
     
-    // Add all active, non-loopback interfaces
-    for (const auto& iface : interfaces) {
-        if (iface.isActive && !iface.ipAddress.empty() && 
-            iface.ipAddress != "127.0.0.1" && iface.name != "lo") {
-            
-            ipFile << iface.ipAddress << std::endl;
-            ipList += iface.ipAddress + " ";
-            added = true;
-        }
-    }
+    blog(LOG_INFO, "Starting SRTLA process: %s %s %s %s %s", argv[0].c_str(), argv[1].c_str(),
+         argv[2].c_str(), argv[3].c_str(), argv[4].c_str());
     
-    // If no interfaces found, add a default one to prevent errors
-    if (!added) {
-        // Most common local network IP
-        ipFile << "192.168.1.100" << std::endl;
-        ipList = "192.168.1.100 (fallback)";
+    m_senderOutput.setSpillFile(m_senderLogFile ? SENDER_LOG_PATH : "", SENDER_LOG_MAX_BYTES);
+    m_supervisor = std::make_unique<ProcessSupervisor>();
+    m_supervisor->setStateCallback([this](ProcessSupervisor::State state, pid_t pid) {
+        m_processRunning = state != ProcessSupervisor::State::Stopped;
+        m_processId = state == ProcessSupervisor::State::Running ? pid : -1;
+    });
+    if (!m_supervisor->start(argv, &m_senderOutput)) {
+        blog(LOG_ERROR, "Failed to start SRTLA process");
+        m_supervisor.reset();
+        m_processRunning = false;
+        return false;
     }
     
-    ipFile.close();
+    blog(LOG_INFO, "SRTLA process started with PID: %d", (int)m_processId);
+    return true;
+}
+
+void SrtlaRelay::onServerResolved(const std::vector<std::string>& addresses) {
+    // Resolver thread; stopSrtlaProcess() unwatches before tearing the sender down
+    std::lock_guard<std::mutex> lock(m_senderMutex);
+    if (m_nativeSender) {
+        m_nativeSender->setServerAddresses(addresses);
+        return;
+    }
     
-    blog(LOG_INFO, "Created IP list file with dynamic IPs [%s] at: %s", 
-         ipList.c_str(), realIpPath.c_str());
-    
-    // Build command
-    std::string cmd;
-    
-    // Get DNS resolution for the server address
-    std::string resolvedServer = m_server;
-    if (!m_server.empty() && !isdigit(m_server[0])) {
-        // Try to resolve the hostname
-        blog(LOG_INFO, "Resolving hostname: %s", m_server.c_str());
-        struct hostent *he = gethostbyname(m_server.c_str());
-        if (he != nullptr) {
-            char ip[INET_ADDRSTRLEN];
-            struct in_addr **addr_list = (struct in_addr **)he->h_addr_list;
-            
-            if (addr_list[0] != nullptr) {
-                inet_ntop(AF_INET, addr_list[0], ip, INET_ADDRSTRLEN);
-                resolvedServer = ip;
-                blog(LOG_INFO, "Resolved %s to IP: %s", m_server.c_str(), resolvedServer.c_str());
-            }
+    // A running srtla_send keeps its address until the next restart
+    if (!m_supervisor && m_processRunning) {
+        launchExternalSender(addresses[0]);
+    }
+}
+
+std::unique_ptr<SrtlaSender> SrtlaRelay::createNativeSender() {
+    auto sender = std::make_unique<SrtlaSender>();
+    sender->setStatsBuffer(&m_linkStats);
+    sender->setScheduler(getLinkScheduler());
+    sender->setSpreadServers(m_spreadServerAddresses);
+    sender->setQualityGate(linkQualityGate());
+    
+    // Testing aid: emulate cellular link conditions from a script
+    const char* impairmentPath = getenv("SRTLA_IMPAIRMENT_SCRIPT");
+    if (impairmentPath && *impairmentPath) {
+        auto script = std::make_shared<ImpairmentScript>();
+        std::string error;
+        if (ImpairmentScript::load(impairmentPath, *script, error)) {
+            blog(LOG_WARNING, "Emulating link conditions from %s", impairmentPath);
+            sender->setImpairment(script);
         } else {
-            blog(LOG_WARNING, "Could not resolve hostname, using as-is: %s", m_server.c_str());
+            blog(LOG_ERROR, "Ignoring impairment script: %s", error.c_str());
         }
     }
+    return sender;
+}
+
+bool SrtlaRelay::warmRestart() {
+    std::vector<NetworkInterface> interfaces = m_networkMonitor->detectNetworkInterfaces();
+    std::vector<LinkConfig> links = collectLinks(interfaces);
+    std::vector<std::string> linkIps = collectLinkIps(interfaces);
     
-    // Linux version - use the realIpPath we created earlier
-    cmd = "/usr/bin/srtla_send " + 
-          std::to_string(m_localPort) + " " + 
-          resolvedServer + " " + 
-          std::to_string(m_port) + " " +
-          realIpPath + " >> /tmp/srtla.log 2>&1 &";
+    std::unique_lock<std::mutex> lock(m_senderMutex);
+    if (!m_nativeSender || m_nativeSender->localPort() != m_localPort) {
+        return false;
+    }
+    // Handovers are not chained, the engine being replaced must own the socket alone
+    if (m_nativeSender->isTakingOver()) {
+        blog(LOG_INFO, "SRTLA sender is still taking over from the previous one, restarting it");
+        return false;
+    }
+    bool sameServer = m_server == m_senderServer && m_port == m_senderServerPort;
+    lock.unlock();
     
-    blog(LOG_INFO, "Starting SRTLA process with command: %s", cmd.c_str());
+    // Joining the running group needs the server address right away; a new
+    // group at another server can register once the name has resolved
+    std::vector<std::string> serverIps;
+    bool isAddress = DnsResolver::isAddress(m_server);
+    if (isAddress) {
+        serverIps.push_back(m_server);
+    } else if (!m_resolver->lookup(m_server, serverIps) && sameServer) {
+        return false;
+    }
+    
+    // Addresses of the old server must not reach the new engine. Waits for
+    // a delivery in progress, so not under m_senderMutex.
+    if (!sameServer) {
+        m_resolver->unwatch();
+    }
     
-    int result = system(cmd.c_str());
-    if (result != 0) {
-        blog(LOG_ERROR, "Failed to start SRTLA process (code: %d)", result);
+    lock.lock();
+    if (!m_nativeSender) {
+        return false;
+    }
+    auto sender = createNativeSender();
+    if (!sender->startWarm(*m_nativeSender, serverIps, m_port, links, sameServer)) {
+        blog(LOG_INFO, "SRTLA sender has no registered group to hand over, restarting it");
         return false;
     }
     
-    // Mark as running
-    m_processRunning = true;
+    // The engine retired before has been stopped by the handover to the current one
+    m_retiredSender = std::move(m_nativeSender);
+    m_nativeSender = std::move(sender);
+    m_senderServer = m_server;
+    m_senderServerPort = m_port;
     
-    // Try to find PID of the process
-    // This could be improved with a more reliable way to get the PID
-    std::string findPidCmd = "pgrep -f 'srtla_send " + std::to_string(m_localPort) + "'";
-    FILE* pipe = popen(findPidCmd.c_str(), "r");
-    if (pipe) {
-        char buffer[128];
-        if (fgets(buffer, sizeof(buffer), pipe) != NULL) {
-            m_processId = atoi(buffer);
-            blog(LOG_INFO, "SRTLA process started with PID: %d", m_processId);
-        }
-        pclose(pipe);
+    m_linkIps = std::set<std::string>(linkIps.begin(), linkIps.end());
+    m_linkInterfaces.clear();
+    for (const auto& link : links) {
+        m_linkInterfaces[link.sourceIp] = link.ifIndex;
     }
+    lock.unlock();
     
+    if (!sameServer && !isAddress) {
+        m_resolver->watch(m_server, [this](const std::vector<std::string>& addresses) {
+            onServerResolved(addresses);
+        });
+    }
+    if (sameServer) {
+        blog(LOG_INFO, "Restarting SRTLA sender on port %d without a gap", m_localPort);
+    } else {
+        blog(LOG_INFO, "Moving SRTLA sender on port %d to %s:%d without a gap", m_localPort,
+             m_server.c_str(), m_port);
+    }
     return true;
 }
 
 void SrtlaRelay::stopSrtlaProcess() {
+    // No more address updates, waits for one that is being delivered
+    m_resolver->unwatch();
+    
     if (!m_processRunning) {
         blog(LOG_INFO, "SRTLA process is not running");
         return;
@@ -392,320 +658,512 @@ void SrtlaRelay::stopSrtlaProcess() {
     
     blog(LOG_INFO, "Stopping SRTLA process");
     
-    // Try to kill the process by PID first
-    if (m_processId > 0) {
-        blog(LOG_INFO, "Killing process with PID: %d", m_processId);
-        PROCESS_KILL(m_processId);
-    } else {
-        // Alternative: Kill all SRTLA processes
-        killSrtlaProcess();
+    // The built-in engine only needs its thread joined
+    std::unique_lock<std::mutex> senderLock(m_senderMutex);
+    if (m_nativeSender) {
+        // Also stops the retired engine if it is still being taken over
+        m_nativeSender->stop();
+        m_nativeSender.reset();
+        m_retiredSender.reset();
+    }
+    // Terminates only our own child, waiting for it to exit
+    else if (m_supervisor) {
+        m_supervisor->stop();
+        m_supervisor.reset();
     }
     
     // Reset state
     m_processRunning = false;
     m_processId = -1;
+    senderLock.unlock();
+    
+    std::lock_guard<std::mutex> traceLock(m_traceMutex);
+    if (m_traceRecorder) {
+        if (m_traceRecorder->empty()) {
+            blog(LOG_INFO, "No link statistics recorded, not writing %s", m_traceRecordPath.c_str());
+        } else if (saveLinkTrace(m_traceRecordPath, m_traceRecorder->trace())) {
+            blog(LOG_INFO, "Link trace saved to %s", m_traceRecordPath.c_str());
+        } else {
+            blog(LOG_ERROR, "Failed to save link trace to %s", m_traceRecordPath.c_str());
+        }
+        m_traceRecorder.reset();
+    }
+}
+
+std::vector<NetworkInterface> SrtlaRelay::getNetworkInterfaces() {
+    if (!m_networkMonitor) return {};
+    return m_networkMonitor->getNetworkInterfaces();
 }
 
-void SrtlaRelay::killSrtlaProcess() {
-    blog(LOG_INFO, "Attempting to stop SRTLA process");
+void SrtlaRelay::drainSenderOutput() {
+    // The only consumer of m_senderOutput, on the UI thread. A restarted
+    // srtla_send registers its links again, a stopped one has none.
+    int pid = m_processId;
+    if (pid != m_externalStatusPid) {
+        m_externalStatusPid = pid;
+        m_externalStatus.registeredLinks.clear();
+    }
+    
+    std::string line;
+    SrtlaSendEvent event;
+    while (m_senderOutput.pop(line)) {
+        if (!parseSrtlaSendEvent(line, event)) {
+            blog(LOG_DEBUG, "[srtla_send] %s", line.c_str());
+            continue;
+        }
+        
+        int level = LOG_INFO;
+        switch (event.type) {
+        case SrtlaSendEvent::Type::LinkRegistered:
+            // Lines still queued from a stopped sender are only logged
+            if (pid > 0) {
+                m_externalStatus.registeredLinks.insert(event.link);
+            }
+            break;
+        case SrtlaSendEvent::Type::LinkTimedOut:
+            m_externalStatus.registeredLinks.erase(event.link);
+            level = LOG_WARNING;
+            break;
+        case SrtlaSendEvent::Type::ConnectionLost:
+            m_externalStatus.registeredLinks.clear();
+            level = LOG_ERROR;
+            break;
+        case SrtlaSendEvent::Type::Error:
+            level = LOG_WARNING;
+            break;
+        case SrtlaSendEvent::Type::GroupRegistered:
+        default:
+            break;
+        }
+        
+        m_externalStatus.lastEvent = srtlaSendEventName(event.type);
+        if (!event.link.empty()) {
+            m_externalStatus.lastEvent = event.link + ": " + m_externalStatus.lastEvent;
+        }
+        blog(level, "srtla_send event: %s (%s)", m_externalStatus.lastEvent.c_str(), line.c_str());
+    }
     
-    if (m_processId > 0) {
-        blog(LOG_INFO, "Killing process with ID: %d", m_processId);
-        PROCESS_KILL(m_processId);
-    } else {
-        // Alternative: Kill all SRTLA processes
-        blog(LOG_INFO, "No PID available, killing all srtla_send processes");
-        system("pkill -f srtla_send");
+    uint64_t dropped = m_senderOutput.dropped();
+    if (dropped != m_senderOutputDropped) {
+        blog(LOG_WARNING, "srtla_send printed faster than it is logged, %llu line(s) skipped",
+             (unsigned long long)(dropped - m_senderOutputDropped));
+        m_senderOutputDropped = dropped;
     }
 }
 
-void SrtlaRelay::onNetworkChange(const std::vector<NetworkInterface>& interfaces) {
-    blog(LOG_INFO, "Network change detected - updating IP bank file");
+void SrtlaRelay::pollLinkStats() {
+    drainSenderOutput();
     
-    // Update IP list file
-    if (m_networkMonitor->saveIpListToFile(m_ipListPath)) {
-        blog(LOG_INFO, "IP bank file updated successfully");
-    } else {
-        blog(LOG_ERROR, "Failed to update IP bank file after network change");
+    if (!m_linkStats.read(m_latestStats)) {
+        return;
     }
     
-    // If process is running, send HUP signal to reload the IP list
-    if (m_processRunning) {
-        blog(LOG_INFO, "Sending HUP signal to SRTLA process to reload IP list");
-        // Linux - use killall with HUP signal
-        system("killall -HUP srtla_send");
-        blog(LOG_INFO, "HUP signal sent to reload IP list");
+    int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    {
+        std::lock_guard<std::mutex> lock(m_traceMutex);
+        if (m_traceRecorder) {
+            m_traceRecorder->record(*m_latestStats, nowMs);
+        }
+    }
+    
+    if (!m_adaptiveBitrate || m_encoderBaseKbps <= 0 || !m_useNativeSender || !m_processRunning) {
+        return;
+    }
+    
+    if (m_bitrateController.update(*m_latestStats, nowMs)) {
+        int kbps = m_bitrateController.appliedKbps();
+        blog(LOG_INFO, "Adaptive bitrate: %s, setting encoder bitrate to %d kbps",
+             m_bitrateController.isCongested() ? "links congested" : "links recovered", kbps);
+        applyEncoderBitrate(kbps);
     }
 }
 
-uint16_t SrtlaRelay::generateRandomPort() const {
-    // Generate random port between 10000 and 65000
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<uint16_t> distrib(10000, 65000);
+void SrtlaRelay::onStreamingStarted() {
+    m_encoderBaseKbps = -1;
     
-    return distrib(gen);
+    obs_output_t *output = obs_frontend_get_streaming_output();
+    if (!output) {
+        return;
+    }
+    obs_encoder_t *encoder = obs_output_get_video_encoder(output);
+    if (encoder) {
+        obs_data_t *settings = obs_encoder_get_settings(encoder);
+        m_encoderBaseKbps = (int)obs_data_get_int(settings, "bitrate");
+        obs_data_release(settings);
+    }
+    obs_output_release(output);
+    
+    if (m_encoderBaseKbps <= 0) {
+        if (m_adaptiveBitrate) {
+            blog(LOG_WARNING, "Adaptive bitrate: streaming encoder has no bitrate setting, not adjusting");
+        }
+        return;
+    }
+    
+    // Start from the configured bitrate and only go below it unless a higher ceiling was set
+    BitrateControllerConfig config;
+    config.floorKbps = m_bitrateFloorKbps;
+    config.ceilingKbps = m_bitrateCeilingKbps > 0 ? m_bitrateCeilingKbps : m_encoderBaseKbps;
+    m_bitrateController.configure(config);
+    m_bitrateController.reset(m_encoderBaseKbps);
+    
+    if (m_adaptiveBitrate) {
+        blog(LOG_INFO, "Adaptive bitrate: encoder at %d kbps, range %d-%d kbps",
+             m_encoderBaseKbps, config.floorKbps, config.ceilingKbps);
+        if (m_bitrateController.appliedKbps() != m_encoderBaseKbps) {
+            applyEncoderBitrate(m_bitrateController.appliedKbps());
+        }
+    }
 }
 
-// Extract SRT parameters from URL
-bool SrtlaRelay::extractSRTParamsFromURL(const std::string& url, uint16_t& port, int& latency, std::string& streamId) {
-    // Save the original port value before extraction
-    uint16_t originalPort = port;
-    blog(LOG_INFO, "Port value before extraction: %d", originalPort);
+void SrtlaRelay::onStreamingStopped() {
+    // Leave the user's configured bitrate behind, not whatever the loop settled on
+    if (m_encoderBaseKbps > 0 && m_bitrateController.appliedKbps() != m_encoderBaseKbps) {
+        applyEncoderBitrate(m_encoderBaseKbps);
+    }
+    m_encoderBaseKbps = -1;
+}
+
+bool SrtlaRelay::applyEncoderBitrate(int kbps) {
+    obs_output_t *output = obs_frontend_get_streaming_output();
+    if (!output) {
+        return false;
+    }
     
-    // Initialize for the extraction process
-    latency = 2000;  // Default latency
-    streamId = "";
+    bool applied = false;
+    obs_encoder_t *encoder = obs_output_get_video_encoder(output);
+    if (encoder) {
+        obs_data_t *settings = obs_encoder_get_settings(encoder);
+        obs_data_set_int(settings, "bitrate", kbps);
+        obs_encoder_update(encoder, settings);
+        obs_data_release(settings);
+        applied = true;
+    }
+    obs_output_release(output);
+    return applied;
+}
+
+std::vector<LinkConfig> SrtlaRelay::collectLinks(const std::vector<NetworkInterface>& interfaces) const {
+    std::vector<LinkConfig> links;
+    std::set<std::pair<int, bool>> seen;
+    for (const auto& iface : interfaces) {
+        if (iface.isActive && !iface.ipAddress.empty() && 
+            iface.ipAddress != "127.0.0.1" && iface.name != "lo") {
+            // One link per interface and address family; an IPv6 uplink
+            // usually has several global addresses
+            if (iface.ifIndex > 0 && !seen.insert({iface.ifIndex, iface.ipv6}).second) {
+                continue;
+            }
+            LinkConfig link;
+            link.sourceIp = iface.ipAddress;
+            link.priority = interfacePriority(iface.type);
+            link.ifIndex = iface.ifIndex;
+            link.interfaceName = iface.name;
+            links.push_back(link);
+        }
+    }
+    return links;
+}
+
+std::vector<std::string> SrtlaRelay::collectLinkIps(const std::vector<NetworkInterface>& interfaces) const {
+    std::vector<std::string> ips;
+    for (const auto& link : collectLinks(interfaces)) {
+        ips.push_back(link.sourceIp);
+    }
+    return ips;
+}
+
+bool SrtlaRelay::writeIpBankFile(const std::vector<std::string>& ips) {
+    // Ensure the directory exists
+    std::string dirPath = fs::path(m_ipListPath).parent_path().string();
+    if (!fs::exists(dirPath)) {
+        try {
+            fs::create_directories(dirPath);
+            blog(LOG_INFO, "Created directory for IP bank: %s", dirPath.c_str());
+        } catch (const fs::filesystem_error&) {
+            blog(LOG_ERROR, "Failed to create directory for IP bank: %s", dirPath.c_str());
+            return false;
+        }
+    }
     
-    blog(LOG_INFO, "Parsing SRT URL: %s", url.c_str());
+    // Write a temp file and rename it, so srtla_send never reads a partial list
+    std::string tmpPath = m_ipListPath + ".tmp";
+    std::ofstream ipFile(tmpPath, std::ios::trunc);
+    if (!ipFile.is_open()) {
+        blog(LOG_ERROR, "Failed to create IP list file: %s", tmpPath.c_str());
+        return false;
+    }
     
-    // Handle various SRT URL formats:
-    // srt://localhost:port
-    // srt://localhost:port?latency=number
-    // srt://localhost:port?latency=number&streamid=string
-    // srt://localhost:port?streamid=string
-    // srt://localhost:port?streamid=string&latency=number
+    // srtla_send binds IPv4 sockets only
+    std::string ipList;
+    for (const auto& ip : ips) {
+        if (ip.find(':') != std::string::npos) continue;
+        ipFile << ip << std::endl;
+        ipList += ip + " ";
+    }
     
-    if (url.empty()) {
-        blog(LOG_WARNING, "Empty SRT URL");
-        // Keep original port value
-        port = originalPort;
-        blog(LOG_INFO, "Keeping original port value: %d", port);
-        return false;
+    // If no interfaces found, add a default one to prevent errors
+    if (ipList.empty()) {
+        // Most common local network IP
+        ipFile << "192.168.1.100" << std::endl;
+        ipList = "192.168.1.100 (fallback)";
     }
     
-    // Check if it's an SRT URL
-    if (url.compare(0, 6, "srt://") != 0) {
-        blog(LOG_WARNING, "Not an SRT URL: %s", url.c_str());
-        // Keep original port value
-        port = originalPort;
-        blog(LOG_INFO, "Keeping original port value: %d", port);
+    ipFile.close();
+    if (ipFile.fail() || rename(tmpPath.c_str(), m_ipListPath.c_str()) != 0) {
+        blog(LOG_ERROR, "Failed to write IP list file: %s", m_ipListPath.c_str());
         return false;
     }
     
-    // Extract host:port part
-    size_t hostStart = 6; // After "srt://"
-    size_t hostEnd = url.find('?', hostStart);
-    std::string hostPort = url.substr(hostStart, (hostEnd != std::string::npos) ? hostEnd - hostStart : std::string::npos);
+    blog(LOG_INFO, "Wrote IP list file with dynamic IPs [%s] at: %s", 
+         ipList.c_str(), m_ipListPath.c_str());
+    return true;
+}
+
+void SrtlaRelay::onNetworkChange(const std::vector<NetworkInterface>& interfaces) {
+    std::vector<LinkConfig> links = collectLinks(interfaces);
+    std::vector<std::string> current = collectLinkIps(interfaces);
+    std::set<std::string> currentSet(current.begin(), current.end());
+    
+    std::lock_guard<std::mutex> lock(m_senderMutex);
+    
+    // Work out which links came and went since the last update
+    std::vector<std::string> added;
+    std::vector<std::string> removed;
+    std::set_difference(currentSet.begin(), currentSet.end(), m_linkIps.begin(), m_linkIps.end(),
+                        std::back_inserter(added));
+    std::set_difference(m_linkIps.begin(), m_linkIps.end(), currentSet.begin(), currentSet.end(),
+                        std::back_inserter(removed));
+    
+    // An address that reappears on another interface (a modem re-plugged
+    // with the same lease) needs its socket pinned to the new one
+    std::vector<LinkConfig> moved;
+    for (const auto& link : links) {
+        auto it = m_linkInterfaces.find(link.sourceIp);
+        if (it != m_linkInterfaces.end() && it->second != link.ifIndex) {
+            moved.push_back(link);
+        }
+    }
     
-    blog(LOG_INFO, "Host:Port part: %s", hostPort.c_str());
+    if (added.empty() && removed.empty() && moved.empty()) {
+        return;
+    }
+    m_linkIps = currentSet;
+    m_linkInterfaces.clear();
+    for (const auto& link : links) {
+        m_linkInterfaces[link.sourceIp] = link.ifIndex;
+    }
     
-    // Extract port
-    size_t portPos = hostPort.find(':');
-    if (portPos != std::string::npos) {
-        std::string portStr = hostPort.substr(portPos + 1);
-        try {
-            uint16_t extractedPort = static_cast<uint16_t>(std::stoi(portStr));
-            
-            // Only use the extracted port if it's valid
-            if (extractedPort > 0) {
-                port = extractedPort;
-                blog(LOG_INFO, "Found valid port in URL: %d", port);
-            } else {
-                // Keep the original port if extracted port is 0 or invalid
-                port = originalPort;
-                blog(LOG_WARNING, "Found invalid port (0) in URL, keeping original: %d", port);
+    for (const auto& ip : added) {
+        blog(LOG_INFO, "Network change detected - link added: %s", ip.c_str());
+    }
+    for (const auto& ip : removed) {
+        blog(LOG_INFO, "Network change detected - link removed: %s", ip.c_str());
+    }
+    for (const auto& link : moved) {
+        blog(LOG_INFO, "Network change detected - link %s moved to %s", link.sourceIp.c_str(),
+             link.interfaceName.c_str());
+    }
+    
+    if (!m_processRunning) {
+        return;
+    }
+    
+    // The built-in engine takes the deltas directly, unchanged links keep their registration
+    if (m_nativeSender) {
+        for (const auto& ip : removed) {
+            m_nativeSender->removeLink(ip);
+        }
+        for (const auto& link : moved) {
+            m_nativeSender->removeLink(link.sourceIp);
+            m_nativeSender->addLink(link);
+        }
+        for (const auto& link : links) {
+            if (std::find(added.begin(), added.end(), link.sourceIp) != added.end()) {
+                m_nativeSender->addLink(link);
             }
-        } catch (const std::exception& e) {
-            blog(LOG_WARNING, "Failed to parse port in SRT URL: %s - %s", url.c_str(), e.what());
-            // Keep the original port value instead of using a default
-            port = originalPort;
-            blog(LOG_INFO, "Keeping original port after parse failure: %d", port);
         }
+        return;
+    }
+    
+    // srtla_send only knows addresses, a move changes nothing for it
+    if (added.empty() && removed.empty()) {
+        return;
+    }
+    
+    // srtla_send has no control interface, so it re-reads its IP bank on SIGHUP
+    if (!writeIpBankFile(current)) {
+        blog(LOG_ERROR, "Failed to update IP bank file after network change");
+        return;
+    }
+    
+    // Only signal our own sender, never other srtla_send instances on the host.
+    // A sender that is being restarted picks up the new file when it starts.
+    if (m_supervisor && m_supervisor->signal(SIGHUP)) {
+        blog(LOG_INFO, "Sent HUP signal to SRTLA process %d to reload IP list", (int)m_processId);
     } else {
-        // No port in URL, keep the original port
-        blog(LOG_INFO, "No port specified in URL, keeping original: %d", originalPort);
-        port = originalPort;
+        blog(LOG_INFO, "SRTLA process not up, IP list will be used when it restarts");
     }
+}
+
+uint16_t SrtlaRelay::generateRandomPort() const {
+    // Generate random port between 10000 and 65000
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<uint16_t> distrib(10000, 65000);
     
-    // Extract parameters if present
-    if (hostEnd != std::string::npos) {
-        std::string params = url.substr(hostEnd + 1);
-        blog(LOG_INFO, "URL parameters: %s", params.c_str());
-        
-        // Parse parameters - split by &
-        size_t paramStart = 0;
-        size_t paramEnd;
-        
-        do {
-            paramEnd = params.find('&', paramStart);
-            std::string param = params.substr(paramStart, (paramEnd != std::string::npos) ? paramEnd - paramStart : std::string::npos);
-            
-            // Split by =
-            size_t nameEnd = param.find('=');
-            if (nameEnd != std::string::npos) {
-                std::string name = param.substr(0, nameEnd);
-                std::string value = param.substr(nameEnd + 1);
-                
-                blog(LOG_INFO, "Found parameter: %s = %s", name.c_str(), value.c_str());
-                
-                // Process known parameters (case-insensitive comparison manually)
-                std::string nameLower = name;
-                for (char& c : nameLower) {
-                    c = std::tolower(c);
-                }
-                
-                if (nameLower == "latency" || nameLower == "delay") {
-                    try {
-                        latency = std::stoi(value);
-                        blog(LOG_INFO, "Parsed latency: %d", latency);
-                    } catch (const std::exception& e) {
-                        blog(LOG_WARNING, "Failed to parse latency value in SRT URL: %s", value.c_str());
-                    }
-                } else if (nameLower == "streamid") {
-                    streamId = value;
-                    blog(LOG_INFO, "Found streamid: %s", streamId.c_str());
-                }
-            }
-            
-            paramStart = (paramEnd != std::string::npos) ? paramEnd + 1 : std::string::npos;
-        } while (paramStart != std::string::npos);
+    return distrib(gen);
+}
+
+// Extract SRT parameters from URL. A missing or invalid port leaves port
+// unchanged; latency defaults to 2000 ms and streamId to empty.
+bool SrtlaRelay::extractSRTParamsFromURL(const std::string& url, uint16_t& port, int& latency, std::string& streamId) {
+    latency = 2000;
+    streamId.clear();
+    
+    std::string scratch(url.size(), '\0');
+    SrtUrl parsed;
+    if (!parseSrtUrl(url, parsed, &scratch[0], scratch.size())) {
+        blog(LOG_WARNING, "Not a valid SRT URL: %s", url.c_str());
+        return false;
     }
     
-    blog(LOG_INFO, "Extracted SRT parameters - port: %d, latency: %d, streamId: %s", 
-         port, latency, streamId.c_str());
+    if (parsed.port > 0) {
+        port = parsed.port;
+    }
+    if (parsed.latency) {
+        latency = *parsed.latency;
+    }
+    streamId.assign(parsed.streamId.data(), parsed.streamId.size());
     
+    blog(LOG_DEBUG, "Parsed SRT URL %s - port: %d, latency: %d, streamId: %s",
+         url.c_str(), port, latency, streamId.c_str());
     return true;
 }
 
 // Build SRT URL from parameters
 std::string SrtlaRelay::buildSRTURL(uint16_t port, int latency, const std::string& streamId) {
-    std::string url;
+    // localhost for readability and consistency with the OBS UI; a 0 port
+    // means the current local port
+    SrtUrl srtUrl;
+    srtUrl.host = "localhost";
+    srtUrl.port = port > 0 ? port : m_localPort;
+    srtUrl.streamId = streamId;
     
-    // Use localhost for better readability and consistency with OBS UI
-    if (port > 0) {
-        // Use the provided port value
-        url = "srt://localhost:" + std::to_string(port);
-        blog(LOG_INFO, "Using specified port for URL: %d", port);
-    } else {
-        // If port is 0 or invalid, use the current local port from instance
-        url = "srt://localhost:" + std::to_string(m_localPort);
-        blog(LOG_INFO, "Using current instance port for URL: %d", m_localPort);
+    // Always include the latency so it persists, even outside the optimal range
+    srtUrl.latency = (latency >= 1000) ? latency : m_latency;
+    
+    std::string url(formatSrtUrl(srtUrl, nullptr, 0), '\0');
+    formatSrtUrl(srtUrl, &url[0], url.size() + 1);
+    
+    blog(LOG_DEBUG, "Built SRT URL: %s", url.c_str());
+    return url;
+}
+
+bool SrtlaRelay::writeProfileServiceUrl(const std::string& profileDir, const std::string& newUrl) {
+    if (profileDir.empty()) {
+        return false;
     }
+    std::string servicePath = profileDir + "/service.json";
     
-    // Include both streamId and latency parameters if specified
-    bool hasParam = false;
+    // The cache answers from memory while the file is unchanged, so a
+    // repeated sync with the same URL does no file I/O at all
+    {
+        std::lock_guard<std::mutex> lock(m_profileUrlMutex);
+        if (m_profileUrls->lookup(profileDir) == newUrl) {
+            return true;
+        }
+    }
     
-    // Add streamId parameter first
-    if (!streamId.empty()) {
-        url += "?streamid=" + streamId;
-        hasParam = true;
+    // OBS creates the file when it saves the profile; never invent one
+    obs_data_t* serviceConfig = obs_data_create_from_json_file(servicePath.c_str());
+    if (!serviceConfig) {
+        blog(LOG_INFO, "No service.json in profile %s, not writing one", profileDir.c_str());
+        return false;
     }
     
-    // Always add latency parameter
-    // Even if outside the optimal range, include it to ensure persistence
-    int usedLatency = (latency >= 1000) ? latency : m_latency;
-    url += (hasParam ? "&" : "?") + std::string("latency=") + std::to_string(usedLatency);
+    obs_data_t* settings = obs_data_get_obj(serviceConfig, "settings");
+    if (!settings) {
+        settings = obs_data_create();
+        obs_data_set_obj(serviceConfig, "settings", settings);
+    }
     
-    blog(LOG_INFO, "Built SRT URL: %s", url.c_str());
-    return url;
+    bool changed = false;
+    for (const char* field : {"server", "url"}) {
+        const char* value = obs_data_get_string(settings, field);
+        if (!value || newUrl != value) {
+            obs_data_set_string(settings, field, newUrl.c_str());
+            changed = true;
+        }
+    }
+    obs_data_release(settings);
+    
+    bool success = true;
+    if (changed) {
+        const char* json = obs_data_get_json(serviceConfig);
+        success = json && atomicWriteFile(servicePath, json);
+        if (success) {
+            blog(LOG_INFO, "Updated %s with new URL: %s", servicePath.c_str(), newUrl.c_str());
+        } else {
+            blog(LOG_WARNING, "Failed to update %s", servicePath.c_str());
+        }
+    }
+    
+    obs_data_release(serviceConfig);
+    return success;
 }
 
-// Get the current OBS stream server URL
-// Implement the forceful update of OBS stream URL
-bool SrtlaRelay::forceUpdateOBSStreamURL(const std::string& newUrl) {
-    blog(LOG_INFO, "Force updating OBS Stream URL to: %s", newUrl.c_str());
-    
-    // Try multiple methods to ensure URL gets updated
-    bool success = false;
+// Stream URL stored in a profile's service.json, empty if there is none
+static std::string readServiceFileUrl(const std::string& path) {
+    std::string url;
+    obs_data_t* serviceData = obs_data_create_from_json_file(path.c_str());
+    if (!serviceData) {
+        return url;
+    }
     
-    // Method 1: Update service settings directly
-    obs_service_t* service = obs_frontend_get_streaming_service();
-    if (service) {
-        obs_data_t* settings = obs_data_create();
-        obs_data_set_string(settings, "url", newUrl.c_str());
-        obs_data_set_string(settings, "server", newUrl.c_str());
-        obs_service_update(service, settings);
+    obs_data_t* settings = obs_data_get_obj(serviceData, "settings");
+    if (settings) {
+        const char* server = obs_data_get_string(settings, "server");
+        const char* settingsUrl = obs_data_get_string(settings, "url");
+        if (server && *server) {
+            url = server;
+        } else if (settingsUrl && *settingsUrl) {
+            url = settingsUrl;
+        }
         obs_data_release(settings);
-        
-        // Force UI refresh by reapplying the service
-        obs_frontend_set_streaming_service(service);
-        
-        blog(LOG_INFO, "Updated service URL through API");
-        success = true;
     }
-    
-    // Method 2: Try to find the config files directly
-    const char* home = getenv("HOME");
-    if (home) {
-        // Try common profile paths
-        std::vector<std::string> possiblePaths = {
-            std::string(home) + "/.config/obs-studio/basic/profiles/Untitled/service.json",
-            std::string(home) + "/.config/obs-studio/basic/profiles/Default/service.json",
-            std::string(home) + "/.config/obs-studio/basic/profiles/default/service.json",
-            std::string(home) + "/.config/obs-studio/basic/service.json"
-        };
-        
-        // Try each path
-        for (const auto& path : possiblePaths) {
-            blog(LOG_INFO, "Checking for OBS config at: %s", path.c_str());
-            
-            if (fs::exists(path)) {
-                blog(LOG_INFO, "Found OBS service config at: %s - attempting direct edit", path.c_str());
-                
-                // Read current content
-                std::ifstream inFile(path);
-                std::string content((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
-                inFile.close();
-                
-                blog(LOG_INFO, "Current config content (excerpt): %.100s...", content.c_str());
-                
-                // Use brute-force search and replace for the URL and server patterns
-                // First try URL field
-                bool updated = false;
-                size_t urlPos = content.find("\"url\":");
-                if (urlPos != std::string::npos) {
-                    // Find the beginning and end of the URL value
-                    size_t valueStart = content.find("\"", urlPos + 6) + 1;
-                    size_t valueEnd = content.find("\"", valueStart);
-                    
-                    if (valueStart != std::string::npos && valueEnd != std::string::npos) {
-                        std::string oldUrl = content.substr(valueStart, valueEnd - valueStart);
-                        blog(LOG_INFO, "Found URL in config: %s", oldUrl.c_str());
-                        
-                        // Replace the URL
-                        content.replace(valueStart, valueEnd - valueStart, newUrl);
-                        updated = true;
-                        
-                        blog(LOG_INFO, "Updated URL field in config file from %s to %s", 
-                             oldUrl.c_str(), newUrl.c_str());
-                    }
-                }
-                
-                // Then try server field
-                size_t serverPos = content.find("\"server\":");
-                if (serverPos != std::string::npos) {
-                    // Find the beginning and end of the server value
-                    size_t valueStart = content.find("\"", serverPos + 9) + 1;
-                    size_t valueEnd = content.find("\"", valueStart);
-                    
-                    if (valueStart != std::string::npos && valueEnd != std::string::npos) {
-                        std::string oldServer = content.substr(valueStart, valueEnd - valueStart);
-                        blog(LOG_INFO, "Found server in config: %s", oldServer.c_str());
-                        
-                        // Replace the server
-                        content.replace(valueStart, valueEnd - valueStart, newUrl);
-                        updated = true;
-                        
-                        blog(LOG_INFO, "Updated server field in config file from %s to %s", 
-                             oldServer.c_str(), newUrl.c_str());
-                    }
-                }
-                
-                // Write back to file if we made changes
-                if (updated) {
-                    std::ofstream outFile(path);
-                    outFile << content;
-                    outFile.close();
-                    
-                    blog(LOG_INFO, "Directly updated config file with new URL: %s", newUrl.c_str());
-                    success = true;
-                }
-            }
+    if (url.empty()) {
+        const char* serviceUrl = obs_data_get_string(serviceData, "url");
+        if (serviceUrl && *serviceUrl) {
+            url = serviceUrl;
         }
     }
     
-    return success;
+    obs_data_release(serviceData);
+    return url;
+}
+
+std::string SrtlaRelay::currentProfileDir() const {
+    std::string dir;
+#if LIBOBS_API_MAJOR_VER >= 30
+    char* profilePath = obs_frontend_get_current_profile_path();
+    if (profilePath) {
+        dir = profilePath;
+        bfree(profilePath);
+        while (dir.size() > 1 && dir.back() == '/') {
+            dir.pop_back();
+        }
+        return dir;
+    }
+#endif
+    const char* home = getenv("HOME");
+    char* currentProfile = obs_frontend_get_current_profile();
+    if (home && currentProfile) {
+        dir = std::string(home) + "/.config/obs-studio/basic/profiles/" + currentProfile;
+    }
+    bfree(currentProfile);
+    return dir;
 }
 
 std::string SrtlaRelay::getCurrentOBSStreamServerURL() {
@@ -746,92 +1204,18 @@ std::string SrtlaRelay::getCurrentOBSStreamServerURL() {
         }
     }
     
-    // Try config file access if API fails or URL doesn't start with srt://
+    // Fall back to the active profile's service.json, parsed once per change
     if (url.empty() || url.compare(0, 6, "srt://") != 0) {
-        blog(LOG_INFO, "API didn't provide usable SRT URL, trying config files and other approaches...");
-        
-        // Try all profiles directories
-        const char* home = getenv("HOME");
-        if (home) {
-            // Get the basic profile directory
-            std::string basicDir = std::string(home) + "/.config/obs-studio/basic";
-            std::string profilesDir = basicDir + "/profiles";
-            
-            // Use current profile if possible
-            char* currentProfile = obs_frontend_get_current_profile();
-            if (currentProfile) {
-                std::string profilePath = profilesDir + "/" + currentProfile;
-                std::string servicePath = profilePath + "/service.json";
-                
-                blog(LOG_INFO, "Checking current profile service.json: %s", servicePath.c_str());
-                
-                if (fs::exists(servicePath)) {
-                    blog(LOG_INFO, "Found current profile service config at: %s", servicePath.c_str());
-                    
-                    // Load the file using OBS API
-                    obs_data_t* serviceData = obs_data_create_from_json_file(servicePath.c_str());
-                    if (serviceData) {
-                        // Save a copy for inspection
-                        obs_data_save_json(serviceData, "/tmp/profile_service.json");
-                        
-                        // Try to get the URL from various possible places
-                        const char* serviceUrl = obs_data_get_string(serviceData, "url");
-                        if (serviceUrl && *serviceUrl) {
-                            url = serviceUrl;
-                            blog(LOG_INFO, "Found URL in service.json: %s", url.c_str());
-                        } else {
-                            // Try nested settings
-                            obs_data_t* settings = obs_data_get_obj(serviceData, "settings");
-                            if (settings) {
-                                const char* settingsUrl = obs_data_get_string(settings, "url");
-                                if (settingsUrl && *settingsUrl) {
-                                    url = settingsUrl;
-                                    blog(LOG_INFO, "Found URL in service.json settings: %s", url.c_str());
-                                }
-                                obs_data_release(settings);
-                            }
-                        }
-                        
-                        obs_data_release(serviceData);
-                    }
-                }
-                
-                bfree(currentProfile);
+        std::string profileDir = currentProfileDir();
+        if (!profileDir.empty()) {
+            std::string profileUrl;
+            {
+                std::lock_guard<std::mutex> lock(m_profileUrlMutex);
+                profileUrl = m_profileUrls->lookup(profileDir);
             }
-            
-            // If still no URL, try all profile directories
-            if (url.empty() || url.compare(0, 6, "srt://") != 0) {
-                // Try to enumerate directories in profiles folder
-                if (fs::exists(profilesDir) && fs::is_directory(profilesDir)) {
-                    for (const auto& entry : fs::directory_iterator(profilesDir)) {
-                        if (fs::is_directory(entry.path())) {
-                            std::string servicePath = entry.path().string() + "/service.json";
-                            
-                            if (fs::exists(servicePath)) {
-                                blog(LOG_INFO, "Found service config in profile: %s", servicePath.c_str());
-                                
-                                // Read the file directly to look for SRT URL
-                                std::ifstream file(servicePath);
-                                std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-                                file.close();
-                                
-                                // Look for "srt://" anywhere in the file
-                                size_t pos = content.find("srt://");
-                                if (pos != std::string::npos) {
-                                    // Find the quotes around the URL
-                                    size_t startQuote = content.rfind("\"", pos);
-                                    size_t endQuote = content.find("\"", pos);
-                                    
-                                    if (startQuote != std::string::npos && endQuote != std::string::npos) {
-                                        url = content.substr(startQuote + 1, endQuote - startQuote - 1);
-                                        blog(LOG_INFO, "Found SRT URL in profile: %s", url.c_str());
-                                        break;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
+            if (!profileUrl.empty()) {
+                url = profileUrl;
+                blog(LOG_INFO, "Found URL in profile service.json: %s", url.c_str());
             }
         }
     }
@@ -846,14 +1230,13 @@ void SrtlaRelay::setLocalPort(uint16_t port) {
         m_localPort = port;
         blog(LOG_INFO, "Local port set to: %d", m_localPort);
         
-        // Save settings immediately when port changes
-        saveSettings();
+        // Persisted with the next settings flush
+        markSettingsDirty();
         
         // If bidirectional sync is enabled, also update the OBS URL
         if (m_bidirectionalSync) {
             blog(LOG_INFO, "Bidirectional sync enabled - updating OBS URL with new port");
-            std::string newUrl = buildSRTURL(port, m_latency, m_streamId);
-            forceUpdateOBSStreamURL(newUrl);
+            syncToOBSService();
         }
     }
 }
@@ -864,14 +1247,13 @@ void SrtlaRelay::setUseFixedPort(bool enable) {
         m_useFixedPort = enable;
         blog(LOG_INFO, "Fixed port mode set to: %s", enable ? "enabled" : "disabled");
         
-        // Save settings immediately when fixed port setting changes
-        saveSettings();
+        // Persisted with the next settings flush
+        markSettingsDirty();
         
         // If bidirectional sync is enabled, also update the OBS URL
         if (m_bidirectionalSync && enable) {
             blog(LOG_INFO, "Updating OBS URL with fixed port mode");
-            std::string newUrl = buildSRTURL(m_localPort, m_latency, m_streamId);
-            forceUpdateOBSStreamURL(newUrl);
+            syncToOBSService();
         }
     }
 }
@@ -882,8 +1264,8 @@ void SrtlaRelay::setServer(const std::string& server) {
         m_server = server;
         blog(LOG_INFO, "SRTLA server set to: %s", server.c_str());
         
-        // Save settings immediately when server changes
-        saveSettings();
+        // Persisted with the next settings flush
+        markSettingsDirty();
         
         // No need to update OBS URL as the server address is only for SRTLA
     }
@@ -895,8 +1277,8 @@ void SrtlaRelay::setPort(uint16_t port) {
         m_port = port;
         blog(LOG_INFO, "SRTLA port set to: %d", port);
         
-        // Save settings immediately when port changes
-        saveSettings();
+        // Persisted with the next settings flush
+        markSettingsDirty();
         
         // No need to update OBS URL as this is the server port, not the local port
     }
@@ -908,14 +1290,13 @@ void SrtlaRelay::setStreamId(const std::string& streamId) {
         m_streamId = streamId;
         blog(LOG_INFO, "StreamID set to: %s", streamId.c_str());
         
-        // Save settings immediately when streamId changes
-        saveSettings();
+        // Persisted with the next settings flush
+        markSettingsDirty();
         
         // If bidirectional sync is enabled, also update the OBS URL
         if (m_bidirectionalSync) {
             blog(LOG_INFO, "Bidirectional sync enabled - updating OBS URL with new streamId");
-            std::string newUrl = buildSRTURL(m_localPort, m_latency, m_streamId);
-            forceUpdateOBSStreamURL(newUrl);
+            syncToOBSService();
         }
     }
 }
@@ -926,14 +1307,13 @@ void SrtlaRelay::setLatency(int latency) {
         m_latency = latency;
         blog(LOG_INFO, "Latency set to: %d ms", latency);
         
-        // Save settings immediately when latency changes
-        saveSettings();
+        // Persisted with the next settings flush
+        markSettingsDirty();
         
         // If bidirectional sync is enabled, also update the OBS URL
         if (m_bidirectionalSync) {
             blog(LOG_INFO, "Bidirectional sync enabled - updating OBS URL with new latency");
-            std::string newUrl = buildSRTURL(m_localPort, m_latency, m_streamId);
-            forceUpdateOBSStreamURL(newUrl);
+            syncToOBSService();
         }
     }
 }
@@ -944,8 +1324,146 @@ void SrtlaRelay::setAutoStart(bool enable) {
         m_autoStart = enable;
         blog(LOG_INFO, "Auto-start set to: %s", enable ? "enabled" : "disabled");
         
-        // Save settings immediately when auto-start changes
-        saveSettings();
+        // Persisted with the next settings flush
+        markSettingsDirty();
+    }
+}
+
+// Implementation of setUseNativeSender
+void SrtlaRelay::setUseNativeSender(bool enable) {
+    if (enable != m_useNativeSender) {
+        m_useNativeSender = enable;
+        blog(LOG_INFO, "Sender backend set to: %s", enable ? "built-in engine" : "srtla_send");
+        
+        // Persisted with the next settings flush
+        markSettingsDirty();
+        
+        // Takes effect on the next start of the sender
+    }
+}
+
+void SrtlaRelay::setSenderLogFile(bool enable) {
+    if (enable != m_senderLogFile) {
+        m_senderLogFile = enable;
+        blog(LOG_INFO, "srtla_send log file %s", enable ? "enabled: " SENDER_LOG_PATH : "disabled");
+        
+        // Persisted with the next settings flush
+        markSettingsDirty();
+        
+        // Takes effect on the next start of the sender
+    }
+}
+
+void SrtlaRelay::setSpreadServerAddresses(bool enable) {
+    if (enable != m_spreadServerAddresses) {
+        m_spreadServerAddresses = enable;
+        blog(LOG_INFO, "Spreading links across server addresses %s", enable ? "enabled" : "disabled");
+        markSettingsDirty();
+        
+        // Takes effect on the next start of the sender
+    }
+}
+
+void SrtlaRelay::setAdaptiveBitrate(bool enable) {
+    if (enable != m_adaptiveBitrate) {
+        m_adaptiveBitrate = enable;
+        blog(LOG_INFO, "Adaptive bitrate %s", enable ? "enabled" : "disabled");
+        markSettingsDirty();
+        
+        // Hand the encoder back its configured bitrate right away
+        if (!enable && m_encoderBaseKbps > 0 && m_bitrateController.appliedKbps() != m_encoderBaseKbps) {
+            applyEncoderBitrate(m_encoderBaseKbps);
+            m_bitrateController.reset(m_encoderBaseKbps);
+        }
+    }
+}
+
+void SrtlaRelay::setBitrateLimits(int floorKbps, int ceilingKbps) {
+    floorKbps = std::max(floorKbps, 100);
+    ceilingKbps = std::max(ceilingKbps, 0);
+    if (floorKbps == m_bitrateFloorKbps && ceilingKbps == m_bitrateCeilingKbps) {
+        return;
+    }
+    
+    m_bitrateFloorKbps = floorKbps;
+    m_bitrateCeilingKbps = ceilingKbps;
+    markSettingsDirty();
+    
+    // Apply to a running stream without losing the controller state
+    if (m_encoderBaseKbps > 0) {
+        BitrateControllerConfig config = m_bitrateController.config();
+        config.floorKbps = m_bitrateFloorKbps;
+        config.ceilingKbps = m_bitrateCeilingKbps > 0 ? m_bitrateCeilingKbps : m_encoderBaseKbps;
+        m_bitrateController.configure(config);
+    }
+}
+
+LinkQualityGate SrtlaRelay::linkQualityGate() const {
+    LinkQualityGate gate;
+    gate.enabled = m_linkGate;
+    gate.maxRttMs = m_linkGateMaxRttMs;
+    gate.maxLoss = m_linkGateMaxLossPct / 100.0;
+    return gate;
+}
+
+void SrtlaRelay::setLinkGate(bool enable, int maxRttMs, int maxLossPct) {
+    maxRttMs = std::max(maxRttMs, 50);
+    maxLossPct = std::min(std::max(maxLossPct, 0), 100);
+    if (enable == m_linkGate && maxRttMs == m_linkGateMaxRttMs && maxLossPct == m_linkGateMaxLossPct) {
+        return;
+    }
+    
+    m_linkGate = enable;
+    m_linkGateMaxRttMs = maxRttMs;
+    m_linkGateMaxLossPct = maxLossPct;
+    blog(LOG_INFO, "Link quality gate %s (max RTT %d ms, max loss %d%%)", enable ? "enabled" : "disabled",
+         maxRttMs, maxLossPct);
+    markSettingsDirty();
+    
+    // Applies to the running engine, links carrying data are kept
+    std::lock_guard<std::mutex> lock(m_senderMutex);
+    if (m_nativeSender) {
+        m_nativeSender->setQualityGate(linkQualityGate());
+    }
+}
+
+LinkSchedulerType SrtlaRelay::getLinkScheduler() const {
+    auto it = m_profileSchedulers.find(m_currentProfile);
+    return it != m_profileSchedulers.end() ? it->second : LinkSchedulerType::Window;
+}
+
+void SrtlaRelay::setLinkScheduler(LinkSchedulerType type) {
+    if (type == getLinkScheduler()) {
+        return;
+    }
+    
+    m_profileSchedulers[m_currentProfile] = type;
+    blog(LOG_INFO, "Link scheduler for profile '%s' set to: %s", m_currentProfile.c_str(), linkSchedulerName(type));
+    markSettingsDirty();
+    
+    // The engine switches strategy in place, no restart needed
+    std::lock_guard<std::mutex> lock(m_senderMutex);
+    if (m_nativeSender) {
+        m_nativeSender->setScheduler(type);
+    }
+}
+
+void SrtlaRelay::onProfileChanged() {
+    char *profile = obs_frontend_get_current_profile();
+    std::string name = profile ? profile : "";
+    bfree(profile);
+    
+    if (name == m_currentProfile) {
+        return;
+    }
+    m_currentProfile = name;
+    
+    LinkSchedulerType type = getLinkScheduler();
+    blog(LOG_INFO, "OBS profile changed to '%s', link scheduler: %s", name.c_str(), linkSchedulerName(type));
+    
+    std::lock_guard<std::mutex> lock(m_senderMutex);
+    if (m_nativeSender) {
+        m_nativeSender->setScheduler(type);
     }
 }
 
@@ -956,7 +1474,7 @@ void SrtlaRelay::setBidirectionalSync(bool enable) {
     
     // Save settings first
     if (enable != oldValue) {
-        saveSettings();
+        markSettingsDirty();
     }
     
     // If newly enabled, force fixed port mode and sync with OBS service
@@ -964,46 +1482,7 @@ void SrtlaRelay::setBidirectionalSync(bool enable) {
         blog(LOG_INFO, "Bidirectional sync enabled, syncing with OBS service");
         setUseFixedPort(true);
         
-        // Force URL update to ensure it's persisted
-        std::string newUrl = buildSRTURL(m_localPort, m_latency, m_streamId);
-        forceUpdateOBSStreamURL(newUrl);
-        
-        // First add detailed debug of all OBS internal settings
-        blog(LOG_INFO, "DEBUGGING ALL OBS SETTINGS STRUCTURES:");
-        
-        // Get the service
-        obs_service_t* service = obs_frontend_get_streaming_service();
-        if (service) {
-            // Get current service settings
-            obs_data_t* settings = obs_service_get_settings(service);
-            if (settings) {
-                // Log type and ID
-                blog(LOG_INFO, "Service type: %s, ID: %s", 
-                     obs_service_get_type(service), 
-                     obs_service_get_id(service));
-                     
-                // Save the settings to a JSON file for inspection
-                obs_data_save_json(settings, "/tmp/debug_service_settings.json");
-                blog(LOG_INFO, "Saved service settings to /tmp/debug_service_settings.json");
-                    
-                // Try finding potential URL fields 
-                const char* fields[] = {
-                    "url", "server", "address", "hostname", "host", "stream", 
-                    "srt_url", "service_url", "rtmp_url", "stream_url"
-                };
-                
-                for (const char* field : fields) {
-                    const char* value = obs_data_get_string(settings, field);
-                    if (value && strlen(value) > 0) {
-                        blog(LOG_INFO, "FOUND FIELD: %s = %s", field, value);
-                    }
-                }
-                
-                obs_data_release(settings);
-            }
-        }
-        
-        // Now try the normal sync
+        // Take over what OBS has, then push the merged settings back
         syncFromOBSService();
         syncToOBSService();
     }
@@ -1011,6 +1490,9 @@ void SrtlaRelay::setBidirectionalSync(bool enable) {
 
 // Sync settings from OBS service to SRTLA
 bool SrtlaRelay::syncFromOBSService() {
+    // Everything this sync changes is written out once, at the end
+    SettingsBatch batch(*this);
+    
     blog(LOG_INFO, "Syncing settings from OBS service to SRTLA");
     
     // Store old values to report changes
@@ -1112,75 +1594,8 @@ bool SrtlaRelay::syncFromOBSService() {
         // Force UI refresh by reapplying the service
         obs_frontend_set_streaming_service(service);
         
-        // Save changes to the service.json file to ensure persistence
-        const char* home = getenv("HOME");
-        if (home) {
-            char* currentProfile = obs_frontend_get_current_profile();
-            if (currentProfile) {
-                std::string servicePath = std::string(home) + 
-                                         "/.config/obs-studio/basic/profiles/" + 
-                                         currentProfile + 
-                                         "/service.json";
-                blog(LOG_INFO, "Updating service file directly: %s", servicePath.c_str());
-                
-                if (fs::exists(servicePath)) {
-                    // Try to load the service file
-                    obs_data_t* serviceConfig = obs_data_create_from_json_file(servicePath.c_str());
-                    if (serviceConfig) {
-                        // Get settings object
-                        obs_data_t* settings = obs_data_get_obj(serviceConfig, "settings");
-                        if (settings) {
-                            // Update server field - this is the primary field in OBS for stream URL
-                            obs_data_set_string(settings, "server", newUrl.c_str());
-                            // Also update url field for compatibility
-                            obs_data_set_string(settings, "url", newUrl.c_str());
-                            obs_data_release(settings);
-                        } else {
-                            // Create settings if doesn't exist
-                            settings = obs_data_create();
-                            obs_data_set_string(settings, "server", newUrl.c_str());
-                            obs_data_set_string(settings, "url", newUrl.c_str());
-                            obs_data_set_obj(serviceConfig, "settings", settings);
-                            obs_data_release(settings);
-                        }
-                        
-                        // Save changes back to file
-                        obs_data_save_json(serviceConfig, servicePath.c_str());
-                        obs_data_release(serviceConfig);
-                        blog(LOG_INFO, "Updated service.json file with new URL");
-                        
-                        // Force multiple refresh cycles to ensure changes appear immediately
-                        // First cycle - update the settings and reapply
-                        obs_data_t* refreshSettings = obs_service_get_settings(service);
-                        if (refreshSettings) {
-                            obs_data_set_string(refreshSettings, "server", newUrl.c_str());
-                            obs_data_set_string(refreshSettings, "url", newUrl.c_str());
-                            obs_service_update(service, refreshSettings);
-                            obs_data_release(refreshSettings);
-                        }
-                        
-                        // Force UI refresh by reapplying the service
-                        obs_frontend_set_streaming_service(service);
-                        
-                        // Add a delay to allow changes to propagate
-                        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-                        
-                        // Second cycle - get fresh settings and update again
-                        refreshSettings = obs_service_get_settings(service);
-                        if (refreshSettings) {
-                            obs_data_set_string(refreshSettings, "server", newUrl.c_str());
-                            obs_data_set_string(refreshSettings, "url", newUrl.c_str());
-                            obs_service_update(service, refreshSettings);
-                            obs_data_release(refreshSettings);
-                        }
-                        
-                        // Reapply the service again
-                        obs_frontend_set_streaming_service(service);
-                    }
-                }
-                bfree(currentProfile);
-            }
-        }
+        // Persist it in the profile's service.json as well
+        writeProfileServiceUrl(currentProfileDir(), newUrl);
         
         // Add notification for URL update
         std::string urlCopy = newUrl;
@@ -1262,9 +1677,9 @@ bool SrtlaRelay::syncFromOBSService() {
             if (port != m_localPort) {
                 blog(LOG_INFO, "Updating local port from %d to: %d", m_localPort, port);
                 
-                // Save port in settings immediately to ensure persistence
+                // Persist the port with the rest of this sync
                 m_localPort = port;
-                saveSettings();
+                markSettingsDirty();
                 
                 setLocalPort(port);
                 setUseFixedPort(true);
@@ -1276,10 +1691,8 @@ bool SrtlaRelay::syncFromOBSService() {
                     restartWithPort(port);
                 }
                 
-                // After setting port, immediately update OBS URL to reflect this change
-                // This ensures the port setting is properly propagated
-                std::string newUrl = buildSRTURL(port, m_latency, m_streamId);
-                forceUpdateOBSStreamURL(newUrl);
+                // Propagate the port to the OBS URL, queued with the other updates
+                syncToOBSService();
                 
             } else {
                 blog(LOG_INFO, "Local port already matches OBS URL port: %d", port);
@@ -1288,9 +1701,8 @@ bool SrtlaRelay::syncFromOBSService() {
             blog(LOG_WARNING, "Invalid port (0) in URL, not updating local port");
             
             // Even with invalid port, still update the URL with the current port
-            // to ensure service.json gets the right value
-            std::string newUrl = buildSRTURL(m_localPort, m_latency, m_streamId);
-            forceUpdateOBSStreamURL(newUrl);
+            // so service.json gets the right value
+            syncToOBSService();
         }
         
         // Update latency if specified in URL
@@ -1313,8 +1725,6 @@ bool SrtlaRelay::syncFromOBSService() {
         
         // Save the updated settings
         if (!changes.empty()) {
-            blog(LOG_INFO, "Saving updated SRTLA settings");
-            saveSettings();
             
             // Log the changes
             blog(LOG_INFO, "SRTLA settings updated to match service URL:");
@@ -1346,7 +1756,27 @@ bool SrtlaRelay::syncFromOBSService() {
 }
 
 // Sync settings from SRTLA to OBS service
-bool SrtlaRelay::syncToOBSService() {
+void SrtlaRelay::syncToOBSService() {
+    // Build the target URL from the settings as they are now, the job must
+    // not read settings the UI thread may be changing
+    std::string newUrl = buildSRTURL(m_localPort, m_latency, m_streamId);
+    bool switchToCustom = m_bidirectionalSync;
+    std::string profileDir = currentProfileDir();
+    
+    // Newer requests replace a queued one, only the latest settings matter.
+    // The worker only writes the profile's service.json; the live service
+    // belongs to the OBS UI, so it is updated on the Qt thread.
+    m_syncQueue->post([this, profileDir, newUrl, switchToCustom]() {
+        writeProfileServiceUrl(profileDir, newUrl);
+        QMetaObject::invokeMethod(QCoreApplication::instance(), [newUrl, switchToCustom]() {
+            if (g_srtlaRelay) {
+                g_srtlaRelay->applyServiceSync(newUrl, switchToCustom);
+            }
+        }, Qt::QueuedConnection);
+    }, "sync-to-obs");
+}
+
+bool SrtlaRelay::applyServiceSync(const std::string& newUrl, bool switchToCustom) {
     blog(LOG_INFO, "Syncing settings from SRTLA to OBS service");
     
     obs_service_t* service = obs_frontend_get_streaming_service();
@@ -1366,17 +1796,12 @@ bool SrtlaRelay::syncToOBSService() {
     // We want to sync to the Custom service
     bool isCustom = (strcmp(service_id, "rtmp_custom") == 0);
     
-    if (!isCustom && m_bidirectionalSync) {
+    if (!isCustom && switchToCustom) {
         blog(LOG_INFO, "Bidirectional sync enabled but not using Custom service. Switching to Custom...");
         
-        // Create a new Custom service with SRTLA settings
+        // Create a new Custom service with SRTLA settings, streamId is already included in the URL
         obs_data_t* customSettings = obs_data_create();
-        
-        // Build URL from our settings - this is the crucial part we need in the stream server URL
-        std::string url = buildSRTURL(m_localPort, m_latency, m_streamId);
-        
-        // Set URL (streamId is already included in the URL)
-        obs_data_set_string(customSettings, "url", url.c_str());
+        obs_data_set_string(customSettings, "url", newUrl.c_str());
         obs_data_set_string(customSettings, "key", ""); // Clear the key
         
         // Create a Custom service
@@ -1384,15 +1809,13 @@ bool SrtlaRelay::syncToOBSService() {
         if (customService) {
             // Set as the active service
             obs_frontend_set_streaming_service(customService);
-            blog(LOG_INFO, "Switched to Custom service with URL: %s", url.c_str());
+            obs_frontend_save_streaming_service();
+            blog(LOG_INFO, "Switched to Custom service with URL: %s", newUrl.c_str());
             
             // Add Qt notification for service switch
-            std::string urlCopy = url;
-            QMetaObject::invokeMethod(QCoreApplication::instance(), [urlCopy]() {
-                QMessageBox::information(nullptr, "Service Switched", 
-                                        QString("Switched to Custom service with URL: %1")
-                                        .arg(QString::fromStdString(urlCopy)));
-            }, Qt::QueuedConnection);
+            QMessageBox::information(nullptr, "Service Switched", 
+                                    QString("Switched to Custom service with URL: %1")
+                                    .arg(QString::fromStdString(newUrl)));
             
             // Release the service object
             obs_service_release(customService);
@@ -1419,18 +1842,6 @@ bool SrtlaRelay::syncToOBSService() {
     
     blog(LOG_INFO, "Current URL: %s, Key: %s", url.c_str(), key.c_str());
     
-    // Make sure we're using the correct port that matches our current relay
-    uint16_t usePort = m_localPort;
-    if (isRunning() && m_bidirectionalSync) {
-        blog(LOG_INFO, "Using the active relay port for URL: %d", usePort);
-    } else {
-        blog(LOG_INFO, "Using configured local port for URL: %d", usePort);
-    }
-    
-    // Build the new URL based on SRTLA settings to match OBS UI format exactly
-    std::string newUrl = buildSRTURL(usePort, m_latency, m_streamId);
-    blog(LOG_INFO, "Built new SRT URL for OBS sync: %s", newUrl.c_str());
-    
     // We're not using the key field for SRT anymore since streamId is in the URL
     std::string newKey = "";
     
@@ -1439,106 +1850,58 @@ bool SrtlaRelay::syncToOBSService() {
     // Only consider key changes if the current key isn't empty
     bool keyChanged = !key.empty();
     
-    if (urlChanged || keyChanged) {
-        blog(LOG_INFO, "Service settings need updating:");
-        if (urlChanged) blog(LOG_INFO, " - URL: %s → %s", url.c_str(), newUrl.c_str());
-        if (keyChanged) blog(LOG_INFO, " - Key: %s → %s", key.c_str(), newKey.c_str());
-        
-        // Debug: dump all settings before update
-        {
-            obs_data_t* beforeSettings = obs_service_get_settings(service);
-            obs_data_save_json(beforeSettings, "/tmp/service_before_update.json");
-            blog(LOG_INFO, "Saved service settings BEFORE update to /tmp/service_before_update.json");
-            obs_data_release(beforeSettings);
-        }
-        
-        // Simpler approach: Just update the specific field in the current service settings
-        blog(LOG_INFO, "Setting OBS Stream Server URL directly to: %s", newUrl.c_str());
-        
-        // Get the ID and name of the current service for info
-        const char* currentId = obs_service_get_id(service);
-        const char* currentName = obs_service_get_name(service);
-        blog(LOG_INFO, "Current service - ID: %s, Name: %s", 
-             currentId ? currentId : "NULL", 
-             currentName ? currentName : "NULL");
-        
-        // Get a copy of current settings to preserve other values
-        obs_data_t* currentSettings = obs_service_get_settings(service);
-        if (!currentSettings) {
-            blog(LOG_ERROR, "Could not get current service settings");
-            currentSettings = obs_data_create();
-        }
-        
-        // Update the server field - this is the primary field OBS uses for stream URL
-        obs_data_set_string(currentSettings, "server", newUrl.c_str());
-        
-        // Also update url field just in case both are used
-        obs_data_set_string(currentSettings, "url", newUrl.c_str());
-        
-        // Save settings to file for debugging
-        obs_data_save_json(currentSettings, "/tmp/updated_service_settings.json");
-        blog(LOG_INFO, "Saved updated service settings to /tmp/updated_service_settings.json");
-         
-        // Update the service with modified current settings
-        obs_service_update(service, currentSettings);
-        obs_data_release(currentSettings);
-        
-        // Force UI refresh by reapplying the service
-        obs_frontend_set_streaming_service(service);
-        
-        // Add a larger delay to ensure OBS processes the update
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        
-        // Debug: verify settings were applied
-        obs_data_t* verifySettings = obs_service_get_settings(service);
-        obs_data_save_json(verifySettings, "/tmp/service_after_update.json");
-        blog(LOG_INFO, "Saved service settings AFTER update to /tmp/service_after_update.json");
-        
-        // Check specific fields
-        const char* updatedUrl = obs_data_get_string(verifySettings, "url");
-        const char* updatedServer = obs_data_get_string(verifySettings, "server");
-        blog(LOG_INFO, "After update, URL field: %s", updatedUrl ? updatedUrl : "NULL");
-        blog(LOG_INFO, "After update, server field: %s", updatedServer ? updatedServer : "NULL");
-        obs_data_release(verifySettings);
-        
-        blog(LOG_INFO, "Successfully updated service URL to: %s", newUrl.c_str());
-        
-        // Log the changes
-        blog(LOG_INFO, "OBS service settings updated to match SRTLA:");
-        if (urlChanged) blog(LOG_INFO, "  URL: %s → %s", url.c_str(), newUrl.c_str());
-        if (keyChanged) blog(LOG_INFO, "  Key: %s → %s", key.c_str(), newKey.c_str());
-        
-        // Add Qt notification for service settings update
-        std::string urlCopy = url;
-        std::string newUrlCopy = newUrl;
-        
-        QMetaObject::invokeMethod(QCoreApplication::instance(), [urlCopy, newUrlCopy]() {
-            // Using a static timestamp in the lambda to prevent multiple notifications
-            static auto lastNotificationTime = std::chrono::steady_clock::now() - std::chrono::seconds(10);
-            auto now = std::chrono::steady_clock::now();
-            
-            // Only show notification if it's been more than 2 seconds since the last one
-            if (std::chrono::duration_cast<std::chrono::seconds>(now - lastNotificationTime).count() >= 2) {
-                QString message = "OBS Stream Server URL updated to match SRTLA settings:\n\n";
-                message += QString("Old: %1\n\n").arg(QString::fromStdString(urlCopy));
-                message += QString("New: %2\n\n").arg(QString::fromStdString(newUrlCopy));
-                message += "This change has been applied to OBS Settings → Stream → Server.";
-                
-                QMessageBox::information(nullptr, "OBS Stream URL Updated", message);
-                
-                // Update the timestamp
-                lastNotificationTime = now;
-            }
-        }, Qt::QueuedConnection);
-        
-        obs_data_release(settings);
-        return true;
-    } else {
+    if (!urlChanged && !keyChanged) {
         blog(LOG_INFO, "No changes needed, service settings already match SRTLA");
+        obs_data_release(settings);
+        return false;
     }
     
+    blog(LOG_INFO, "Service settings need updating:");
+    if (urlChanged) blog(LOG_INFO, " - URL: %s → %s", url.c_str(), newUrl.c_str());
+    if (keyChanged) blog(LOG_INFO, " - Key: %s → %s", key.c_str(), newKey.c_str());
+    
+    // Update the server field (the one OBS uses for the stream URL) and url, in
+    // place, so all other service values are preserved
+    obs_data_set_string(settings, "server", newUrl.c_str());
+    obs_data_set_string(settings, "url", newUrl.c_str());
+    obs_service_update(service, settings);
     obs_data_release(settings);
-    return false;
+    
+    // obs_service_update() applies synchronously, so the result can be checked right away
+    obs_data_t* verifySettings = obs_service_get_settings(service);
+    const char* updatedUrl = obs_data_get_string(verifySettings, "url");
+    bool applied = updatedUrl && newUrl == updatedUrl;
+    obs_data_release(verifySettings);
+    if (!applied) {
+        blog(LOG_WARNING, "OBS service did not take the new URL, still: %s", updatedUrl ? updatedUrl : "NULL");
+        return false;
+    }
+    
+    // Persist it like the Stream settings page does
+    obs_frontend_save_streaming_service();
+    
+    blog(LOG_INFO, "OBS service settings updated to match SRTLA:");
+    if (urlChanged) blog(LOG_INFO, "  URL: %s → %s", url.c_str(), newUrl.c_str());
+    if (keyChanged) blog(LOG_INFO, "  Key: %s → %s", key.c_str(), newKey.c_str());
+    
+    // Don't stack notifications when several syncs land close together
+    static auto lastNotificationTime = std::chrono::steady_clock::now() - std::chrono::seconds(10);
+    auto now = std::chrono::steady_clock::now();
+    
+    // Only show notification if it's been more than 2 seconds since the last one
+    if (std::chrono::duration_cast<std::chrono::seconds>(now - lastNotificationTime).count() >= 2) {
+        QString message = "OBS Stream Server URL updated to match SRTLA settings:\n\n";
+        message += QString("Old: %1\n\n").arg(QString::fromStdString(url));
+        message += QString("New: %2\n\n").arg(QString::fromStdString(newUrl));
+        message += "This change has been applied to OBS Settings → Stream → Server.";
+        
+        QMessageBox::information(nullptr, "OBS Stream URL Updated", message);
+        
+        // Update the timestamp
+        lastNotificationTime = now;
+    }
+    
+    return true;
 }
 
 void SrtlaRelay::setupProperties() {
@@ -1564,6 +1927,7 @@ void SrtlaRelay::serviceInfoChanged(void* data, calldata_t* cd) {
     // Our service is selected, update settings and start SRTLA
     obs_data_t* settings = obs_service_get_settings(service);
     if (settings) {
+        SrtlaRelay::SettingsBatch batch(*srtla);
         const char* server = obs_data_get_string(settings, "srtla_server");
         srtla->setServer(server ? server : "");
         
@@ -1572,8 +1936,6 @@ void SrtlaRelay::serviceInfoChanged(void* data, calldata_t* cd) {
         const char* streamId = obs_data_get_string(settings, "srtla_stream_id"); 
         srtla->setStreamId(streamId ? streamId : "");
         
-        srtla->saveSettings();
-        
         // Start SRTLA process
         srtla->startSrtlaProcess();
         
@@ -1619,10 +1981,9 @@ static bool apply_srtla_settings(obs_properties_t *props, obs_property_t *proper
     
     srtla->saveSettings();
     
-    // If already running, restart the process
+    // If already running, restart the process, without a gap where possible
     if (srtla->isRunning()) {
-        srtla->stopSrtlaProcess();
-        srtla->startSrtlaProcess();
+        srtla->restartWithPort(srtla->getLocalPort());
     }
     
     return true;
@@ -1665,10 +2026,10 @@ static void srtla_service_update(void *data, obs_data_t *settings) {
     
     extern SrtlaRelay *g_srtlaRelay; // Declare the global instance
     if (g_srtlaRelay) {
+        SrtlaRelay::SettingsBatch batch(*g_srtlaRelay);
         g_srtlaRelay->setServer(server);
         g_srtlaRelay->setPort(port);
         g_srtlaRelay->setStreamId(stream_id);
-        g_srtlaRelay->saveSettings();
     }
 }
 
@@ -2,10 +2,25 @@
 
 #include <obs-module.h>
 #include <obs-frontend-api.h>
+#include <atomic>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <map>
+#include <set>
 #include <vector>
 #include "network-monitor.h"
+#include "srtla-sender.h"
+#include "process-supervisor.h"
+#include "process-output.h"
+#include "dns-resolver.h"
+#include "job-queue.h"
+#include "profile-url-cache.h"
+#include "link-stats.h"
+#include "bitrate-controller.h"
+#include "link-trace.h"
+
+class QTimer;
 
 #define SRTLA_PLUGIN_NAME "SRTLA Relay"
 
@@ -20,10 +35,21 @@ public:
     // Initialize the plugin
     void init();
     
-    // Save plugin settings
-    // Returns true if the settings file already existed
+    // Write plugin settings now, crash-safe and only if they changed.
+    // Returns true if the settings file already existed.
+    // Setters only mark settings dirty; they are written after a short
+    // debounce, or at the end of the enclosing SettingsBatch.
     bool saveSettings();
     
+    // Groups several setter calls into a single settings write
+    class SettingsBatch {
+    public:
+        explicit SettingsBatch(SrtlaRelay& relay);
+        ~SettingsBatch();
+    private:
+        SrtlaRelay& m_relay;
+    };
+    
     // Load plugin settings
     void loadSettings();
     
@@ -49,9 +75,12 @@ public:
     int getLatency() const { return m_latency; }
     void setLatency(int latency);  // Implementation in cpp file
     
-    // Sync settings between OBS service and SRTLA relay
+    // Sync settings between OBS service and SRTLA relay. UI thread only.
+    // Syncing to OBS is queued and returns immediately: the profile file is
+    // written on a worker, then the live service is updated on the UI thread,
+    // and a notification follows if that changed anything.
     bool syncFromOBSService();
-    bool syncToOBSService();
+    void syncToOBSService();
     
     // Get the current OBS stream server URL
     std::string getCurrentOBSStreamServerURL();
@@ -60,14 +89,12 @@ public:
     bool extractSRTParamsFromURL(const std::string& url, uint16_t& port, int& latency, std::string& streamId);
     std::string buildSRTURL(uint16_t port, int latency, const std::string& streamId);
     
-    // Force update of OBS stream URL in all possible locations
-    bool forceUpdateOBSStreamURL(const std::string& newUrl);
-    
     // Start/stop SRTLA process
     bool startSrtlaProcess();
     void stopSrtlaProcess();
     
-    // Restart the process with a specific port
+    // Restart the process with a specific port. The built-in engine keeping
+    // its port restarts make-before-break, without a gap in the stream.
     bool restartWithPort(uint16_t port);
     
     // Handle network changes
@@ -87,8 +114,68 @@ public:
     bool isFixedPortEnabled() const { return m_useFixedPort; }
     void setUseFixedPort(bool enable);  // Implementation in cpp file
     
+    // Current interface table from the network monitor
+    std::vector<NetworkInterface> getNetworkInterfaces();
+    
+    // Take the latest statistics snapshot from the built-in engine and run
+    // the adaptive bitrate loop on it, and log what srtla_send printed since
+    // the last call. UI thread only, every SRTLA_STATS_INTERVAL_MS.
+    void pollLinkStats();
+    
+    // Snapshot taken by the last pollLinkStats(). UI thread only.
+    const SenderStats& readLinkStats() const { return *m_latestStats; }
+    
+    // What srtla_send reported on its output, as of the last pollLinkStats().
+    // UI thread only.
+    struct ExternalSenderStatus {
+        std::set<std::string> registeredLinks;  // source addresses
+        std::string lastEvent;
+    };
+    const ExternalSenderStatus& readExternalSenderStatus() const { return m_externalStatus; }
+    
+    // Also keep srtla_send's output in a size-limited, rotated log file
+    bool isSenderLogFileEnabled() const { return m_senderLogFile; }
+    void setSenderLogFile(bool enable);  // Implementation in cpp file
+    
+    // Get/set adaptive encoder bitrate control
+    bool isAdaptiveBitrateEnabled() const { return m_adaptiveBitrate; }
+    void setAdaptiveBitrate(bool enable);  // Implementation in cpp file
+    int getBitrateFloor() const { return m_bitrateFloorKbps; }
+    int getBitrateCeiling() const { return m_bitrateCeilingKbps; }
+    void setBitrateLimits(int floorKbps, int ceilingKbps);  // 0 ceiling = encoder's configured bitrate
+    
+    // Bitrate the adaptive loop last gave the encoder, -1 while it is inactive
+    int getAdaptiveBitrateKbps() const {
+        return (m_adaptiveBitrate && m_encoderBaseKbps > 0) ? m_bitrateController.appliedKbps() : -1;
+    }
+    
+    // Streaming output lifecycle, used to capture and restore the encoder bitrate
+    void onStreamingStarted();
+    void onStreamingStopped();
+    
     // Get IP list file path
     std::string getIpListPath() const { return m_ipListPath; }
+    
+    // Use the built-in bonding engine instead of the external srtla_send binary
+    bool isNativeSenderEnabled() const { return m_useNativeSender; }
+    void setUseNativeSender(bool enable);  // Implementation in cpp file
+    
+    // Balance links across all addresses the server name resolves to
+    bool isSpreadServerAddressesEnabled() const { return m_spreadServerAddresses; }
+    void setSpreadServerAddresses(bool enable);  // Implementation in cpp file
+    
+    // Probe new links and demote degraded ones (built-in engine only)
+    bool isLinkGateEnabled() const { return m_linkGate; }
+    int getLinkGateMaxRtt() const { return m_linkGateMaxRttMs; }
+    int getLinkGateMaxLoss() const { return m_linkGateMaxLossPct; }
+    void setLinkGate(bool enable, int maxRttMs, int maxLossPct);  // Implementation in cpp file
+    
+    // Get/set the link scheduling strategy of the active OBS profile
+    LinkSchedulerType getLinkScheduler() const;
+    void setLinkScheduler(LinkSchedulerType type);  // Implementation in cpp file
+    
+    // Pick up per-profile settings after OBS switched profiles
+    void onProfileChanged();
 
 private:
     // Settings
@@ -110,11 +197,117 @@ private:
     std::string m_ipListPath;
     
     // Process handling
-    bool m_processRunning;
-    int m_processId;
+    // Tracks the supervisor state: true while a sender is alive or being restarted
+    std::atomic<bool> m_processRunning;
+    std::atomic<int> m_processId;
+    
+    // Supervises the external srtla_send process
+    std::unique_ptr<ProcessSupervisor> m_supervisor;
+    
+    // srtla_send's stdout/stderr, filled by the supervisor thread and drained
+    // by pollLinkStats() only, which also owns m_externalStatus
+    ProcessOutput m_senderOutput;
+    uint64_t m_senderOutputDropped;
+    int m_externalStatusPid;
+    ExternalSenderStatus m_externalStatus;
+    bool m_senderLogFile;
+    void drainSenderOutput();
+    
+    // Built-in bonding engine, used instead of srtla_send when enabled
+    bool m_useNativeSender;
+    std::unique_ptr<SrtlaSender> m_nativeSender;
+    std::unique_ptr<SrtlaSender> m_retiredSender;  // taken over by m_nativeSender, freed after it
+    std::string m_senderServer;                     // server m_nativeSender bonds to
+    uint16_t m_senderServerPort;
+    bool m_spreadServerAddresses;
+    bool m_linkGate;
+    int m_linkGateMaxRttMs;
+    int m_linkGateMaxLossPct;
+    LinkQualityGate linkQualityGate() const;
+    
+    // A built-in engine configured from the current settings, not started
+    std::unique_ptr<SrtlaSender> createNativeSender();
+    
+    // Replace the running built-in engine by a new one on the same local
+    // port that takes over once registered: in the running SRTLA group, or
+    // in a new one if the server changed. False if that is not possible.
+    bool warmRestart();
+    
+    // Serial worker for OBS service updates
+    std::unique_ptr<JobQueue> m_syncQueue;
+    
+    // Bring the live OBS service in line with newUrl. Qt UI thread only,
+    // the frontend API is not thread-safe.
+    bool applyServiceSync(const std::string& newUrl, bool switchToCustom);
+    
+    // Background resolution of the server name
+    std::unique_ptr<DnsResolver> m_resolver;
+    
+    // Launch srtla_send against serverIp. Call with m_senderMutex held.
+    bool launchExternalSender(const std::string& serverIp);
+    
+    // DNS result for the server name, from the resolver thread
+    void onServerResolved(const std::vector<std::string>& addresses);
+    
+    // Stream URL of each profile's service.json, by profile directory
+    std::unique_ptr<ProfileUrlCache> m_profileUrls;
+    std::mutex m_profileUrlMutex;
+    
+    // Directory of the active OBS profile, empty if unknown
+    std::string currentProfileDir() const;
+    
+    // Set the stream URL in profileDir's service.json. Rewrites the file
+    // atomically, and only if the URL differs. Safe off the UI thread.
+    bool writeProfileServiceUrl(const std::string& profileDir, const std::string& newUrl);
+    
+    // Link scheduler per OBS profile name, and the active profile
+    std::map<std::string, LinkSchedulerType> m_profileSchedulers;
+    std::string m_currentProfile;
+    
+    // Per-link statistics published by the built-in engine
+    SenderStatsBuffer m_linkStats;
+    const SenderStats* m_latestStats;
+    
+    // Link trace of the current stream, when recording one (SRTLA_TRACE_RECORD)
+    std::unique_ptr<LinkTraceRecorder> m_traceRecorder;
+    std::string m_traceRecordPath;
+    std::mutex m_traceMutex;
+    
+    // Adaptive encoder bitrate
+    bool m_adaptiveBitrate;
+    int m_bitrateFloorKbps;
+    int m_bitrateCeilingKbps;
+    BitrateController m_bitrateController;
+    int m_encoderBaseKbps;  // configured encoder bitrate at stream start, -1 if unknown
+    
+    // Set the streaming video encoder's bitrate
+    bool applyEncoderBitrate(int kbps);
+    
+    // Settings persistence
+    std::atomic<bool> m_settingsDirty;
+    std::atomic<int> m_settingsBatchDepth;
+    QTimer* m_settingsTimer;          // debounce, lives on the UI thread
+    std::mutex m_settingsMutex;       // serializes writes
+    std::string m_savedSettingsJson;  // what the settings file holds
+    void markSettingsDirty();
+    void flushSettings();
+    
+    // Guards the sender and link set against the network monitor thread
+    std::mutex m_senderMutex;
+    
+    // Link IPs last handed to the sender, used to compute add/remove deltas
+    std::set<std::string> m_linkIps;
+    std::map<std::string, int> m_linkInterfaces;  // link IP -> interface index its socket is pinned to
+    
+    // Links for all active, non-loopback interfaces; cellular modems,
+    // tethered phones and tunnels get a lower priority
+    std::vector<LinkConfig> collectLinks(const std::vector<NetworkInterface>& interfaces) const;
+    
+    // Source IPs of all active, non-loopback interfaces
+    std::vector<std::string> collectLinkIps(const std::vector<NetworkInterface>& interfaces) const;
     
-    // Kill SRTLA process if running
-    void killSrtlaProcess();
+    // Atomically rewrite the IP bank file read by srtla_send
+    bool writeIpBankFile(const std::vector<std::string>& ips);
     
     // Setup UI properties
     void setupProperties();
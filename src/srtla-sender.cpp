@@ -0,0 +1,1400 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Native SRTLA bonding engine
+ *
+ * Implements the sender side of the SRTLA protocol in-process, so the
+ * plugin does not need to launch an external srtla_send binary.
+ *
+ * License: GPL-3.0
+ */
+
+#include "srtla-sender.h"
+#include "srtla-log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <netinet/udp.h>
+
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+static constexpr int MAX_EPOLL_EVENTS = 16;
+static constexpr int SOCKET_BUFFER_SIZE = 4 * 1024 * 1024;
+
+// Kernel limits for one UDP GSO send
+static constexpr size_t GSO_MAX_SEGMENTS = 64;
+static constexpr size_t GSO_MAX_BYTES = 65000;
+
+// Dual-stack interfaces move their traffic to the other address family only
+// when its keepalive RTT is lower by this much, so they do not flap
+static constexpr double FAMILY_SWITCH_MIN_MS = 5.0;
+static constexpr double FAMILY_SWITCH_RATIO = 0.2;
+
+static bool parseAddr(const std::string& ip, uint16_t port, sockaddr_storage& out) {
+    memset(&out, 0, sizeof(out));
+    auto* v4 = (sockaddr_in*)&out;
+    if (inet_pton(AF_INET, ip.c_str(), &v4->sin_addr) == 1) {
+        v4->sin_family = AF_INET;
+        v4->sin_port = htons(port);
+        return true;
+    }
+    auto* v6 = (sockaddr_in6*)&out;
+    if (inet_pton(AF_INET6, ip.c_str(), &v6->sin6_addr) == 1) {
+        v6->sin6_family = AF_INET6;
+        v6->sin6_port = htons(port);
+        return true;
+    }
+    return false;
+}
+
+static socklen_t addrLen(const sockaddr_storage& addr) {
+    return addr.ss_family == AF_INET6 ? sizeof(sockaddr_in6) : sizeof(sockaddr_in);
+}
+
+static bool sameAddr(const sockaddr_storage& a, const sockaddr_storage& b) {
+    if (a.ss_family != b.ss_family) return false;
+    if (a.ss_family == AF_INET6) {
+        const auto& x = (const sockaddr_in6&)a;
+        const auto& y = (const sockaddr_in6&)b;
+        return memcmp(&x.sin6_addr, &y.sin6_addr, sizeof(x.sin6_addr)) == 0 && x.sin6_port == y.sin6_port;
+    }
+    const auto& x = (const sockaddr_in&)a;
+    const auto& y = (const sockaddr_in&)b;
+    return x.sin_addr.s_addr == y.sin_addr.s_addr && x.sin_port == y.sin_port;
+}
+
+static std::string formatAddr(const sockaddr_storage& addr) {
+    char ip[INET6_ADDRSTRLEN];
+    if (addr.ss_family == AF_INET6) {
+        inet_ntop(AF_INET6, &((const sockaddr_in6&)addr).sin6_addr, ip, sizeof(ip));
+        return "[" + std::string(ip) + "]";
+    }
+    inet_ntop(AF_INET, &((const sockaddr_in&)addr).sin_addr, ip, sizeof(ip));
+    return ip;
+}
+
+// Send time carried by keepalives, wraps every 71 minutes
+static uint32_t keepaliveClockUs(std::chrono::steady_clock::time_point now) {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+}
+
+SrtlaSender::SrtlaSender()
+    : m_localPort(0),
+      m_serverPort(0),
+      m_spreadServers(false),
+      m_localFd(-1),
+      m_wakeFd(-1),
+      m_epollFd(-1),
+      m_scheduler(createLinkScheduler(LinkSchedulerType::Window)),
+      m_pendingScheduler(-1),
+      m_hasClient(false),
+      m_gsoEnabled(true),
+      m_rxPackets(0),
+      m_rxSyscalls(0),
+      m_txPackets(0),
+      m_txSyscalls(0),
+      m_lastRxPackets(0),
+      m_lastRxSyscalls(0),
+      m_lastTxPackets(0),
+      m_lastTxSyscalls(0),
+      m_groupState(GroupState::Unregistered),
+      m_reg1Attempts(0),
+      m_hasRegisteredId(false),
+      m_previous(nullptr),
+      m_warmFd(-1),
+      m_warmJoin(false),
+      m_takingOver(false),
+      m_serversChanged(false),
+      m_gateChanged(false),
+      m_linksOpened(0),
+      m_statsBuffer(nullptr),
+      m_statsGeneration(0),
+      m_running(false),
+      m_stopRequested(false) {
+    memset(&m_clientAddr, 0, sizeof(m_clientAddr));
+    memset(m_srtlaId, 0, sizeof(m_srtlaId));
+    memset(m_registeredId, 0, sizeof(m_registeredId));
+    memset(m_warmId, 0, sizeof(m_warmId));
+
+    m_rxBuffers.resize(IO_BATCH * SRTLA_MTU);
+    memset(m_rxMsgs, 0, sizeof(m_rxMsgs));
+    memset(m_txMsgs, 0, sizeof(m_txMsgs));
+    for (size_t i = 0; i < IO_BATCH; i++) {
+        m_rxIov[i].iov_base = &m_rxBuffers[i * SRTLA_MTU];
+        m_rxIov[i].iov_len = SRTLA_MTU;
+        m_rxMsgs[i].msg_hdr.msg_iov = &m_rxIov[i];
+        m_rxMsgs[i].msg_hdr.msg_iovlen = 1;
+        m_rxMsgs[i].msg_hdr.msg_name = &m_rxAddrs[i];
+    }
+}
+
+SrtlaSender::~SrtlaSender() {
+    stop();
+}
+
+bool SrtlaSender::start(uint16_t localPort, const std::vector<std::string>& serverIps, uint16_t serverPort,
+                        const std::vector<LinkConfig>& links) {
+    if (m_running) {
+        srtla_log(SRTLA_LOG_WARNING, "SRTLA sender already running");
+        return false;
+    }
+
+    m_serverPort = serverPort;
+    setServers(serverIps);
+    if (m_serverAddrs.empty() && !serverIps.empty()) {
+        srtla_log(SRTLA_LOG_ERROR, "No usable SRTLA server address: %s", serverIps[0].c_str());
+        return false;
+    }
+
+    // Local socket that receives the SRT stream from OBS, unless it is
+    // shared with the engine being taken over
+    if (m_warmFd >= 0) {
+        m_localFd = m_warmFd;
+        m_warmFd = -1;
+        m_localPort = localPort;
+    } else {
+        m_localFd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (m_localFd < 0) {
+            srtla_log(SRTLA_LOG_ERROR, "Failed to create local SRT socket: %s", strerror(errno));
+            return false;
+        }
+
+        int bufSize = SOCKET_BUFFER_SIZE;
+        setsockopt(m_localFd, SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize));
+        setsockopt(m_localFd, SOL_SOCKET, SO_SNDBUF, &bufSize, sizeof(bufSize));
+
+        sockaddr_in listenAddr;
+        memset(&listenAddr, 0, sizeof(listenAddr));
+        listenAddr.sin_family = AF_INET;
+        // Only OBS on this machine may feed the stream
+        listenAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        listenAddr.sin_port = htons(localPort);
+        if (bind(m_localFd, (sockaddr*)&listenAddr, sizeof(listenAddr)) < 0) {
+            srtla_log(SRTLA_LOG_ERROR, "Failed to bind local SRT port %d: %s", localPort, strerror(errno));
+            close(m_localFd);
+            m_localFd = -1;
+            return false;
+        }
+        m_localPort = localPort;
+    }
+
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_wakeFd < 0 || m_epollFd < 0) {
+        srtla_log(SRTLA_LOG_ERROR, "Failed to create engine event descriptors: %s", strerror(errno));
+        stop();
+        return false;
+    }
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    if (m_localFd >= 0 && !m_previous) {
+        ev.data.ptr = &m_localFd;
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_localFd, &ev);
+    }
+    ev.data.ptr = &m_wakeFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &ev);
+
+    if (m_previous && m_warmJoin) {
+        // Links join the group of the engine being taken over
+        memcpy(m_srtlaId, m_warmId, SRTLA_ID_LEN);
+        m_groupState = GroupState::Registered;
+        m_handoverStartedAt = Clock::now();
+    } else {
+        // Random first half of the group ID, the receiver fills in the second half
+        std::random_device rd;
+        std::independent_bits_engine<std::mt19937, 8, uint16_t> bytes(rd());
+        for (size_t i = 0; i < SRTLA_ID_LEN / 2; i++) {
+            m_srtlaId[i] = (uint8_t)bytes();
+        }
+        memset(m_srtlaId + SRTLA_ID_LEN / 2, 0, SRTLA_ID_LEN / 2);
+        m_groupState = GroupState::Unregistered;
+    }
+    setRegisteredGroup(m_groupState == GroupState::Registered);
+    m_reg1Attempts = 0;
+    m_hasClient = false;
+    m_startedAt = Clock::now();
+    m_linksOpened = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(m_commandMutex);
+        m_commands.clear();
+        for (const auto& link : links) {
+            m_commands.push_back({true, link});
+        }
+    }
+
+    m_stopRequested = false;
+    m_running = true;
+    m_thread = std::thread(&SrtlaSender::run, this);
+
+    const char* server = serverIps.empty() ? "(resolving)" : serverIps[0].c_str();
+    if (m_previous && m_warmJoin) {
+        srtla_log(SRTLA_LOG_INFO, "SRTLA sender restarting on port %d, joining the running group at %s:%d "
+                  "over %zu link(s)", localPort, server, serverPort, links.size());
+    } else if (m_previous) {
+        srtla_log(SRTLA_LOG_INFO, "SRTLA sender restarting on port %d, registering a new group at %s:%d "
+                  "over %zu link(s)", localPort, server, serverPort, links.size());
+    } else {
+        srtla_log(SRTLA_LOG_INFO, "SRTLA sender listening on port %d, bonding to %s:%d over %zu link(s)",
+                  localPort, server, serverPort, links.size());
+    }
+    if (m_impairment) {
+        srtla_log(SRTLA_LOG_INFO, "SRTLA link impairment emulation is active");
+    }
+    return true;
+}
+
+bool SrtlaSender::startWarm(SrtlaSender& previous, const std::vector<std::string>& serverIps, uint16_t serverPort,
+                            const std::vector<LinkConfig>& links, bool joinGroup) {
+    if (m_running || !previous.m_running || previous.m_localFd < 0) {
+        return false;
+    }
+    // One handover at a time, previous must own the socket alone
+    if (previous.m_takingOver || (joinGroup && !previous.registeredGroup(m_warmId))) {
+        return false;
+    }
+
+    // A second descriptor of the same socket: nothing queued in it is lost
+    // when previous closes its own
+    m_warmFd = fcntl(previous.m_localFd, F_DUPFD_CLOEXEC, 0);
+    if (m_warmFd < 0) {
+        srtla_log(SRTLA_LOG_WARNING, "Failed to share the local SRT socket: %s", strerror(errno));
+        return false;
+    }
+
+    m_previous = &previous;
+    m_warmJoin = joinGroup;
+    m_takingOver = true;
+    if (!start(previous.m_localPort, serverIps, serverPort, links)) {
+        if (m_warmFd >= 0) close(m_warmFd);
+        m_warmFd = -1;
+        m_previous = nullptr;
+        m_warmJoin = false;
+        m_takingOver = false;
+        return false;
+    }
+    return true;
+}
+
+bool SrtlaSender::registeredGroup(uint8_t id[SRTLA_ID_LEN]) const {
+    std::lock_guard<std::mutex> lock(m_groupMutex);
+    if (!m_hasRegisteredId) return false;
+    memcpy(id, m_registeredId, SRTLA_ID_LEN);
+    return true;
+}
+
+void SrtlaSender::setRegisteredGroup(bool registered) {
+    std::lock_guard<std::mutex> lock(m_groupMutex);
+    m_hasRegisteredId = registered;
+    if (registered) memcpy(m_registeredId, m_srtlaId, SRTLA_ID_LEN);
+}
+
+void SrtlaSender::checkHandover(Clock::time_point now) {
+    size_t connected = 0;
+    size_t ready = 0;
+    for (auto& link : m_links) {
+        if (!link->hasServer) continue;
+        connected++;
+        ready += link->registered && link->admitted;
+    }
+
+    // Wait a little for stragglers, but not forever for a dead link
+    auto elapsed = now - m_handoverStartedAt;
+    if ((connected == 0 || ready < connected) &&
+        (ready == 0 || elapsed < std::chrono::milliseconds(SRTLA_HANDOVER_SETTLE_MS)) &&
+        elapsed < std::chrono::milliseconds(SRTLA_HANDOVER_TIMEOUT_MS)) {
+        return;
+    }
+    if (ready == 0) {
+        srtla_log(SRTLA_LOG_WARNING, "SRTLA sender taking over with no link registered yet");
+    }
+    completeHandover(now);
+}
+
+void SrtlaSender::completeHandover(Clock::time_point now) {
+    // Once its thread is joined, the previous engine no longer reads the
+    // shared socket; what arrived meanwhile is still queued in it
+    m_previous->stop();
+    if (!m_hasClient && m_previous->m_hasClient) {
+        m_clientAddr = m_previous->m_clientAddr;
+        m_hasClient = true;
+    }
+    m_statsGeneration = m_previous->m_statsGeneration;
+    m_previous = nullptr;
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = &m_localFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_localFd, &ev);
+    m_lastStatsAt = now;
+    m_takingOver = false;
+
+    srtla_log(SRTLA_LOG_INFO, "SRTLA sender took over the stream after %lld ms",
+              (long long)std::chrono::duration_cast<std::chrono::milliseconds>(now - m_handoverStartedAt).count());
+}
+
+void SrtlaSender::stop() {
+    if (m_thread.joinable()) {
+        m_stopRequested = true;
+        wake();
+        m_thread.join();
+    }
+
+    // An unfinished takeover leaves the previous engine forwarding
+    if (m_previous) {
+        m_previous->stop();
+    }
+
+    for (auto& link : m_links) {
+        closeLink(*link);
+    }
+    m_links.clear();
+    m_activeLinks.clear();
+    m_schedLinks.clear();
+
+    if (m_epollFd >= 0) close(m_epollFd);
+    if (m_wakeFd >= 0) close(m_wakeFd);
+    if (m_localFd >= 0) close(m_localFd);
+    m_epollFd = -1;
+    m_wakeFd = -1;
+    m_localFd = -1;
+    m_previous = nullptr;
+    m_warmJoin = false;
+    m_takingOver = false;
+    setRegisteredGroup(false);
+
+    if (m_running) {
+        srtla_log(SRTLA_LOG_INFO, "SRTLA sender on port %d stopped", m_localPort);
+    }
+    m_running = false;
+}
+
+void SrtlaSender::addLink(const LinkConfig& link) {
+    postCommand(true, link);
+}
+
+void SrtlaSender::removeLink(const std::string& sourceIp) {
+    LinkConfig link;
+    link.sourceIp = sourceIp;
+    postCommand(false, link);
+}
+
+void SrtlaSender::setServerAddresses(const std::vector<std::string>& serverIps) {
+    {
+        std::lock_guard<std::mutex> lock(m_commandMutex);
+        m_pendingServers = serverIps;
+        m_serversChanged = true;
+    }
+    wake();
+}
+
+void SrtlaSender::setScheduler(LinkSchedulerType type) {
+    m_pendingScheduler = (int)type;
+    wake();
+}
+
+void SrtlaSender::setQualityGate(const LinkQualityGate& gate) {
+    {
+        std::lock_guard<std::mutex> lock(m_commandMutex);
+        m_pendingGate = gate;
+        m_pendingGate.probes = std::max(gate.probes, 1);
+        m_gateChanged = true;
+    }
+    wake();
+}
+
+void SrtlaSender::postCommand(bool add, const LinkConfig& config) {
+    {
+        std::lock_guard<std::mutex> lock(m_commandMutex);
+        m_commands.push_back({add, config});
+    }
+    wake();
+}
+
+void SrtlaSender::wake() {
+    if (m_wakeFd >= 0) {
+        uint64_t one = 1;
+        ssize_t ret = write(m_wakeFd, &one, sizeof(one));
+        (void)ret;
+    }
+}
+
+void SrtlaSender::run() {
+    uint8_t buf[SRTLA_MTU];
+    epoll_event events[MAX_EPOLL_EVENTS];
+    Clock::time_point nextHousekeeping = Clock::now();
+    Clock::time_point nextStats = nextHousekeeping;
+    m_lastStatsAt = nextHousekeeping;
+
+    while (!m_stopRequested) {
+        Clock::time_point now = Clock::now();
+        if (now >= nextHousekeeping) {
+            housekeeping(now);
+            nextHousekeeping = now + std::chrono::milliseconds(SRTLA_HOUSEKEEPING_MS);
+        }
+        if (m_previous) {
+            checkHandover(now);
+        }
+        // Until the handover, the previous engine publishes its statistics
+        if (m_statsBuffer && !m_previous && now >= nextStats) {
+            publishStats(now);
+            nextStats = now + std::chrono::milliseconds(SRTLA_STATS_INTERVAL_MS);
+        }
+
+        Clock::time_point nextDeadline = m_statsBuffer ? std::min(nextHousekeeping, nextStats) : nextHousekeeping;
+        if (m_gate.enabled) {
+            nextDeadline = std::min(nextDeadline, probeLinks(now));
+        }
+        if (m_previous) {
+            nextDeadline = std::min(nextDeadline, now + std::chrono::milliseconds(SRTLA_PROBE_INTERVAL_MS));
+        }
+        if (m_impairment) {
+            updateImpairments(now);
+            nextDeadline = std::min(nextDeadline, releaseDelayed(now));
+        }
+        int timeout = (int)std::chrono::ceil<std::chrono::milliseconds>(nextDeadline - now).count();
+        int count = epoll_wait(m_epollFd, events, MAX_EPOLL_EVENTS, std::max(timeout, 0));
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            srtla_log(SRTLA_LOG_ERROR, "SRTLA engine epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        bool linksChanged = false;
+        for (int i = 0; i < count; i++) {
+            void* tag = events[i].data.ptr;
+
+            if (tag == &m_wakeFd) {
+                uint64_t value;
+                ssize_t ret = read(m_wakeFd, &value, sizeof(value));
+                (void)ret;
+                linksChanged = true;
+            } else if (tag == &m_localFd) {
+                readLocalSocket();
+            } else {
+                Link* link = static_cast<Link*>(tag);
+                while (true) {
+                    ssize_t n = recv(link->fd, buf, sizeof(buf), 0);
+                    if (n <= 0) break;
+                    if (link->impairment && link->impairment->params().blackout) continue;
+                    handleLinkPacket(*link, buf, (size_t)n);
+                }
+            }
+        }
+
+        // Links may only be destroyed once no event in this batch refers to them
+        if (linksChanged) {
+            applyLinkCommands();
+        }
+    }
+
+    // Leave an empty snapshot behind so readers do not show stale links
+    if (m_statsBuffer && !m_previous) {
+        SenderStats& stats = m_statsBuffer->back();
+        stats.links.clear();
+        stats.generation = ++m_statsGeneration;
+        m_statsBuffer->publish();
+    }
+}
+
+void SrtlaSender::publishStats(Clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - m_lastStatsAt).count();
+    m_lastStatsAt = now;
+
+    SenderStats& stats = m_statsBuffer->back();
+    stats.links.resize(m_links.size());
+    for (size_t i = 0; i < m_links.size(); i++) {
+        Link& link = *m_links[i];
+        LinkStats& out = stats.links[i];
+
+        out.sourceIp = link.sourceIp;
+        out.interfaceName = link.interfaceName;
+        out.pinned = link.pinned;
+        out.ipv6 = link.family == AF_INET6;
+        out.standby = link.standby;
+        out.registered = link.registered;
+        out.probing = link.registered && !link.admitted;
+        out.bytesSent = link.bytesSent;
+        out.packetsSent = link.packetsSent;
+        out.naks = link.naks;
+        out.rttMs = link.srttMs;
+        out.keepaliveRttMs = link.keepaliveRttMs;
+        out.window = link.window / SRTLA_WINDOW_MULT;
+        out.inFlight = link.inFlight;
+        out.lastSeenMs = link.lastReceived == Clock::time_point() ? -1 :
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - link.lastReceived).count();
+        out.impairedDrops = link.impairment ? link.impairment->lost() + link.impairment->queueDrops() : 0;
+
+        if (elapsed > 0.0) {
+            out.packetsPerSec = (link.packetsSent - link.lastPacketsSent) / elapsed;
+            out.bitsPerSec = (link.bytesSent - link.lastBytesSent) * 8.0 / elapsed;
+            out.naksPerSec = (link.naks - link.lastNaks) / elapsed;
+        }
+        link.lastPacketsSent = link.packetsSent;
+        link.lastBytesSent = link.bytesSent;
+        link.lastNaks = link.naks;
+    }
+    uint64_t rxSyscalls = m_rxSyscalls - m_lastRxSyscalls;
+    uint64_t txSyscalls = m_txSyscalls - m_lastTxSyscalls;
+    stats.rxPacketsPerSyscall = rxSyscalls ? (double)(m_rxPackets - m_lastRxPackets) / rxSyscalls : 0.0;
+    stats.txPacketsPerSyscall = txSyscalls ? (double)(m_txPackets - m_lastTxPackets) / txSyscalls : 0.0;
+    stats.gso = m_gsoEnabled;
+    m_lastRxPackets = m_rxPackets;
+    m_lastRxSyscalls = m_rxSyscalls;
+    m_lastTxPackets = m_txPackets;
+    m_lastTxSyscalls = m_txSyscalls;
+
+    stats.generation = ++m_statsGeneration;
+    m_statsBuffer->publish();
+}
+
+// Pin a link socket to the interface owning its address
+static bool pinToInterface(int fd, int family, const LinkConfig& config, std::string& interfaceName) {
+    char name[IF_NAMESIZE] = {0};
+    if (!if_indextoname((unsigned)config.ifIndex, name)) {
+        srtla_log(SRTLA_LOG_WARNING, "Link via %s: interface %d is gone, not pinning it",
+                  config.sourceIp.c_str(), config.ifIndex);
+        return false;
+    }
+    if (!config.interfaceName.empty() && config.interfaceName != name) {
+        srtla_log(SRTLA_LOG_WARNING, "Link via %s: interface %d is now %s, not %s; not pinning it",
+                  config.sourceIp.c_str(), config.ifIndex, name, config.interfaceName.c_str());
+        return false;
+    }
+    interfaceName = name;
+
+    // SO_BINDTODEVICE restricts both sending and receiving to the interface.
+    // It needs CAP_NET_RAW before Linux 5.7; IP_UNICAST_IF only steers
+    // outgoing packets but needs no privileges.
+    if (setsockopt(fd, SOL_SOCKET, SO_BINDTODEVICE, name, (socklen_t)strlen(name)) == 0) {
+        return true;
+    }
+    int bindErrno = errno;
+    uint32_t index = htonl((uint32_t)config.ifIndex);
+    int ok = family == AF_INET6 ? setsockopt(fd, IPPROTO_IPV6, IPV6_UNICAST_IF, &index, sizeof(index))
+                                : setsockopt(fd, IPPROTO_IP, IP_UNICAST_IF, &index, sizeof(index));
+    if (ok == 0) {
+        return true;
+    }
+    srtla_log(SRTLA_LOG_WARNING, "Link via %s: cannot pin to %s (%s), routing decides its uplink",
+              config.sourceIp.c_str(), name, strerror(bindErrno));
+    return false;
+}
+
+std::unique_ptr<SrtlaSender::Link> SrtlaSender::openLink(const LinkConfig& config) {
+    const std::string& sourceIp = config.sourceIp;
+    sockaddr_storage srcAddr;
+    if (!parseAddr(sourceIp, 0, srcAddr)) {
+        srtla_log(SRTLA_LOG_WARNING, "Skipping invalid link address: %s", sourceIp.c_str());
+        return nullptr;
+    }
+    int family = srcAddr.ss_family;
+
+    int fd = socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        srtla_log(SRTLA_LOG_ERROR, "Failed to create link socket for %s: %s", sourceIp.c_str(), strerror(errno));
+        return nullptr;
+    }
+
+    int bufSize = SOCKET_BUFFER_SIZE;
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufSize, sizeof(bufSize));
+
+    std::string interfaceName;
+    bool pinned = config.ifIndex > 0 && pinToInterface(fd, family, config, interfaceName);
+
+    if (bind(fd, (sockaddr*)&srcAddr, addrLen(srcAddr)) < 0) {
+        srtla_log(SRTLA_LOG_WARNING, "Failed to open link via %s: %s", sourceIp.c_str(), strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+
+    auto link = std::make_unique<Link>();
+    link->sourceIp = sourceIp;
+    link->family = family;
+    link->ifIndex = config.ifIndex;
+    link->interfaceName = interfaceName;
+    link->pinned = pinned;
+    link->priority = config.priority;
+    link->fd = fd;
+    link->index = m_linksOpened++;
+    if (m_impairment) {
+        link->impairment = std::make_unique<LinkImpairment>(m_impairment->seed() + link->index);
+        link->impairment->setParams(m_impairment->paramsAt(sourceIp, link->index, 0));
+    }
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = link.get();
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev);
+
+    if (pinned) {
+        srtla_log(SRTLA_LOG_INFO, "Added SRTLA link via %s on %s", sourceIp.c_str(), interfaceName.c_str());
+    } else {
+        srtla_log(SRTLA_LOG_INFO, "Added SRTLA link via %s", sourceIp.c_str());
+    }
+    return link;
+}
+
+void SrtlaSender::closeLink(Link& link) {
+    if (link.fd >= 0) {
+        if (m_epollFd >= 0) {
+            epoll_ctl(m_epollFd, EPOLL_CTL_DEL, link.fd, nullptr);
+        }
+        close(link.fd);
+        link.fd = -1;
+    }
+}
+
+void SrtlaSender::applyLinkCommands() {
+    int pending = m_pendingScheduler.exchange(-1);
+    if (pending >= 0 && (LinkSchedulerType)pending != m_scheduler->type()) {
+        m_scheduler = createLinkScheduler((LinkSchedulerType)pending);
+        srtla_log(SRTLA_LOG_INFO, "SRTLA link scheduler set to %s", linkSchedulerName(m_scheduler->type()));
+    }
+
+    std::vector<LinkCommand> commands;
+    std::vector<std::string> servers;
+    bool serversChanged;
+    bool gateChanged;
+    {
+        std::lock_guard<std::mutex> lock(m_commandMutex);
+        commands.swap(m_commands);
+        servers.swap(m_pendingServers);
+        serversChanged = m_serversChanged;
+        m_serversChanged = false;
+        gateChanged = m_gateChanged;
+        m_gateChanged = false;
+        if (gateChanged) m_gate = m_pendingGate;
+    }
+    if (commands.empty() && !serversChanged && !gateChanged) return;
+
+    if (gateChanged && !m_gate.enabled) {
+        for (auto& link : m_links) {
+            if (link->registered) link->admitted = true;
+        }
+    }
+
+    if (serversChanged) {
+        setServers(servers);
+    }
+
+    for (const auto& command : commands) {
+        const std::string& sourceIp = command.config.sourceIp;
+        auto it = std::find_if(m_links.begin(), m_links.end(), [&](const std::unique_ptr<Link>& link) {
+            return link->sourceIp == sourceIp;
+        });
+
+        if (!command.add) {
+            if (it == m_links.end()) continue;
+            srtla_log(SRTLA_LOG_INFO, "Removed SRTLA link via %s", sourceIp.c_str());
+            closeLink(**it);
+            m_links.erase(it);
+            continue;
+        }
+
+        // Adding a link we already have keeps its state, only the priority may change
+        if (it != m_links.end()) {
+            (*it)->priority = command.config.priority;
+            continue;
+        }
+
+        auto link = openLink(command.config);
+        if (!link) continue;
+        m_links.push_back(std::move(link));
+    }
+
+    preferAddressFamilies();
+    updateSchedLinks();
+    assignServers();
+}
+
+void SrtlaSender::setServers(const std::vector<std::string>& serverIps) {
+    std::vector<sockaddr_storage> addrs;
+    for (const auto& ip : serverIps) {
+        sockaddr_storage addr;
+        if (!parseAddr(ip, m_serverPort, addr)) {
+            srtla_log(SRTLA_LOG_DEBUG, "Ignoring SRTLA server address %s", ip.c_str());
+            continue;
+        }
+        addrs.push_back(addr);
+    }
+
+    // Keep the old addresses rather than strand every link
+    if (addrs.empty()) return;
+    m_serverAddrs.swap(addrs);
+}
+
+void SrtlaSender::assignServers() {
+    if (m_serverAddrs.empty()) return;
+
+    // Each link can only reach addresses of its own family; without
+    // spreading, only the first one of each family is a target
+    std::vector<bool> target(m_serverAddrs.size(), false);
+    bool firstOf[2] = {true, true};
+    for (size_t i = 0; i < m_serverAddrs.size(); i++) {
+        bool& first = firstOf[m_serverAddrs[i].ss_family == AF_INET6];
+        target[i] = m_spreadServers || first;
+        first = false;
+    }
+    std::vector<size_t> load(m_serverAddrs.size(), 0);
+    std::vector<Link*> unassigned;
+
+    // Links keep a target that is still valid, so a refresh does not reshuffle them
+    for (auto& link : m_links) {
+        size_t index = m_serverAddrs.size();
+        if (link->hasServer) {
+            for (size_t i = 0; i < m_serverAddrs.size(); i++) {
+                if (target[i] && sameAddr(m_serverAddrs[i], link->server)) {
+                    index = i;
+                    break;
+                }
+            }
+        }
+        if (index < m_serverAddrs.size()) {
+            load[index]++;
+        } else {
+            unassigned.push_back(link.get());
+        }
+    }
+
+    Link* firstConnected = nullptr;
+    for (Link* link : unassigned) {
+        size_t best = m_serverAddrs.size();
+        for (size_t i = 0; i < m_serverAddrs.size(); i++) {
+            if (!target[i] || m_serverAddrs[i].ss_family != link->family) continue;
+            if (best == m_serverAddrs.size() || load[i] < load[best]) best = i;
+        }
+        if (best == m_serverAddrs.size()) {
+            srtla_log(SRTLA_LOG_DEBUG, "No %s address for the SRTLA server, link via %s stays idle",
+                      link->family == AF_INET6 ? "IPv6" : "IPv4", link->sourceIp.c_str());
+            continue;
+        }
+        load[best]++;
+        connectLink(*link, m_serverAddrs[best]);
+        if (!firstConnected && link->hasServer) firstConnected = link;
+    }
+
+    // Register the group as soon as a late-resolved address is known
+    if (firstConnected && m_groupState == GroupState::Unregistered) {
+        sendReg1(*firstConnected, Clock::now());
+    }
+}
+
+void SrtlaSender::connectLink(Link& link, const sockaddr_storage& server) {
+    std::string addr = formatAddr(server);
+    const char* ip = addr.c_str();
+    if (connect(link.fd, (const sockaddr*)&server, addrLen(server)) < 0) {
+        // A pinned socket only sees routes through its own interface
+        if (errno == ENETUNREACH && link.pinned) {
+            srtla_log(SRTLA_LOG_WARNING, "Failed to connect link via %s to %s: no route through %s; "
+                      "it needs a default route or a policy routing rule for its address",
+                      link.sourceIp.c_str(), ip, link.interfaceName.c_str());
+        } else {
+            srtla_log(SRTLA_LOG_WARNING, "Failed to connect link via %s to %s: %s",
+                      link.sourceIp.c_str(), ip, strerror(errno));
+        }
+        return;
+    }
+
+    // A new receiver address knows nothing about this link yet
+    if (link.hasServer) {
+        srtla_log(SRTLA_LOG_INFO, "SRTLA link via %s moved to server %s", link.sourceIp.c_str(), ip);
+        link.registered = false;
+        link.window = SRTLA_WINDOW_DEF * SRTLA_WINDOW_MULT;
+        link.inFlight = 0;
+        link.log.clear();
+        resetProbing(link);
+    }
+    link.server = server;
+    link.hasServer = true;
+
+    // Join an already registered group right away
+    if (m_groupState == GroupState::Registered) {
+        sendReg2(link, Clock::now());
+    }
+}
+
+SrtlaSender::Link* SrtlaSender::selectLink() {
+    int index = m_scheduler->select(m_schedLinks.data(), m_schedLinks.size());
+    return index >= 0 ? m_activeLinks[index] : nullptr;
+}
+
+void SrtlaSender::updateSchedLinks() {
+    m_activeLinks.clear();
+    m_schedLinks.clear();
+    for (auto& link : m_links) {
+        if (link->standby || !link->admitted) continue;
+        m_activeLinks.push_back(link.get());
+        m_schedLinks.push_back(link.get());
+    }
+}
+
+void SrtlaSender::preferAddressFamilies() {
+    bool changed = false;
+    for (auto& link : m_links) {
+        Link* sibling = nullptr;
+        if (link->ifIndex > 0) {
+            for (auto& other : m_links) {
+                if (other->ifIndex == link->ifIndex && other->family != link->family) {
+                    sibling = other.get();
+                    break;
+                }
+            }
+        }
+        link->dualStack = sibling != nullptr;
+        if (!sibling) {
+            if (link->standby) {
+                link->standby = false;
+                changed = true;
+            }
+            continue;
+        }
+        // Each pair is decided once, from its IPv4 side
+        if (link->family != AF_INET) continue;
+
+        // IPv4 carries the data until both families have been measured
+        Link* active = link->standby ? sibling : link.get();
+        Link* other = active == link.get() ? sibling : link.get();
+        bool activeUp = active->registered && active->admitted;
+        bool otherUp = other->registered && other->admitted;
+        Link* preferred = active;
+        if (!activeUp) {
+            if (otherUp) preferred = other;
+        } else if (otherUp && active->keepaliveRttMs >= 0.0 && other->keepaliveRttMs >= 0.0) {
+            double margin = std::max(FAMILY_SWITCH_MIN_MS, active->keepaliveRttMs * FAMILY_SWITCH_RATIO);
+            if (other->keepaliveRttMs < active->keepaliveRttMs - margin) preferred = other;
+        }
+
+        Link* standby = preferred == link.get() ? sibling : link.get();
+        if (preferred->standby || !standby->standby) {
+            if (preferred != active && !activeUp) {
+                srtla_log(SRTLA_LOG_INFO, "SRTLA link via %s is down, moving its traffic to %s",
+                          active->sourceIp.c_str(), preferred->sourceIp.c_str());
+            } else if (preferred != active) {
+                srtla_log(SRTLA_LOG_INFO, "SRTLA traffic moved from %s to %s, keepalive RTT %.1f ms vs %.1f ms",
+                          active->sourceIp.c_str(), preferred->sourceIp.c_str(),
+                          active->keepaliveRttMs, preferred->keepaliveRttMs);
+            }
+            preferred->standby = false;
+            standby->standby = true;
+            changed = true;
+        }
+    }
+    if (changed) updateSchedLinks();
+}
+
+void SrtlaSender::handleLocalPacket(const uint8_t* buf, size_t len, Clock::time_point now) {
+    // Nothing valid is empty or larger than a link datagram
+    if (len == 0 || len > SRTLA_MTU) return;
+
+    Link* link = selectLink();
+    if (!link) {
+        // Nothing registered yet, SRT will retransmit
+        return;
+    }
+
+    // Logged at queue time, so the scheduler sees the packet in flight right
+    // away; flushLink() takes it back out if it cannot be sent
+    queueOnLink(*link, buf, len, now);
+
+    int32_t seq = srt_data_seq(buf, len);
+    if (seq >= 0) {
+        link->log.sent(*link, seq, now);
+    }
+}
+
+void SrtlaSender::readLocalSocket() {
+    // Drain everything OBS has queued on the local socket, a batch per syscall
+    while (true) {
+        for (size_t i = 0; i < IO_BATCH; i++) {
+            m_rxMsgs[i].msg_hdr.msg_namelen = sizeof(m_rxAddrs[i]);
+        }
+        int count = recvmmsg(m_localFd, m_rxMsgs, IO_BATCH, 0, nullptr);
+        if (count <= 0) break;
+        m_rxSyscalls++;
+        m_rxPackets += count;
+
+        Clock::time_point now = Clock::now();
+        for (int i = 0; i < count; i++) {
+            // Only local clients, and nothing cut short by the buffer size
+            if ((ntohl(m_rxAddrs[i].sin_addr.s_addr) >> 24) != 127 || (m_rxMsgs[i].msg_hdr.msg_flags & MSG_TRUNC)) {
+                continue;
+            }
+
+            // SRT may reconnect from a new source port, always answer the latest peer
+            m_clientAddr = m_rxAddrs[i];
+            m_hasClient = true;
+            handleLocalPacket(&m_rxBuffers[i * SRTLA_MTU], m_rxMsgs[i].msg_len, now);
+        }
+
+        // The bursts point into the receive buffers, send them before reusing those
+        flushPending(now);
+        if ((size_t)count < IO_BATCH) break;
+    }
+}
+
+void SrtlaSender::queueOnLink(Link& link, const uint8_t* buf, size_t len, Clock::time_point now) {
+    if (link.txCount == IO_BATCH) {
+        flushLink(link, now);
+    }
+    if (link.txCount == 0) {
+        m_txPending.push_back(&link);
+    }
+    link.txIov[link.txCount].iov_base = const_cast<uint8_t*>(buf);
+    link.txIov[link.txCount].iov_len = len;
+    link.txCount++;
+}
+
+void SrtlaSender::flushPending(Clock::time_point now) {
+    for (Link* link : m_txPending) {
+        flushLink(*link, now);
+    }
+    m_txPending.clear();
+}
+
+void SrtlaSender::flushLink(Link& link, Clock::time_point now) {
+    size_t count = link.txCount;
+    link.txCount = 0;
+    if (count == 0 || link.fd < 0 || !link.hasServer) return;
+
+    size_t sent = 0;
+    if (link.impairment) {
+        // The emulated link takes everything, its queue decides what gets through
+        for (; sent < count; sent++) {
+            impairPacket(link, (const uint8_t*)link.txIov[sent].iov_base, link.txIov[sent].iov_len, now);
+        }
+    }
+    while (sent < count) {
+        size_t n = m_gsoEnabled ? sendSegmented(link, sent, count - sent) : 0;
+        if (n == 0) n = sendBatch(link, sent, count - sent);
+        if (n == 0) break;  // socket buffer full, SRT retransmits the rest
+        sent += n;
+    }
+
+    for (size_t i = 0; i < sent; i++) {
+        link.bytesSent += link.txIov[i].iov_len;
+    }
+    // Dropped before reaching the wire, they are neither in flight nor lost
+    for (size_t i = sent; i < count; i++) {
+        int32_t seq = srt_data_seq((const uint8_t*)link.txIov[i].iov_base, link.txIov[i].iov_len);
+        if (seq >= 0) {
+            link.log.unsent(link, seq);
+        }
+    }
+    link.packetsSent += sent;
+    m_txPackets += sent;
+    if (sent > 0) {
+        link.lastSent = now;
+    }
+}
+
+size_t SrtlaSender::sendSegmented(Link& link, size_t first, size_t count) {
+    // GSO needs equal sized segments, only the last one may be shorter
+    const iovec* iov = &link.txIov[first];
+    size_t segmentSize = iov[0].iov_len;
+    if (segmentSize == 0) return 0;
+    size_t maxSegments = std::min(GSO_MAX_SEGMENTS, GSO_MAX_BYTES / segmentSize);
+    size_t run = 1;
+    while (run < count && run < maxSegments && iov[run].iov_len == segmentSize) {
+        run++;
+    }
+    if (run < count && run < maxSegments && iov[run].iov_len < segmentSize) {
+        run++;
+    }
+    if (run < 2) return 0;
+
+    char control[CMSG_SPACE(sizeof(uint16_t))];
+    memset(control, 0, sizeof(control));
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = const_cast<iovec*>(iov);
+    msg.msg_iovlen = run;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    uint16_t gsoSize = (uint16_t)segmentSize;
+    memcpy(CMSG_DATA(cmsg), &gsoSize, sizeof(gsoSize));
+
+    m_txSyscalls++;
+    if (sendmsg(link.fd, &msg, 0) < 0) {
+        if (errno == EINVAL || errno == EIO || errno == ENOPROTOOPT || errno == EOPNOTSUPP) {
+            srtla_log(SRTLA_LOG_INFO, "UDP GSO unavailable (%s), using sendmmsg", strerror(errno));
+            m_gsoEnabled = false;
+        }
+        return 0;
+    }
+    return run;
+}
+
+size_t SrtlaSender::sendBatch(Link& link, size_t first, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        m_txMsgs[i].msg_hdr.msg_iov = &link.txIov[first + i];
+        m_txMsgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    m_txSyscalls++;
+    int sent = sendmmsg(link.fd, m_txMsgs, count, 0);
+    return sent > 0 ? (size_t)sent : 0;
+}
+
+void SrtlaSender::sendToClient(const uint8_t* buf, size_t len) {
+    if (m_hasClient) {
+        sendto(m_localFd, buf, len, 0, (sockaddr*)&m_clientAddr, sizeof(m_clientAddr));
+    }
+}
+
+void SrtlaSender::registerNak(int32_t seq) {
+    for (auto& link : m_links) {
+        if (link->log.naked(*link, seq)) {
+            link->naks++;
+            return;
+        }
+    }
+}
+
+void SrtlaSender::handleSrtNak(const uint8_t* buf, size_t len) {
+    // Loss list: single sequence numbers, or ranges with the top bit set on the first one
+    for (size_t off = SRT_MIN_LEN; off + 4 <= len; off += 4) {
+        uint32_t value = srtla_read_be32(buf + off);
+        if (value & 0x80000000) {
+            if (off + 8 > len) break;
+            int32_t first = (int32_t)(value & 0x7fffffff);
+            int32_t last = (int32_t)(srtla_read_be32(buf + off + 4) & 0x7fffffff);
+            off += 4;
+
+            // Bound the work for absurd ranges, the log only holds recent packets anyway
+            int count = 0;
+            for (int32_t seq = first; seq != last + 1 && count < (int)PacketLog::SIZE; seq = (seq + 1) & 0x7fffffff) {
+                registerNak(seq);
+                count++;
+            }
+        } else {
+            registerNak((int32_t)value);
+        }
+    }
+}
+
+void SrtlaSender::handleLinkPacket(Link& link, const uint8_t* buf, size_t len) {
+    Clock::time_point now = Clock::now();
+    link.lastReceived = now;
+
+    uint16_t type = srtla_packet_type(buf, len);
+    switch (type) {
+    case SRTLA_TYPE_REG2:
+        if (m_groupState == GroupState::Reg1Sent && len >= SRTLA_TYPE_REG2_LEN &&
+            memcmp(buf + 2, m_srtlaId, SRTLA_ID_LEN / 2) == 0) {
+            memcpy(m_srtlaId, buf + 2, SRTLA_ID_LEN);
+            m_groupState = GroupState::Registered;
+            setRegisteredGroup(true);
+            srtla_log(SRTLA_LOG_INFO, "SRTLA group registered, registering %zu link(s)", m_links.size());
+            for (auto& l : m_links) {
+                sendReg2(*l, now);
+            }
+        }
+        return;
+
+    case SRTLA_TYPE_REG3:
+        if (!link.registered) {
+            link.registered = true;
+            srtla_log(SRTLA_LOG_INFO, "SRTLA link via %s registered", link.sourceIp.c_str());
+            if (!m_gate.enabled) link.admitted = true;
+            preferAddressFamilies();
+            updateSchedLinks();
+        }
+        return;
+
+    case SRTLA_TYPE_REG_ERR:
+        srtla_log(SRTLA_LOG_WARNING, "SRTLA receiver rejected link via %s", link.sourceIp.c_str());
+        link.registered = false;
+        return;
+
+    case SRTLA_TYPE_REG_NGP:
+        // The receiver forgot our group, start over with REG1
+        srtla_log(SRTLA_LOG_WARNING, "SRTLA group not found on receiver, re-registering");
+        m_groupState = GroupState::Unregistered;
+        setRegisteredGroup(false);
+        for (auto& l : m_links) {
+            l->registered = false;
+        }
+        return;
+
+    case SRTLA_TYPE_REG_NAK:
+        link.registered = false;
+        return;
+
+    case SRTLA_TYPE_KEEPALIVE:
+        // Receivers echo keepalives whole, ours carry their send time
+        if (len >= SRTLA_KEEPALIVE_LEN) {
+            uint32_t sentUs = srtla_read_be32(buf + 2);
+            double rtt = (uint32_t)(keepaliveClockUs(now) - sentUs) / 1000.0;
+            if (rtt < SRTLA_CONN_TIMEOUT_MS) {
+                link.keepaliveRttMs = link.keepaliveRttMs < 0.0 ? rtt : 0.875 * link.keepaliveRttMs + 0.125 * rtt;
+            }
+            // Probes of the current round that came back in time
+            if (!link.admitted && link.probesSent > 0 && (int32_t)(sentUs - link.probeRoundStartUs) >= 0 &&
+                rtt <= m_gate.maxRttMs) {
+                link.probesEchoed++;
+                link.probeRttSumMs += rtt;
+            }
+        }
+        return;
+
+    case SRTLA_TYPE_ACK:
+        for (size_t off = SRTLA_ACK_HDR_LEN; off + 4 <= len; off += 4) {
+            link.log.acked(link, (int32_t)srtla_read_be32(buf + off), now);
+        }
+        return;
+
+    case SRT_TYPE_NAK:
+        handleSrtNak(buf, len);
+        break;
+
+    default:
+        break;
+    }
+
+    // Everything else is SRT traffic for OBS
+    sendToClient(buf, len);
+}
+
+bool SrtlaSender::sendOnLink(Link& link, const uint8_t* buf, size_t len, Clock::time_point now) {
+    if (link.fd < 0 || !link.hasServer) return false;
+    ssize_t n = (ssize_t)len;
+    if (link.impairment) {
+        impairPacket(link, buf, len, now);
+    } else {
+        n = send(link.fd, buf, len, 0);
+    }
+    if (n < 0) {
+        return false;
+    }
+    link.lastSent = now;
+    link.bytesSent += (uint64_t)n;
+    link.packetsSent++;
+    return true;
+}
+
+void SrtlaSender::sendReg1(Link& link, Clock::time_point now) {
+    uint8_t pkt[SRTLA_TYPE_REG1_LEN];
+    srtla_write_be16(pkt, SRTLA_TYPE_REG1);
+    memcpy(pkt + 2, m_srtlaId, SRTLA_ID_LEN);
+    if (sendOnLink(link, pkt, sizeof(pkt), now)) {
+        m_groupState = GroupState::Reg1Sent;
+        m_reg1SentAt = now;
+    }
+}
+
+void SrtlaSender::sendReg2(Link& link, Clock::time_point now) {
+    uint8_t pkt[SRTLA_TYPE_REG2_LEN];
+    srtla_write_be16(pkt, SRTLA_TYPE_REG2);
+    memcpy(pkt + 2, m_srtlaId, SRTLA_ID_LEN);
+    sendOnLink(link, pkt, sizeof(pkt), now);
+    link.lastRegSent = now;
+}
+
+void SrtlaSender::sendKeepalive(Link& link, Clock::time_point now) {
+    uint8_t pkt[SRTLA_KEEPALIVE_LEN];
+    srtla_write_be16(pkt, SRTLA_TYPE_KEEPALIVE);
+    srtla_write_be32(pkt + 2, keepaliveClockUs(now));
+    sendOnLink(link, pkt, sizeof(pkt), now);
+}
+
+void SrtlaSender::housekeeping(Clock::time_point now) {
+    applyLinkCommands();
+    if (m_links.empty()) return;
+
+    auto elapsedMs = [now](Clock::time_point since) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(now - since).count();
+    };
+
+    // Group registration goes through one link at a time, rotating on timeout
+    if (m_groupState == GroupState::Unregistered ||
+        (m_groupState == GroupState::Reg1Sent && elapsedMs(m_reg1SentAt) > SRTLA_REG_TIMEOUT_MS)) {
+        sendReg1(*m_links[m_reg1Attempts++ % m_links.size()], now);
+    }
+
+    for (auto& link : m_links) {
+        if (link->registered && elapsedMs(link->lastReceived) > SRTLA_CONN_TIMEOUT_MS) {
+            srtla_log(SRTLA_LOG_WARNING, "SRTLA link via %s timed out", link->sourceIp.c_str());
+            link->registered = false;
+            link->window = SRTLA_WINDOW_DEF * SRTLA_WINDOW_MULT;
+            link->inFlight = 0;
+            link->log.clear();
+            link->keepaliveRttMs = -1.0;
+            resetProbing(*link);
+        }
+
+        if (m_groupState == GroupState::Registered && !link->registered &&
+            elapsedMs(link->lastRegSent) > SRTLA_REG_TIMEOUT_MS) {
+            sendReg2(*link, now);
+        }
+
+        // Keep NAT mappings alive and let the receiver see idle links.
+        // Both families of a dual-stack interface are probed all the time,
+        // to compare their RTTs.
+        if (link->dualStack || elapsedMs(link->lastSent) >= SRTLA_IDLE_TIME_MS) {
+            sendKeepalive(*link, now);
+        }
+    }
+
+    if (m_gate.enabled) {
+        demoteDegradedLinks(now);
+    }
+    preferAddressFamilies();
+    updateSchedLinks();
+}
+
+void SrtlaSender::resetProbing(Link& link) {
+    link.admitted = false;
+    link.probeFailed = false;
+    link.probesSent = 0;
+    link.probesEchoed = 0;
+    link.probeRttSumMs = 0.0;
+    link.degradedSince = Clock::time_point();
+}
+
+SrtlaSender::Clock::time_point SrtlaSender::probeLinks(Clock::time_point now) {
+    const auto interval = std::chrono::milliseconds(SRTLA_PROBE_INTERVAL_MS);
+    const auto maxRtt = std::chrono::milliseconds((int64_t)m_gate.maxRttMs);
+    Clock::time_point next = Clock::time_point::max();
+    bool changed = false;
+
+    for (auto& link : m_links) {
+        if (link->admitted || !link->registered) continue;
+
+        if (link->probesSent < m_gate.probes) {
+            if (now - link->lastProbeSent >= interval) {
+                if (link->probesSent == 0) link->probeRoundStartUs = keepaliveClockUs(now);
+                sendKeepalive(*link, now);
+                link->probesSent++;
+                link->lastProbeSent = now;
+            }
+            next = std::min(next, link->lastProbeSent + interval);
+            continue;
+        }
+
+        // The round is over once every probe is back or the last one is overdue
+        if (link->probesEchoed < link->probesSent && now < link->lastProbeSent + maxRtt) {
+            next = std::min(next, link->lastProbeSent + maxRtt);
+            continue;
+        }
+
+        double loss = 1.0 - (double)link->probesEchoed / link->probesSent;
+        double rtt = link->probesEchoed > 0 ? link->probeRttSumMs / link->probesEchoed : -1.0;
+        if (link->probesEchoed > 0 && loss <= m_gate.maxLoss) {
+            srtla_log(SRTLA_LOG_INFO, "SRTLA link via %s admitted: probe RTT %.0f ms, %.0f%% lost",
+                      link->sourceIp.c_str(), rtt, loss * 100.0);
+            link->admitted = true;
+            link->probeFailed = false;
+            // Figures from before a demotion describe the path as it was
+            link->srttMs = rtt;
+            link->lossRate = 0.0;
+            changed = true;
+        } else if (!link->probeFailed) {
+            srtla_log(SRTLA_LOG_WARNING, "SRTLA link via %s held back: %.0f%% of its probes lost or slower than %.0f ms",
+                      link->sourceIp.c_str(), loss * 100.0, m_gate.maxRttMs);
+            link->probeFailed = true;
+        }
+        link->probesSent = 0;
+        link->probesEchoed = 0;
+        link->probeRttSumMs = 0.0;
+        next = std::min(next, link->lastProbeSent + interval);
+    }
+
+    if (changed) {
+        preferAddressFamilies();
+        updateSchedLinks();
+    }
+    return next;
+}
+
+void SrtlaSender::demoteDegradedLinks(Clock::time_point now) {
+    size_t carrying = 0;
+    for (auto& link : m_links) {
+        carrying += link->registered && link->admitted && !link->standby;
+    }
+
+    for (auto& link : m_links) {
+        if (!link->registered || !link->admitted || link->standby) continue;
+
+        bool degraded = link->srttMs > m_gate.maxRttMs || link->lossRate > m_gate.maxLoss;
+        if (!degraded) {
+            link->degradedSince = Clock::time_point();
+            continue;
+        }
+        if (link->degradedSince == Clock::time_point()) {
+            link->degradedSince = now;
+            continue;
+        }
+
+        // A poor link still beats none
+        if (now - link->degradedSince < std::chrono::milliseconds(SRTLA_DEMOTE_AFTER_MS) || carrying <= 1) continue;
+
+        srtla_log(SRTLA_LOG_WARNING, "SRTLA link via %s demoted: RTT %.0f ms, %.0f%% NAKed; probing it again",
+                  link->sourceIp.c_str(), link->srttMs, link->lossRate * 100.0);
+        resetProbing(*link);
+        carrying--;
+    }
+}
+
+void SrtlaSender::impairPacket(Link& link, const uint8_t* buf, size_t len, Clock::time_point now) {
+    Clock::time_point releaseAt;
+    if (!link.impairment->admit(len, now, releaseAt)) return;
+
+    link.delayed.emplace_back();
+    DelayedPacket& pkt = link.delayed.back();
+    pkt.releaseAt = releaseAt;
+    pkt.len = len;
+    memcpy(pkt.data, buf, len);
+}
+
+void SrtlaSender::updateImpairments(Clock::time_point now) {
+    int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_startedAt).count();
+    for (auto& link : m_links) {
+        if (!link->impairment) continue;
+        bool wasBlackout = link->impairment->params().blackout;
+        link->impairment->setParams(m_impairment->paramsAt(link->sourceIp, link->index, ms));
+        if (link->impairment->params().blackout != wasBlackout) {
+            srtla_log(SRTLA_LOG_INFO, "Impairment: link via %s %s", link->sourceIp.c_str(),
+                      wasBlackout ? "back up" : "blacked out");
+        }
+    }
+}
+
+SrtlaSender::Clock::time_point SrtlaSender::releaseDelayed(Clock::time_point now) {
+    Clock::time_point next = Clock::time_point::max();
+    for (auto& link : m_links) {
+        auto& queue = link->delayed;
+        while (!queue.empty() && queue.front().releaseAt <= now) {
+            if (link->fd >= 0 && link->hasServer) {
+                send(link->fd, queue.front().data, queue.front().len, 0);
+                m_txSyscalls++;
+            }
+            queue.pop_front();
+        }
+        if (!queue.empty()) {
+            next = std::min(next, queue.front().releaseAt);
+        }
+    }
+    return next;
+}
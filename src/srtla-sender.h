@@ -0,0 +1,359 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "srtla-protocol.h"
+#include "link-stats.h"
+#include "link-scheduler.h"
+#include "link-impairment.h"
+#include "packet-log.h"
+
+// One uplink handed to the engine
+struct LinkConfig {
+    std::string sourceIp;   // IPv4 or IPv6
+    int priority = 0;   // lower is preferred by the priority scheduler
+
+    // Interface that owns sourceIp. When set, the link's socket is pinned
+    // to it, so its packets leave through that uplink whatever the routing
+    // table prefers for the destination. 0 leaves the choice to routing.
+    int ifIndex = 0;
+    std::string interfaceName;
+};
+
+// Quality a registered link has to show before it carries data, and keep
+// up while it does. New links send a round of timestamped keepalives
+// (probes) and are admitted once the echoes come back within maxRttMs with
+// at most maxLoss of them missing. A link carrying data whose ACK RTT or
+// NAK rate stays beyond the same limits is demoted and probed again.
+struct LinkQualityGate {
+    bool enabled = false;       // admit links as soon as they register
+    int probes = 5;             // probes per round, one every SRTLA_PROBE_INTERVAL_MS
+    double maxRttMs = 1000.0;
+    double maxLoss = 0.2;       // fraction of probes, or of data packets NAKed
+};
+
+// Native SRTLA bonding engine.
+//
+// Listens for the local SRT stream from OBS on a UDP port, registers one
+// UDP socket per uplink source IP with the SRTLA receiver and spreads the
+// SRT packets across the registered links. Responses from the receiver are
+// forwarded back to the local SRT client. All socket I/O happens on a single
+// engine thread; the public methods only post work to it.
+//
+// The receiver may be known by several addresses (round-robin DNS). Links
+// either all use the first one of their address family or, with spreading
+// enabled, are balanced across all of that family.
+//
+// A dual-stack uplink is handed over as two links, IPv4 and IPv6, on the
+// same interface. Both register and are probed with keepalives, but only
+// the one with the lower RTT carries data; the other stands by and takes
+// over if the preferred one fails.
+//
+// With a quality gate, links only join the scheduler once they passed it.
+//
+// Settings changes restart the engine make-before-break: a second engine
+// joins the running one's SRTLA group over its own link sockets, so the
+// receiver keeps a single downstream SRT connection, and takes over the
+// local socket once its links are registered.
+class SrtlaSender {
+public:
+    SrtlaSender();
+    ~SrtlaSender();
+
+    // Bind the local SRT port and start bonding to serverIps:serverPort
+    // over the given links. serverIps may be empty while the server name is
+    // still being resolved. Returns false if the local port is unusable.
+    bool start(uint16_t localPort, const std::vector<std::string>& serverIps, uint16_t serverPort,
+               const std::vector<LinkConfig>& links);
+
+    // Warm restart: start next to previous, which keeps forwarding, with
+    // its local port. With joinGroup, links register into previous's SRTLA
+    // group, which must be at the same server; otherwise this engine
+    // registers a group of its own, for a different server or port. Once
+    // the links are up, or after SRTLA_HANDOVER_TIMEOUT_MS, previous is
+    // stopped and this engine reads the stream from the same socket, so no
+    // packet is lost. previous must outlive this engine and be stopped only
+    // after it. Stopping this engine before it took over stops previous as
+    // well. Returns false, leaving previous untouched, if previous has no
+    // registered group to join or is itself still taking over from
+    // another engine.
+    bool startWarm(SrtlaSender& previous, const std::vector<std::string>& serverIps, uint16_t serverPort,
+                   const std::vector<LinkConfig>& links, bool joinGroup = true);
+
+    // Local SRT port of the running engine
+    uint16_t localPort() const { return m_localPort; }
+
+    // A warm start has not taken over the stream yet
+    bool isTakingOver() const { return m_takingOver; }
+
+    // Group ID once the receiver registered the group. Safe from any thread.
+    bool registeredGroup(uint8_t id[SRTLA_ID_LEN]) const;
+
+    // Stop the engine thread and close all sockets
+    void stop();
+
+    // Check if the engine is running
+    bool isRunning() const { return m_running; }
+
+    // Add or remove a single uplink. Other links keep their registration
+    // and in-flight state. Adding a known link only updates its priority.
+    // Safe to call from any thread.
+    void addLink(const LinkConfig& link);
+    void removeLink(const std::string& sourceIp);
+
+    // Replace the receiver's addresses, e.g. after a DNS refresh. Links
+    // whose address is gone move to a remaining one and register again.
+    // Safe to call from any thread.
+    void setServerAddresses(const std::vector<std::string>& serverIps);
+
+    // Balance links across all receiver addresses instead of using the
+    // first one only. Only for receivers that share group state behind one
+    // name. Must be set before start().
+    void setSpreadServers(bool spread) { m_spreadServers = spread; }
+
+    // Switch the packet scheduling strategy. Safe to call from any thread,
+    // takes effect on the engine thread without touching link state.
+    void setScheduler(LinkSchedulerType type);
+
+    // Set the link quality gate. Safe to call from any thread; links
+    // already carrying data are kept, disabling it admits all links.
+    void setQualityGate(const LinkQualityGate& gate);
+
+    // Publish per-link statistics into buffer every SRTLA_STATS_INTERVAL_MS.
+    // Must be set before start(); the buffer must outlive the engine.
+    void setStatsBuffer(SenderStatsBuffer* buffer) { m_statsBuffer = buffer; }
+
+    // Run every uplink through a LinkImpairment driven by script, timed from
+    // start(), to test the engine against emulated cellular links on any
+    // machine. Must be set before start().
+    void setImpairment(std::shared_ptr<const ImpairmentScript> script) { m_impairment = std::move(script); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Packets per recvmmsg from the local socket, and per link transmit burst
+    static constexpr size_t IO_BATCH = 64;
+
+    // Packet held back by the impairment emulation until releaseAt
+    struct DelayedPacket {
+        Clock::time_point releaseAt;
+        size_t len;
+        uint8_t data[SRTLA_MTU];
+    };
+
+    // Scheduling state (registered, window, inFlight, RTT, loss, priority)
+    // lives in the LinkMetrics base so schedulers can read it directly
+    struct Link : LinkMetrics {
+        Link() { window = SRTLA_WINDOW_DEF * SRTLA_WINDOW_MULT; }
+
+        std::string sourceIp;
+        int family = AF_INET;
+        int ifIndex = 0;
+        std::string interfaceName;
+        bool pinned = false;     // socket bound to its interface
+        int fd = -1;
+        sockaddr_storage server;  // receiver address the socket is connected to
+        bool hasServer = false;
+        bool dualStack = false;  // the interface has a link of the other address family
+        bool standby = false;    // the other address family of this interface is preferred
+        double keepaliveRttMs = -1.0;  // smoothed keepalive echo time, -1 until measured
+
+        // Quality gate: a link only carries data once admitted
+        bool admitted = false;
+        bool probeFailed = false;        // the last round failed, already logged
+        int probesSent = 0;              // in the current round
+        int probesEchoed = 0;            // in time
+        double probeRttSumMs = 0.0;
+        uint32_t probeRoundStartUs = 0;  // keepalive clock at the first probe of the round
+        Clock::time_point lastProbeSent;
+        Clock::time_point degradedSince;  // admitted but beyond the gate's limits, or zero
+        Clock::time_point lastReceived;
+        Clock::time_point lastSent;
+        Clock::time_point lastRegSent;
+        PacketLog log;
+
+        // Statistics
+        uint64_t bytesSent = 0;
+        uint64_t packetsSent = 0;
+        uint64_t naks = 0;
+        uint64_t lastPacketsSent = 0;  // counters at the previous snapshot, for rates
+        uint64_t lastBytesSent = 0;
+        uint64_t lastNaks = 0;
+
+        // Transmit burst, pointing into the receive batch until flushed
+        // at the end of the batch
+        iovec txIov[IO_BATCH];
+        size_t txCount = 0;
+
+        // Emulated link conditions, only with an impairment script
+        size_t index = 0;  // order of opening, for scripts that select links by number
+        std::unique_ptr<LinkImpairment> impairment;
+        std::deque<DelayedPacket> delayed;
+    };
+
+    enum class GroupState {
+        Unregistered,  // no REG1 sent yet
+        Reg1Sent,      // waiting for REG2 from the receiver
+        Registered     // group ID known, links register with REG2
+    };
+
+    // Engine thread main loop
+    void run();
+
+    // Socket setup
+    std::unique_ptr<Link> openLink(const LinkConfig& config);
+    void closeLink(Link& link);
+    void applyLinkCommands();
+    void setServers(const std::vector<std::string>& serverIps);
+    void assignServers();
+    void connectLink(Link& link, const sockaddr_storage& server);
+
+    // Packet handling
+    void handleLocalPacket(const uint8_t* buf, size_t len, Clock::time_point now);
+    void readLocalSocket();
+    void sendToClient(const uint8_t* buf, size_t len);
+    void handleLinkPacket(Link& link, const uint8_t* buf, size_t len);
+    void handleSrtNak(const uint8_t* buf, size_t len);
+    void registerNak(int32_t seq);
+    Link* selectLink();
+
+    // Dual-stack interfaces: pick the address family that carries data
+    void preferAddressFamilies();
+    void updateSchedLinks();
+
+    // Quality gate: send probes and judge finished rounds, returning when
+    // the next probe is due; demote links that degraded
+    Clock::time_point probeLinks(Clock::time_point now);
+    void demoteDegradedLinks(Clock::time_point now);
+    void resetProbing(Link& link);
+
+    // Warm restart: switch over from the previous engine once ready
+    void checkHandover(Clock::time_point now);
+    void completeHandover(Clock::time_point now);
+    void setRegisteredGroup(bool registered);
+
+    // Registration and keepalives, run once per SRTLA_HOUSEKEEPING_MS
+    void housekeeping(Clock::time_point now);
+    void sendReg1(Link& link, Clock::time_point now);
+    void sendReg2(Link& link, Clock::time_point now);
+    void sendKeepalive(Link& link, Clock::time_point now);
+    bool sendOnLink(Link& link, const uint8_t* buf, size_t len, Clock::time_point now);
+
+    // Batched data path: queue SRT packets per link, then send each burst
+    // with one UDP GSO sendmsg or one sendmmsg
+    void queueOnLink(Link& link, const uint8_t* buf, size_t len, Clock::time_point now);
+    void flushLink(Link& link, Clock::time_point now);
+    void flushPending(Clock::time_point now);
+    size_t sendSegmented(Link& link, size_t first, size_t count);
+    size_t sendBatch(Link& link, size_t first, size_t count);
+
+    // Impairment emulation: queue a packet on the emulated link, follow the
+    // script, and send what is due, returning the next release time
+    void impairPacket(Link& link, const uint8_t* buf, size_t len, Clock::time_point now);
+    void updateImpairments(Clock::time_point now);
+    Clock::time_point releaseDelayed(Clock::time_point now);
+
+    void wake();
+
+    // Fill and publish a statistics snapshot
+    void publishStats(Clock::time_point now);
+
+    // Configuration
+    uint16_t m_localPort;
+    uint16_t m_serverPort;
+    std::vector<sockaddr_storage> m_serverAddrs;  // engine thread only
+    bool m_spreadServers;
+
+    // Sockets, owned by the engine thread once started
+    int m_localFd;
+    int m_wakeFd;
+    int m_epollFd;
+    std::vector<std::unique_ptr<Link>> m_links;
+
+    // Packet scheduling over the links not on standby; m_schedLinks
+    // mirrors m_activeLinks for the scheduler
+    std::unique_ptr<LinkScheduler> m_scheduler;
+    std::vector<Link*> m_activeLinks;
+    std::vector<const LinkMetrics*> m_schedLinks;
+    std::atomic<int> m_pendingScheduler;  // LinkSchedulerType to switch to, or -1
+    LinkQualityGate m_gate;  // engine thread only
+
+    // Local SRT client (OBS), learned from the first received packet
+    sockaddr_in m_clientAddr;
+    bool m_hasClient;
+
+    // Batched I/O buffers and syscall accounting
+    std::vector<uint8_t> m_rxBuffers;
+    mmsghdr m_rxMsgs[IO_BATCH];
+    iovec m_rxIov[IO_BATCH];
+    sockaddr_in m_rxAddrs[IO_BATCH];
+    mmsghdr m_txMsgs[IO_BATCH];
+    std::vector<Link*> m_txPending;
+    bool m_gsoEnabled;
+    uint64_t m_rxPackets;
+    uint64_t m_rxSyscalls;
+    uint64_t m_txPackets;
+    uint64_t m_txSyscalls;
+    uint64_t m_lastRxPackets;
+    uint64_t m_lastRxSyscalls;
+    uint64_t m_lastTxPackets;
+    uint64_t m_lastTxSyscalls;
+
+    // SRTLA group registration
+    GroupState m_groupState;
+    uint8_t m_srtlaId[SRTLA_ID_LEN];
+    Clock::time_point m_reg1SentAt;
+    size_t m_reg1Attempts;
+    mutable std::mutex m_groupMutex;  // guards the copy below for other engines
+    uint8_t m_registeredId[SRTLA_ID_LEN];
+    bool m_hasRegisteredId;
+
+    // Warm restart: the engine being taken over, its local socket (shared
+    // with this one, only read here after the handover) and group, if
+    // this engine joins it
+    SrtlaSender* m_previous;
+    int m_warmFd;
+    uint8_t m_warmId[SRTLA_ID_LEN];
+    bool m_warmJoin;
+    Clock::time_point m_handoverStartedAt;
+    std::atomic<bool> m_takingOver;
+
+    // Link add/remove deltas posted from other threads, applied in order
+    struct LinkCommand {
+        bool add;
+        LinkConfig config;
+    };
+    std::mutex m_commandMutex;
+    std::vector<LinkCommand> m_commands;
+    std::vector<std::string> m_pendingServers;
+    bool m_serversChanged;
+    LinkQualityGate m_pendingGate;
+    bool m_gateChanged;
+    void postCommand(bool add, const LinkConfig& config);
+
+    // Impairment emulation, null unless testing
+    std::shared_ptr<const ImpairmentScript> m_impairment;
+    Clock::time_point m_startedAt;
+    size_t m_linksOpened;
+
+    // Statistics output, written only by the engine thread
+    SenderStatsBuffer* m_statsBuffer;
+    Clock::time_point m_lastStatsAt;
+    uint64_t m_statsGeneration;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_stopRequested;
+};
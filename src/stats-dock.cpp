@@ -0,0 +1,172 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Link statistics dock
+ *
+ * Shows throughput, RTT, loss and window state for every uplink.
+ *
+ * License: GPL-3.0
+ */
+
+#include "stats-dock.h"
+#include "srtla-relay.h"
+
+#include <QHeaderView>
+#include <QLabel>
+#include <QTableWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include <map>
+
+// 4 Hz, fast enough to follow a modem dropping out
+static constexpr int STATS_REFRESH_MS = 250;
+
+enum StatsColumn {
+    COL_INTERFACE,
+    COL_ADDRESS,
+    COL_STATE,
+    COL_THROUGHPUT,
+    COL_PACKET_RATE,
+    COL_RTT,
+    COL_NAK_RATE,
+    COL_WINDOW,
+    COL_IN_FLIGHT,
+    COL_LAST_SEEN,
+    COL_COUNT
+};
+
+static QString formatBitrate(double bitsPerSec) {
+    if (bitsPerSec >= 1000000.0) {
+        return QString("%1 Mbps").arg(bitsPerSec / 1000000.0, 0, 'f', 2);
+    }
+    return QString("%1 kbps").arg(bitsPerSec / 1000.0, 0, 'f', 0);
+}
+
+static QString formatBytes(uint64_t bytes) {
+    if (bytes >= 1024ull * 1024 * 1024) {
+        return QString("%1 GiB").arg(bytes / (1024.0 * 1024 * 1024), 0, 'f', 2);
+    }
+    return QString("%1 MiB").arg(bytes / (1024.0 * 1024), 0, 'f', 1);
+}
+
+SrtlaStatsDock::SrtlaStatsDock(QWidget *parent) : QWidget(parent) {
+    m_table = new QTableWidget(0, COL_COUNT, this);
+    m_table->setHorizontalHeaderLabels({"Interface", "Address", "State", "Throughput", "Packets/s",
+                                        "RTT", "NAKs/s", "Window", "In flight", "Last seen"});
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionMode(QAbstractItemView::NoSelection);
+
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setWordWrap(true);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 4, 4, 4);
+    layout->addWidget(m_table);
+    layout->addWidget(m_statusLabel);
+
+    m_timer = new QTimer(this);
+    m_timer->setInterval(STATS_REFRESH_MS);
+    connect(m_timer, &QTimer::timeout, [this]() { refresh(); });
+    m_timer->start();
+
+    refresh();
+}
+
+void SrtlaStatsDock::refresh() {
+    // Nothing to draw while the dock is hidden or the plugin is unloading
+    if (!isVisible() || !g_srtlaRelay)
+        return;
+
+    // Snapshot taken by the plugin's 4 Hz stats poll
+    const SenderStats &stats = g_srtlaRelay->readLinkStats();
+    std::map<std::string, const LinkStats *> byIp;
+    for (const auto &link : stats.links) {
+        byIp[link.sourceIp] = &link;
+    }
+
+    // One row per usable interface, plus any engine link the monitor no longer reports
+    struct Row {
+        QString name;
+        std::string ip;
+        const LinkStats *stats;
+    };
+    std::vector<Row> rows;
+    for (const auto &iface : g_srtlaRelay->getNetworkInterfaces()) {
+        if (!iface.isActive || iface.ipAddress.empty() || iface.name == "lo")
+            continue;
+        auto it = byIp.find(iface.ipAddress);
+        rows.push_back({QString::fromStdString(iface.name), iface.ipAddress,
+                        it != byIp.end() ? it->second : nullptr});
+        if (it != byIp.end())
+            byIp.erase(it);
+    }
+    for (const auto &entry : byIp) {
+        rows.push_back({"-", entry.first, entry.second});
+    }
+
+    m_table->setRowCount((int)rows.size());
+    for (int r = 0; r < (int)rows.size(); r++) {
+        const Row &row = rows[r];
+        const LinkStats *link = row.stats;
+
+        QString cells[COL_COUNT];
+        cells[COL_INTERFACE] = row.name;
+        cells[COL_ADDRESS] = QString::fromStdString(row.ip);
+        if (!link) {
+            // srtla_send only tells which links registered
+            bool external = g_srtlaRelay->isRunning() && !g_srtlaRelay->isNativeSenderEnabled() &&
+                            g_srtlaRelay->readExternalSenderStatus().registeredLinks.count(row.ip);
+            cells[COL_STATE] = external ? "Registered" : "Not bonded";
+        } else {
+            cells[COL_STATE] = !link->registered ? "Registering" : link->probing ? "Probing" :
+                               link->standby ? "Standby" : "Active";
+            // Unpinned links may leave through another uplink, depending on routing
+            if (!link->pinned)
+                cells[COL_STATE] += ", not pinned";
+            cells[COL_THROUGHPUT] = QString("%1 (%2)").arg(formatBitrate(link->bitsPerSec),
+                                                           formatBytes(link->bytesSent));
+            cells[COL_PACKET_RATE] = QString::number(link->packetsPerSec, 'f', 0);
+            cells[COL_RTT] = link->rttMs < 0.0 ? "-" : QString("%1 ms").arg(link->rttMs, 0, 'f', 0);
+            cells[COL_NAK_RATE] = QString::number(link->naksPerSec, 'f', 1);
+            cells[COL_WINDOW] = QString::number(link->window);
+            cells[COL_IN_FLIGHT] = QString::number(link->inFlight);
+            cells[COL_LAST_SEEN] = link->lastSeenMs < 0 ? "never" :
+                QString("%1 s ago").arg(link->lastSeenMs / 1000.0, 0, 'f', 1);
+        }
+
+        for (int c = 0; c < COL_COUNT; c++) {
+            QTableWidgetItem *item = m_table->item(r, c);
+            if (!item) {
+                item = new QTableWidgetItem();
+                m_table->setItem(r, c, item);
+            }
+            if (item->text() != cells[c])
+                item->setText(cells[c]);
+        }
+    }
+
+    if (!g_srtlaRelay->isRunning()) {
+        m_statusLabel->setText("SRTLA sender is stopped.");
+    } else if (!g_srtlaRelay->isNativeSenderEnabled()) {
+        const auto &external = g_srtlaRelay->readExternalSenderStatus();
+        QString status = QString("srtla_send: %1 link(s) registered").arg(external.registeredLinks.size());
+        if (!external.lastEvent.empty())
+            status += QString(", last event: %1").arg(QString::fromStdString(external.lastEvent));
+        status += ". Link statistics are only available with the built-in bonding engine.";
+        m_statusLabel->setText(status);
+    } else {
+        QString status = QString("%1 link(s) bonded").arg(stats.links.size());
+        if (stats.txPacketsPerSyscall > 0.0) {
+            status += QString(", %1 in / %2 out packets per syscall%3")
+                          .arg(stats.rxPacketsPerSyscall, 0, 'f', 1)
+                          .arg(stats.txPacketsPerSyscall, 0, 'f', 1)
+                          .arg(stats.gso ? " (GSO)" : "");
+        }
+        int bitrate = g_srtlaRelay->getAdaptiveBitrateKbps();
+        if (bitrate > 0)
+            status += QString(", adaptive encoder bitrate %1 kbps").arg(bitrate);
+        m_statusLabel->setText(status);
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <QWidget>
+
+class QLabel;
+class QTableWidget;
+class QTimer;
+
+// Dock showing live per-link statistics of the bonded stream.
+//
+// Polls the engine's lock-free snapshot on a UI timer, so rendering never
+// waits on the engine thread.
+class SrtlaStatsDock : public QWidget {
+public:
+    explicit SrtlaStatsDock(QWidget *parent = nullptr);
+
+private:
+    void refresh();
+
+    QTableWidget *m_table;
+    QLabel *m_statusLabel;
+    QTimer *m_timer;
+};
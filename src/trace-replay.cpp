@@ -0,0 +1,366 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Link trace replay
+ *
+ * Discrete-event simulation of a bonded SRT stream over recorded link
+ * conditions, driving the engine's own scheduler and window logic.
+ *
+ * License: GPL-3.0
+ */
+
+#include "trace-replay.h"
+#include "packet-log.h"
+#include "srtla-protocol.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <queue>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Clock = PacketLog::Clock;
+
+static constexpr int64_t US_PER_MS = 1000;
+static constexpr int64_t STATS_INTERVAL_US = SRTLA_STATS_INTERVAL_MS * US_PER_MS;
+static constexpr int64_t HOUSEKEEPING_US = SRTLA_HOUSEKEEPING_MS * US_PER_MS;
+
+// SRT reports a loss again if the packet has not shown up after about an RTT,
+// the RTT as SRT measures it: through the bonded uplinks' queues
+static constexpr int64_t MIN_NAK_INTERVAL_US = 20 * US_PER_MS;
+static constexpr int64_t INITIAL_SRT_RTT_US = 100 * US_PER_MS;
+
+// Misses closer together than this are one visible stall
+static constexpr int64_t STALL_MERGE_US = 500 * US_PER_MS;
+
+enum class EventType {
+    Generate,      // the encoder hands over the next packet
+    Arrive,        // a packet reaches the receiver over link
+    Ack,           // an SRTLA ACK for seq reaches the sender over link
+    Nak,           // an SRT NAK for seq reaches the sender
+    NakCheck,      // the receiver re-reports seq if it is still missing
+    Register,      // REG3 for link reaches the sender
+    Housekeeping,
+    Stats
+};
+
+struct Event {
+    int64_t us;
+    uint64_t order;  // insertion order, so ties resolve the same on every run
+    EventType type;
+    size_t link;
+    int32_t seq;
+};
+
+struct Later {
+    bool operator()(const Event& a, const Event& b) const {
+        return a.us != b.us ? a.us > b.us : a.order > b.order;
+    }
+};
+
+struct SimLink : LinkMetrics {
+    SimLink() { window = SRTLA_WINDOW_DEF * SRTLA_WINDOW_MULT; }
+
+    PacketLog log;
+    int64_t busyUntilUs = 0;     // bottleneck done with the queued packets
+    int64_t lastReceivedUs = 0;
+    bool registering = false;
+    uint64_t packetsSent = 0;
+    uint64_t naks = 0;
+    uint64_t lastPacketsSent = 0;
+    uint64_t lastNaks = 0;
+};
+
+struct SimPacket {
+    int64_t sentUs;
+    int64_t arrivedUs = -1;
+    bool retransmitted = false;
+};
+
+class Simulation {
+public:
+    Simulation(const LinkTrace& trace, const TraceReplayConfig& config)
+        : m_trace(trace),
+          m_config(config),
+          m_links(trace.linkNames.size()),
+          m_scheduler(createLinkScheduler(config.scheduler)),
+          m_rng(config.seed),
+          m_bitrateKbps(config.bitrateKbps) {
+        for (auto& link : m_links) {
+            m_schedLinks.push_back(&link);
+        }
+        if (m_config.adaptBitrate) {
+            BitrateControllerConfig bitrate = m_config.bitrate;
+            bitrate.ceilingKbps = m_config.bitrateKbps;
+            m_controller.configure(bitrate);
+            m_controller.reset(m_config.bitrateKbps);
+            m_bitrateKbps = m_controller.appliedKbps();
+        }
+    }
+
+    TraceReplayResult run();
+
+private:
+    static Clock::time_point timeAt(int64_t us) { return Clock::time_point(std::chrono::microseconds(us)); }
+
+    LinkTracePoint conditions(size_t link, int64_t us) const { return m_trace.at(link, us / US_PER_MS); }
+
+    void schedule(int64_t us, EventType type, size_t link = 0, int32_t seq = 0) {
+        m_events.push({us, m_order++, type, link, seq});
+    }
+
+    void generate(int64_t now);
+    void send(int32_t seq, int64_t now);
+    void arrive(size_t link, int32_t seq, int64_t now);
+    void reportLoss(int32_t seq, int64_t now);
+    void nak(int32_t seq, int64_t now);
+    void housekeeping(int64_t now);
+    void stats(int64_t now);
+
+    const LinkTrace& m_trace;
+    TraceReplayConfig m_config;
+    std::vector<SimLink> m_links;
+    std::vector<const LinkMetrics*> m_schedLinks;
+    std::unique_ptr<LinkScheduler> m_scheduler;
+    BitrateController m_controller;
+    std::mt19937_64 m_rng;
+    std::priority_queue<Event, std::vector<Event>, Later> m_events;
+    uint64_t m_order = 0;
+    int64_t m_endUs = 0;
+
+    int m_bitrateKbps;
+    std::vector<SimPacket> m_packets;
+    uint64_t m_retransmissions = 0;
+
+    // Receiver side
+    int32_t m_highestSeq = -1;
+    size_t m_lastActiveLink = 0;  // SRT control traffic goes back this way
+    int64_t m_srttUs = INITIAL_SRT_RTT_US;
+    int64_t m_rttVarUs = INITIAL_SRT_RTT_US / 2;
+};
+
+void Simulation::generate(int64_t now) {
+    int32_t seq = (int32_t)m_packets.size();
+    m_packets.push_back({now});
+    send(seq, now);
+
+    int64_t intervalUs = (int64_t)(m_config.packetSize * 8 * US_PER_MS / std::max(m_bitrateKbps, 1));
+    if (now + intervalUs < m_endUs) {
+        schedule(now + intervalUs, EventType::Generate);
+    }
+}
+
+void Simulation::send(int32_t seq, int64_t now) {
+    int index = m_scheduler->select(m_schedLinks.data(), m_schedLinks.size());
+    if (index < 0) return;  // nothing registered, lost until SRT retransmits
+
+    SimLink& link = m_links[index];
+    link.log.sent(link, seq, timeAt(now));
+    link.packetsSent++;
+
+    LinkTracePoint point = conditions(index, now);
+    if (point.capacityKbps == 0) return;
+    if (std::uniform_int_distribution<uint32_t>(0, 9999)(m_rng) < point.lossBp) return;
+
+    // Bottleneck queue at the trace's capacity, tail drop when full
+    int64_t start = std::max(link.busyUntilUs, now);
+    if (start - now > m_config.queueMs * US_PER_MS) return;
+    link.busyUntilUs = start + (int64_t)(m_config.packetSize * 8 * US_PER_MS / point.capacityKbps);
+    schedule(link.busyUntilUs + point.rttMs * US_PER_MS / 2, EventType::Arrive, index, seq);
+}
+
+void Simulation::arrive(size_t index, int32_t seq, int64_t now) {
+    // SRTLA ACK back over the same link, duplicates included
+    LinkTracePoint point = conditions(index, now);
+    if (point.capacityKbps > 0) {
+        schedule(now + point.rttMs * US_PER_MS / 2, EventType::Ack, index, seq);
+    }
+
+    SimPacket& packet = m_packets[seq];
+    if (packet.arrivedUs >= 0) return;
+    packet.arrivedUs = now;
+    m_lastActiveLink = index;
+
+    // SRT's RTT smoothing, sampled from packets sent only once
+    if (!packet.retransmitted) {
+        int64_t sample = now - packet.sentUs + point.rttMs * US_PER_MS / 2;
+        m_rttVarUs = (3 * m_rttVarUs + std::abs(m_srttUs - sample)) / 4;
+        m_srttUs = (7 * m_srttUs + sample) / 8;
+    }
+
+    // Everything skipped over is reported lost right away
+    for (int32_t missing = m_highestSeq + 1; missing < seq; missing++) {
+        if (m_packets[missing].arrivedUs < 0) {
+            reportLoss(missing, now);
+        }
+    }
+    m_highestSeq = std::max(m_highestSeq, seq);
+}
+
+void Simulation::reportLoss(int32_t seq, int64_t now) {
+    LinkTracePoint point = conditions(m_lastActiveLink, now);
+    if (point.capacityKbps > 0) {
+        schedule(now + point.rttMs * US_PER_MS / 2, EventType::Nak, 0, seq);
+    }
+    int64_t interval = std::max(m_srttUs + 4 * m_rttVarUs, MIN_NAK_INTERVAL_US);
+    schedule(now + interval, EventType::NakCheck, 0, seq);
+}
+
+void Simulation::nak(int32_t seq, int64_t now) {
+    for (auto& link : m_links) {
+        if (link.log.naked(link, seq)) {
+            link.naks++;
+            break;
+        }
+    }
+
+    // Retransmit while the packet can still make playout
+    if (now < m_packets[seq].sentUs + m_config.latencyMs * US_PER_MS) {
+        m_retransmissions++;
+        m_packets[seq].retransmitted = true;
+        send(seq, now);
+    }
+}
+
+void Simulation::housekeeping(int64_t now) {
+    for (size_t i = 0; i < m_links.size(); i++) {
+        SimLink& link = m_links[i];
+        LinkTracePoint point = conditions(i, now);
+        bool up = point.capacityKbps > 0;
+
+        // Keepalives are echoed while the link works
+        if (up) {
+            link.lastReceivedUs = now;
+        }
+
+        if (link.registered && now - link.lastReceivedUs > SRTLA_CONN_TIMEOUT_MS * US_PER_MS) {
+            link.registered = false;
+            link.window = SRTLA_WINDOW_DEF * SRTLA_WINDOW_MULT;
+            link.inFlight = 0;
+            link.log.clear();
+        }
+        if (!link.registered && !link.registering && up) {
+            link.registering = true;
+            schedule(now + point.rttMs * US_PER_MS, EventType::Register, i);
+        }
+    }
+}
+
+void Simulation::stats(int64_t now) {
+    SenderStats snapshot;
+    double seconds = STATS_INTERVAL_US / 1e6;
+    for (auto& link : m_links) {
+        LinkStats out;
+        out.registered = link.registered;
+        out.rttMs = link.srttMs;
+        out.window = link.window / SRTLA_WINDOW_MULT;
+        out.inFlight = link.inFlight;
+        out.packetsPerSec = (link.packetsSent - link.lastPacketsSent) / seconds;
+        out.naksPerSec = (link.naks - link.lastNaks) / seconds;
+        link.lastPacketsSent = link.packetsSent;
+        link.lastNaks = link.naks;
+        snapshot.links.push_back(out);
+    }
+    if (m_controller.update(snapshot, now / US_PER_MS)) {
+        m_bitrateKbps = m_controller.appliedKbps();
+    }
+}
+
+TraceReplayResult Simulation::run() {
+    m_endUs = m_trace.durationMs() * US_PER_MS;
+    TraceReplayResult result;
+    if (m_endUs <= 0 || m_links.empty()) return result;
+
+    schedule(0, EventType::Housekeeping);
+    schedule(0, EventType::Generate);
+    if (m_config.adaptBitrate) {
+        schedule(STATS_INTERVAL_US, EventType::Stats);
+    }
+
+    // Run past the end until the last packets are delivered or given up on
+    int64_t stopUs = m_endUs + m_config.latencyMs * US_PER_MS;
+    while (!m_events.empty() && m_events.top().us <= stopUs) {
+        Event event = m_events.top();
+        m_events.pop();
+        int64_t now = event.us;
+
+        switch (event.type) {
+        case EventType::Generate:
+            generate(now);
+            break;
+        case EventType::Arrive:
+            arrive(event.link, event.seq, now);
+            break;
+        case EventType::Ack:
+            m_links[event.link].lastReceivedUs = now;
+            m_links[event.link].log.acked(m_links[event.link], event.seq, timeAt(now));
+            break;
+        case EventType::Nak:
+            nak(event.seq, now);
+            break;
+        case EventType::NakCheck:
+            if (m_packets[event.seq].arrivedUs < 0 &&
+                now < m_packets[event.seq].sentUs + m_config.latencyMs * US_PER_MS) {
+                reportLoss(event.seq, now);
+            }
+            break;
+        case EventType::Register: {
+            SimLink& link = m_links[event.link];
+            link.registering = false;
+            if (conditions(event.link, now).capacityKbps > 0) {
+                link.registered = true;
+                link.lastReceivedUs = now;
+            }
+            break;
+        }
+        case EventType::Housekeeping:
+            housekeeping(now);
+            schedule(now + HOUSEKEEPING_US, EventType::Housekeeping);
+            break;
+        case EventType::Stats:
+            stats(now);
+            schedule(now + STATS_INTERVAL_US, EventType::Stats);
+            break;
+        }
+    }
+
+    // Playout: a packet counts if it arrived within the latency
+    result.seconds = m_endUs / 1e6;
+    result.packets = m_packets.size();
+    result.retransmissions = m_retransmissions;
+    std::vector<double> latencies;
+    int64_t lastMissUs = -STALL_MERGE_US - 1;
+    for (size_t i = 0; i < m_packets.size(); i++) {
+        const SimPacket& packet = m_packets[i];
+        int64_t transitUs = packet.arrivedUs - packet.sentUs;
+        if (packet.arrivedUs >= 0 && transitUs <= m_config.latencyMs * US_PER_MS) {
+            result.delivered++;
+            latencies.push_back(transitUs / 1000.0);
+            continue;
+        }
+        if (packet.sentUs - lastMissUs > STALL_MERGE_US) result.stalls++;
+        lastMissUs = packet.sentUs;
+        int64_t nextUs = i + 1 < m_packets.size() ? m_packets[i + 1].sentUs : m_endUs;
+        result.stalledSeconds += (nextUs - packet.sentUs) / 1e6;
+    }
+
+    double bitsPerPacket = m_config.packetSize * 8.0;
+    result.goodputKbps = result.delivered * bitsPerPacket / result.seconds / 1000.0;
+    result.meanBitrateKbps = result.packets * bitsPerPacket / result.seconds / 1000.0;
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        result.latencyP50Ms = latencies[latencies.size() / 2];
+        result.latencyP99Ms = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+        result.latencyMaxMs = latencies.back();
+    }
+    return result;
+}
+
+} // namespace
+
+TraceReplayResult replayLinkTrace(const LinkTrace& trace, const TraceReplayConfig& config) {
+    Simulation simulation(trace, config);
+    return simulation.run();
+}
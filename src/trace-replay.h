@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "bitrate-controller.h"
+#include "link-scheduler.h"
+#include "link-trace.h"
+
+struct TraceReplayConfig {
+    LinkSchedulerType scheduler = LinkSchedulerType::Window;
+    int bitrateKbps = 6000;     // offered stream, the ceiling when adapting
+    int latencyMs = 2000;       // SRT latency: packets arriving later miss playout
+    int queueMs = 200;          // bottleneck buffer of each link
+    size_t packetSize = 1316;
+    bool adaptBitrate = false;  // steer the bitrate with BitrateController
+    BitrateControllerConfig bitrate;  // ceilingKbps is taken from bitrateKbps
+    uint64_t seed = 1;
+};
+
+struct TraceReplayResult {
+    double seconds = 0.0;          // simulated stream time
+    uint64_t packets = 0;          // SRT data packets the encoder produced
+    uint64_t delivered = 0;        // reached the receiver in time for playout
+    uint64_t retransmissions = 0;
+    double goodputKbps = 0.0;      // delivered payload over the stream time
+    double meanBitrateKbps = 0.0;  // offered, differs from the configured one when adapting
+    int stalls = 0;                // runs of packets that missed playout, merged
+                                   // when less than 500 ms apart
+    double stalledSeconds = 0.0;   // stream time covered by those runs
+    double latencyP50Ms = 0.0;     // send to arrival of delivered packets,
+    double latencyP99Ms = 0.0;     // including retransmissions
+    double latencyMaxMs = 0.0;
+};
+
+// Deterministic, faster than real time replay of a link trace through the
+// engine's scheduling and window logic (LinkScheduler, PacketLog) and
+// optionally the adaptive bitrate controller.
+//
+// Simulates, on virtual time, a constant bitrate SRT stream bonded over the
+// trace's links: per link a rate-limited bottleneck queue, propagation
+// delay and random loss as recorded; SRTLA registration, ACKs, keepalive
+// timeouts; SRT NAKs, periodic NAK reports and retransmissions until the
+// latency runs out. Identical inputs give identical results.
+TraceReplayResult replayLinkTrace(const LinkTrace& trace, const TraceReplayConfig& config);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer/single-consumer snapshot exchange.
+//
+// The writer fills back(), then publish() swaps it with the shared middle
+// slot. The reader calls read(), which takes the middle slot if something new
+// was published and returns the latest complete snapshot. Neither side ever
+// waits on the other, so the engine thread can publish at any rate while the
+// UI thread polls at its own pace.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : m_middle(1), m_back(2), m_front(0) {}
+
+    // Writer side: the slot to fill before publish()
+    T& back() { return m_slots[m_back]; }
+
+    void publish() {
+        uint8_t old = m_middle.exchange(m_back | FRESH_BIT, std::memory_order_acq_rel);
+        m_back = old & INDEX_MASK;
+    }
+
+    // Reader side: latest published snapshot. Returns false if nothing new
+    // arrived since the previous call (out still refers to the last snapshot).
+    bool read(const T*& out) {
+        bool fresh = (m_middle.load(std::memory_order_relaxed) & FRESH_BIT) != 0;
+        if (fresh) {
+            uint8_t old = m_middle.exchange(m_front, std::memory_order_acq_rel);
+            m_front = old & INDEX_MASK;
+        }
+        out = &m_slots[m_front];
+        return fresh;
+    }
+
+private:
+    static constexpr uint8_t FRESH_BIT = 0x4;
+    static constexpr uint8_t INDEX_MASK = 0x3;
+
+    T m_slots[3];
+    std::atomic<uint8_t> m_middle;  // index of the shared slot, plus FRESH_BIT
+    uint8_t m_back;                 // owned by the writer
+    uint8_t m_front;                // owned by the reader
+};
@@ -0,0 +1,41 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Atomic file replacement tests
+ *
+ * License: GPL-3.0
+ */
+
+#include "test.h"
+#include "atomic-file.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <unistd.h>
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+TEST(atomic_file_replaces_contents) {
+    char dir[] = "/tmp/srtla-test-XXXXXX";
+    CHECK(mkdtemp(dir) != nullptr);
+    std::string path = std::string(dir) + "/settings.json";
+
+    CHECK(atomicWriteFile(path, "{\"a\": 1}"));
+    CHECK_EQ(readFile(path), std::string("{\"a\": 1}"));
+    CHECK(atomicWriteFile(path, "{}"));
+    CHECK_EQ(readFile(path), std::string("{}"));
+
+    // No temporary file is left behind
+    CHECK(access((path + ".tmp").c_str(), F_OK) != 0);
+
+    // A missing directory fails without creating anything
+    CHECK(!atomicWriteFile(std::string(dir) + "/missing/settings.json", "{}"));
+
+    unlink(path.c_str());
+    rmdir(dir);
+}
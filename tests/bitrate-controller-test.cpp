@@ -0,0 +1,69 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Adaptive bitrate controller tests
+ *
+ * License: GPL-3.0
+ */
+
+#include "test.h"
+#include "bitrate-controller.h"
+
+static SenderStats snapshot(double packetsPerSec, double naksPerSec, double rttMs) {
+    SenderStats stats;
+    LinkStats link;
+    link.registered = true;
+    link.packetsPerSec = packetsPerSec;
+    link.naksPerSec = naksPerSec;
+    link.rttMs = rttMs;
+    link.window = 20000;
+    link.inFlight = 10;
+    stats.links.push_back(link);
+    return stats;
+}
+
+static BitrateController makeController() {
+    BitrateControllerConfig config;
+    config.floorKbps = 1000;
+    config.ceilingKbps = 6000;
+    BitrateController controller;
+    controller.configure(config);
+    controller.reset(6000);
+    return controller;
+}
+
+TEST(bitrate_controller_backs_off_on_loss) {
+    BitrateController controller = makeController();
+    CHECK(!controller.update(snapshot(1000, 0, 40), 0));
+
+    // 5% NAKs: one decrease per interval, never below the floor
+    CHECK(controller.update(snapshot(1000, 50, 40), 1000));
+    CHECK(controller.isCongested());
+    CHECK_EQ(controller.appliedKbps(), 5100);
+    CHECK(!controller.update(snapshot(1000, 50, 40), 1500));
+    for (int64_t t = 2000; t < 40000; t += 1000) {
+        controller.update(snapshot(1000, 50, 40), t);
+    }
+    CHECK_EQ(controller.appliedKbps(), 1000);
+}
+
+TEST(bitrate_controller_detects_rtt_inflation) {
+    BitrateController controller = makeController();
+    controller.update(snapshot(1000, 0, 40), 0);
+    controller.update(snapshot(1000, 0, 200), 1000);
+    CHECK(controller.isCongested());
+    CHECK(controller.appliedKbps() < 6000);
+}
+
+TEST(bitrate_controller_recovers_after_hold) {
+    BitrateController controller = makeController();
+    controller.update(snapshot(1000, 50, 40), 0);
+    int reduced = controller.appliedKbps();
+
+    // Nothing moves during the hold time, then additive increase up to the ceiling
+    controller.update(snapshot(1000, 0, 40), 4000);
+    CHECK_EQ(controller.targetKbps(), reduced);
+    for (int64_t t = 5000; t < 30000; t += 1000) {
+        controller.update(snapshot(1000, 0, 40), t);
+    }
+    CHECK_EQ(controller.appliedKbps(), 6000);
+}
@@ -0,0 +1,87 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Network interface classification tests
+ *
+ * License: GPL-3.0
+ */
+
+#include "test.h"
+#include "interface-class.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Builds a fake /sys/class/net entry
+class FakeSysfs {
+public:
+    FakeSysfs() {
+        char dir[] = "/tmp/srtla-test-XXXXXX";
+        if (mkdtemp(dir)) m_root = dir;
+    }
+
+    ~FakeSysfs() {
+        std::string cmd = "rm -rf '" + m_root + "'";
+        int ret = system(cmd.c_str());
+        (void)ret;
+    }
+
+    const std::string& root() const { return m_root; }
+
+    // An interface with a device behind it bound to driver, if one is given
+    void add(const std::string& name, int arpType, const std::string& devType = "",
+             const std::string& driver = "") {
+        std::string dir = m_root + "/" + name;
+        mkdir(dir.c_str(), 0755);
+        std::ofstream(dir + "/type") << arpType << "\n";
+        std::ofstream uevent(dir + "/uevent");
+        if (!devType.empty()) uevent << "DEVTYPE=" << devType << "\n";
+        uevent << "INTERFACE=" << name << "\n";
+        if (!driver.empty()) {
+            mkdir((dir + "/device").c_str(), 0755);
+            int ret = symlink(("../../../bus/usb/drivers/" + driver).c_str(), (dir + "/device/driver").c_str());
+            (void)ret;
+        }
+    }
+
+    void addDir(const std::string& path) {
+        mkdir((m_root + "/" + path).c_str(), 0755);
+    }
+
+private:
+    std::string m_root;
+};
+
+TEST(interface_class_ignores_names) {
+    FakeSysfs sysfs;
+    sysfs.add("eth0", 1, "", "qmi_wwan");
+    sysfs.addDir("eth0/device/wwan");
+    sysfs.add("enx0c5b8f279a64", 1, "", "rndis_host");
+    sysfs.add("usb0", 1, "", "r8152");
+    sysfs.add("wwan0", 519, "wwan", "mhi-net");
+    sysfs.add("wlp2s0", 1, "wlan", "iwlwifi");
+    sysfs.add("ppp0", 512);
+    sysfs.add("wg0", 65534, "wireguard");
+    sysfs.add("br0", 1, "bridge");
+
+    CHECK(classifyInterface("eth0", sysfs.root()) == InterfaceType::Cellular);
+    CHECK(classifyInterface("enx0c5b8f279a64", sysfs.root()) == InterfaceType::Tether);
+    CHECK(classifyInterface("usb0", sysfs.root()) == InterfaceType::Ethernet);
+    CHECK(classifyInterface("wwan0", sysfs.root()) == InterfaceType::Cellular);
+    CHECK(classifyInterface("wlp2s0", sysfs.root()) == InterfaceType::Wireless);
+    CHECK(classifyInterface("ppp0", sysfs.root()) == InterfaceType::Cellular);
+    CHECK(classifyInterface("wg0", sysfs.root()) == InterfaceType::Tunnel);
+    CHECK(classifyInterface("br0", sysfs.root()) == InterfaceType::Virtual);
+    CHECK(classifyInterface("missing", sysfs.root()) == InterfaceType::Unknown);
+}
+
+TEST(interface_class_priorities) {
+    CHECK_EQ(interfacePriority(InterfaceType::Ethernet), 0);
+    CHECK_EQ(interfacePriority(InterfaceType::Wireless), 0);
+    CHECK_EQ(interfacePriority(InterfaceType::Unknown), 0);
+    CHECK_EQ(interfacePriority(InterfaceType::Cellular), 1);
+    CHECK_EQ(interfacePriority(InterfaceType::Tether), 1);
+}
@@ -0,0 +1,86 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Job queue tests
+ *
+ * License: GPL-3.0
+ */
+
+#include "test.h"
+#include "job-queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+TEST(job_queue_runs_in_order) {
+    std::vector<int> order;
+    std::promise<void> done;
+    {
+        JobQueue queue;
+        for (int i = 0; i < 5; i++) {
+            queue.post([&order, i]() { order.push_back(i); });
+        }
+        queue.post([&done]() { done.set_value(); });
+        done.get_future().wait();
+    }
+    CHECK_EQ(order.size(), 5u);
+    for (int i = 0; i < 5; i++) {
+        CHECK_EQ(order[i], i);
+    }
+}
+
+TEST(job_queue_coalesces_keyed_jobs) {
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::vector<int> ran;
+    std::promise<void> done;
+
+    JobQueue queue;
+    queue.post([&]() {
+        started.set_value();
+        released.wait();
+    });
+    started.get_future().wait();
+
+    // Queued behind the blocked job: only the newest "sync" runs
+    for (int i = 1; i <= 3; i++) {
+        queue.post([&ran, i]() { ran.push_back(i); }, "sync");
+    }
+    queue.post([&ran]() { ran.push_back(100); });
+    queue.post([&done]() { done.set_value(); });
+    release.set_value();
+    done.get_future().wait();
+
+    CHECK_EQ(ran.size(), 2u);
+    CHECK_EQ(ran[0], 3);
+    CHECK_EQ(ran[1], 100);
+}
+
+TEST(job_queue_runs_pending_jobs_before_destruction) {
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> ran(0);
+    std::thread releaser;
+    {
+        JobQueue queue;
+        queue.post([&]() {
+            started.set_value();
+            released.wait();
+        });
+        started.get_future().wait();
+
+        // Still queued when the destructor starts, must not be lost
+        queue.post([&ran]() { ran++; }, "sync");
+        queue.post([&ran]() { ran++; });
+        releaser = std::thread([&release]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            release.set_value();
+        });
+    }
+    releaser.join();
+    CHECK_EQ(ran.load(), 2);
+}
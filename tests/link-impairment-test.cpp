@@ -0,0 +1,143 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Link impairment tests
+ *
+ * License: GPL-3.0
+ */
+
+#include "test.h"
+#include "link-impairment.h"
+
+#include <chrono>
+
+using Clock = std::chrono::steady_clock;
+
+TEST(impairment_script_steps_and_selectors) {
+    ImpairmentScript script;
+    std::string error;
+    CHECK(ImpairmentScript::parse(
+        "# comment\n"
+        "seed 9\n"
+        "loop 10000\n"
+        "0     *         delay=20 rate=5000\n"
+        "0     10.0.0.2  loss=5\n"
+        "1000  *         jitter=4\n"
+        "2000  1         blackout=on   # by index\n"
+        "3000  1         blackout=off\n",
+        script, error));
+    CHECK_EQ(script.seed(), 9u);
+    CHECK_EQ(script.loopMs(), 10000);
+
+    // Links without their own steps follow "*"
+    ImpairmentParams params = script.paramsAt("10.0.0.1", 0, 500);
+    CHECK_EQ(params.delayMs, 20.0);
+    CHECK_EQ(params.rateKbps, 5000.0);
+    CHECK_EQ(params.lossGood, 0.0);
+
+    // A named link keeps its own settings and still sees changes to "*"
+    params = script.paramsAt("10.0.0.2", 5, 1500);
+    CHECK_EQ(params.lossGood, 0.05);
+    CHECK_EQ(params.jitterMs, 4.0);
+    CHECK_EQ(params.delayMs, 20.0);
+
+    CHECK(script.paramsAt("10.0.0.9", 1, 2500).blackout);
+    CHECK(!script.paramsAt("10.0.0.9", 1, 3500).blackout);
+    CHECK_EQ(script.paramsAt("10.0.0.9", 1, 3500).jitterMs, 4.0);
+    CHECK(!script.paramsAt("10.0.0.9", 2, 2500).blackout);
+
+    // Time wraps with loop
+    CHECK(script.paramsAt("10.0.0.9", 1, 12500).blackout);
+}
+
+TEST(impairment_script_rejects_bad_lines) {
+    ImpairmentScript script;
+    std::string error;
+    CHECK(!ImpairmentScript::parse("0 * delay=abc\n", script, error));
+    CHECK_EQ(error, std::string("line 1: bad setting delay=abc"));
+    CHECK(!ImpairmentScript::parse("100 * delay=1\n50 * delay=2\n", script, error));
+    CHECK_EQ(error, std::string("line 2: times must not decrease"));
+    CHECK(!ImpairmentScript::parse("0 *\n", script, error));
+    CHECK(!ImpairmentScript::parse("0 * ge=0.5\n", script, error));
+    CHECK(!ImpairmentScript::parse("0 * loss=150\n", script, error));
+}
+
+TEST(impairment_rate_limit_and_delay) {
+    LinkImpairment link(1);
+    ImpairmentParams params;
+    params.delayMs = 10.0;
+    params.rateKbps = 1000.0;  // 1250 bytes take 10 ms
+    params.queueMs = 25.0;
+    link.setParams(params);
+
+    Clock::time_point now = Clock::now();
+    Clock::time_point releaseAt;
+    for (int i = 1; i <= 3; i++) {
+        CHECK(link.admit(1250, now, releaseAt));
+        CHECK_EQ(std::chrono::duration_cast<std::chrono::milliseconds>(releaseAt - now).count(), 10 * i + 10);
+    }
+
+    // The bottleneck now holds 30 ms of data, more than its buffer
+    CHECK(!link.admit(1250, now, releaseAt));
+    CHECK_EQ(link.queueDrops(), 1u);
+
+    // Drained by the time the queue is empty again
+    CHECK(link.admit(1250, now + std::chrono::milliseconds(40), releaseAt));
+    CHECK_EQ(std::chrono::duration_cast<std::chrono::milliseconds>(releaseAt - now).count(), 60);
+}
+
+TEST(impairment_jitter_keeps_order) {
+    LinkImpairment link(3);
+    ImpairmentParams params;
+    params.delayMs = 5.0;
+    params.jitterMs = 50.0;
+    link.setParams(params);
+
+    Clock::time_point now = Clock::now();
+    Clock::time_point last;
+    for (int i = 0; i < 1000; i++) {
+        Clock::time_point releaseAt;
+        CHECK(link.admit(100, now + std::chrono::microseconds(i * 100), releaseAt));
+        CHECK(releaseAt >= last);
+        CHECK(releaseAt >= now + std::chrono::milliseconds(5));
+        last = releaseAt;
+    }
+}
+
+TEST(impairment_gilbert_elliott_loss) {
+    // Stationary Bad probability p / (p + r) = 0.2, all lost there
+    ImpairmentParams params;
+    params.geP = 0.05;
+    params.geR = 0.2;
+    params.lossBad = 1.0;
+
+    LinkImpairment link(42);
+    link.setParams(params);
+    Clock::time_point now = Clock::now();
+    Clock::time_point releaseAt;
+    const int count = 100000;
+    int lostRuns = 0;
+    bool previousLost = false;
+    for (int i = 0; i < count; i++) {
+        bool lost = !link.admit(100, now, releaseAt);
+        if (lost && !previousLost) lostRuns++;
+        previousLost = lost;
+    }
+    double lossRate = (double)link.lost() / count;
+    CHECK(lossRate > 0.18 && lossRate < 0.22);
+
+    // Losses come in bursts of 1 / r = 5 packets on average
+    double meanBurst = (double)link.lost() / lostRuns;
+    CHECK(meanBurst > 4.5 && meanBurst < 5.5);
+
+    // Same seed, same losses
+    LinkImpairment again(42);
+    again.setParams(params);
+    for (int i = 0; i < count; i++) again.admit(100, now, releaseAt);
+    CHECK_EQ(again.lost(), link.lost());
+
+    // Blackout drops everything
+    params = ImpairmentParams();
+    params.blackout = true;
+    link.setParams(params);
+    CHECK(!link.admit(100, now, releaseAt));
+}
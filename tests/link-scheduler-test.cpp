@@ -0,0 +1,73 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Link scheduler tests
+ *
+ * License: GPL-3.0
+ */
+
+#include "test.h"
+#include "link-scheduler.h"
+#include "srtla-protocol.h"
+
+static LinkMetrics makeLink(int window, int inFlight, int priority = 0, double srttMs = -1.0, double lossRate = 0.0) {
+    LinkMetrics metrics;
+    metrics.registered = true;
+    metrics.window = window;
+    metrics.inFlight = inFlight;
+    metrics.priority = priority;
+    metrics.srttMs = srttMs;
+    metrics.lossRate = lossRate;
+    return metrics;
+}
+
+static int selectWith(LinkSchedulerType type, const LinkMetrics* const* links, size_t count) {
+    auto scheduler = createLinkScheduler(type);
+    CHECK(scheduler->type() == type);
+    return scheduler->select(links, count);
+}
+
+TEST(link_scheduler_names_round_trip) {
+    for (LinkSchedulerType type : {LinkSchedulerType::Window, LinkSchedulerType::RttWeighted,
+                                   LinkSchedulerType::LossPenalised, LinkSchedulerType::Priority}) {
+        LinkSchedulerType parsed;
+        CHECK(linkSchedulerFromName(linkSchedulerName(type), parsed));
+        CHECK(parsed == type);
+    }
+    LinkSchedulerType parsed;
+    CHECK(!linkSchedulerFromName("fastest", parsed));
+}
+
+TEST(link_scheduler_skips_unregistered_links) {
+    LinkMetrics a = makeLink(1000, 0);
+    a.registered = false;
+    const LinkMetrics* links[] = {&a};
+    CHECK_EQ(selectWith(LinkSchedulerType::Window, links, 1), -1);
+    CHECK_EQ(selectWith(LinkSchedulerType::Priority, links, 1), -1);
+}
+
+TEST(link_scheduler_window_prefers_free_window) {
+    LinkMetrics a = makeLink(1000, 20);
+    LinkMetrics b = makeLink(1000, 5);
+    const LinkMetrics* links[] = {&a, &b};
+    CHECK_EQ(selectWith(LinkSchedulerType::Window, links, 2), 1);
+}
+
+TEST(link_scheduler_rtt_and_loss_weighting) {
+    // Same free window: the faster link, then the cleaner link wins
+    LinkMetrics a = makeLink(1000, 5, 0, 80.0, 0.0);
+    LinkMetrics b = makeLink(1000, 5, 0, 20.0, 0.2);
+    const LinkMetrics* links[] = {&a, &b};
+    CHECK_EQ(selectWith(LinkSchedulerType::RttWeighted, links, 2), 1);
+    CHECK_EQ(selectWith(LinkSchedulerType::LossPenalised, links, 2), 0);
+}
+
+TEST(link_scheduler_priority_fills_preferred_tier) {
+    LinkMetrics metered = makeLink(SRTLA_WINDOW_DEF * SRTLA_WINDOW_MULT, 0, 1);
+    LinkMetrics wired = makeLink(SRTLA_WINDOW_DEF * SRTLA_WINDOW_MULT, 10, 0);
+    const LinkMetrics* links[] = {&metered, &wired};
+    CHECK_EQ(selectWith(LinkSchedulerType::Priority, links, 2), 1);
+
+    // Preferred window full: overflow to the next tier
+    wired.inFlight = SRTLA_WINDOW_DEF;
+    CHECK_EQ(selectWith(LinkSchedulerType::Priority, links, 2), 0);
+}
@@ -0,0 +1,148 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Link trace tests
+ *
+ * License: GPL-3.0
+ */
+
+#include "test.h"
+#include "link-impairment.h"
+#include "link-trace.h"
+
+static LinkTrace sampleTrace() {
+    LinkTrace trace;
+    trace.linkNames = {"modem-a", "modem-b"};
+    trace.frames.push_back({0, {{5000, 40, 10}, {3000, 70, 0}}});
+    trace.frames.push_back({250, {{5200, 38, 10}, {0, 70, 0}}});
+    trace.frames.push_back({500, {{4100, 55, 250}, {2800, 90, 10000}}});
+    trace.frames.push_back({100000, {{100000, 1, 0}, {1, 4000, 5}}});
+    return trace;
+}
+
+TEST(link_trace_round_trip) {
+    LinkTrace trace = sampleTrace();
+    std::string data = encodeLinkTrace(trace);
+    CHECK_EQ(data.compare(0, 8, "SRTLATRC"), 0);
+
+    LinkTrace decoded;
+    std::string error;
+    CHECK(decodeLinkTrace(data, decoded, error));
+    CHECK(decoded.linkNames == trace.linkNames);
+    CHECK_EQ(decoded.frames.size(), trace.frames.size());
+    for (size_t i = 0; i < trace.frames.size(); i++) {
+        CHECK_EQ(decoded.frames[i].atMs, trace.frames[i].atMs);
+        CHECK(decoded.frames[i].links == trace.frames[i].links);
+    }
+    CHECK_EQ(decoded.durationMs(), 100000);
+
+    // Steady frames cost a byte per field
+    size_t size = data.size();
+    trace.frames.push_back({100250, trace.frames.back().links});
+    CHECK_EQ(encodeLinkTrace(trace).size(), size + 2 + 2 * 3);
+}
+
+TEST(link_trace_lookup) {
+    LinkTrace trace = sampleTrace();
+    CHECK_EQ(trace.at(0, -1).capacityKbps, 0u);
+    CHECK_EQ(trace.at(0, 0).capacityKbps, 5000u);
+    CHECK_EQ(trace.at(0, 249).capacityKbps, 5000u);
+    CHECK_EQ(trace.at(1, 250).capacityKbps, 0u);
+    CHECK_EQ(trace.at(1, 99999).lossBp, 10000u);
+    CHECK_EQ(trace.at(0, 500000).capacityKbps, 100000u);
+    CHECK_EQ(trace.at(2, 0).capacityKbps, 0u);
+}
+
+TEST(link_trace_rejects_bad_data) {
+    LinkTrace trace;
+    std::string error;
+    CHECK(!decodeLinkTrace("", trace, error));
+    CHECK(!decodeLinkTrace("NOTATRACE", trace, error));
+    CHECK_EQ(error, std::string("not a link trace"));
+
+    std::string data = encodeLinkTrace(sampleTrace());
+    std::string badVersion = data;
+    badVersion[8] = 9;
+    CHECK(!decodeLinkTrace(badVersion, trace, error));
+    CHECK_EQ(error, std::string("unsupported trace version"));
+
+    // A cut inside the header or a frame is caught; one between frames
+    // reads as a shorter trace, as from a recording that was cut off
+    size_t accepted = 0;
+    for (size_t len = 8; len < data.size(); len++) {
+        if (decodeLinkTrace(data.substr(0, len), trace, error)) {
+            CHECK_EQ(trace.frames.size(), accepted);
+            accepted++;
+        }
+    }
+    CHECK_EQ(accepted, sampleTrace().frames.size());
+
+    // Loss beyond 100% does not decode
+    LinkTrace lossy;
+    lossy.linkNames = {"a"};
+    lossy.frames.push_back({0, {{1000, 10, 9999}}});
+    std::string lossyData = encodeLinkTrace(lossy);
+    lossyData.back() = 4;  // zigzag +2
+    CHECK(!decodeLinkTrace(lossyData, trace, error));
+}
+
+TEST(link_trace_recorder_columns) {
+    LinkTraceRecorder recorder;
+    CHECK(recorder.empty());
+
+    LinkStats a;
+    a.sourceIp = "10.0.0.1";
+    a.registered = true;
+    a.bitsPerSec = 4000000;
+    a.rttMs = 42.4;
+    a.packetsPerSec = 400;
+    a.naksPerSec = 4;
+
+    SenderStats stats;
+    stats.links = {a};
+    recorder.record(stats, 5000);
+
+    // A second link shows up, the first goes unregistered
+    LinkStats b = a;
+    b.sourceIp = "10.0.0.2";
+    b.bitsPerSec = 0;
+    b.rttMs = -1.0;
+    b.packetsPerSec = 0;
+    a.registered = false;
+    stats.links = {b, a};
+    recorder.record(stats, 5250);
+
+    const LinkTrace& trace = recorder.trace();
+    CHECK(trace.linkNames == std::vector<std::string>({"10.0.0.1", "10.0.0.2"}));
+    CHECK_EQ(trace.frames.size(), 2u);
+    CHECK_EQ(trace.frames[0].atMs, 0);
+    CHECK_EQ(trace.frames[1].atMs, 250);
+
+    CHECK_EQ(trace.frames[0].links.size(), 2u);
+    CHECK_EQ(trace.frames[0].links[0].capacityKbps, 4000u);
+    CHECK_EQ(trace.frames[0].links[0].rttMs, 42u);
+    CHECK_EQ(trace.frames[0].links[0].lossBp, 100u);
+    CHECK_EQ(trace.frames[0].links[1].capacityKbps, 0u);
+
+    // Down is capacity 0; registered but idle is still up
+    CHECK_EQ(trace.frames[1].links[0].capacityKbps, 0u);
+    CHECK_EQ(trace.frames[1].links[1].capacityKbps, 1u);
+    CHECK_EQ(trace.frames[1].links[1].lossBp, 0u);
+}
+
+TEST(link_trace_to_impairment_script) {
+    ImpairmentScript script;
+    std::string error;
+    CHECK(ImpairmentScript::parse(linkTraceToImpairmentScript(sampleTrace()), script, error));
+
+    ImpairmentParams params = script.paramsAt("10.0.0.1", 0, 100);
+    CHECK_EQ(params.rateKbps, 5000.0);
+    CHECK_EQ(params.delayMs, 20.0);
+    CHECK_EQ(params.lossGood, 0.001);
+    CHECK(!params.blackout);
+
+    CHECK(script.paramsAt("10.0.0.2", 1, 300).blackout);
+    params = script.paramsAt("10.0.0.2", 1, 600);
+    CHECK(!params.blackout);
+    CHECK_EQ(params.rateKbps, 2800.0);
+    CHECK_EQ(params.lossGood, 1.0);
+}
@@ -0,0 +1,74 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Packet ring tests
+ *
+ * License: GPL-3.0
+ */
+
+#include "test.h"
+#include "packet-ring.h"
+
+#include <thread>
+
+TEST(packet_ring_push_peek_pop) {
+    PacketRing<16> ring(3);  // rounded up to 4 slots
+    uint8_t buf[17] = {1, 2, 3};
+
+    CHECK(ring.empty());
+    CHECK(!ring.push(buf, 17));
+    for (uint8_t i = 0; i < 4; i++) {
+        buf[0] = i;
+        CHECK(ring.push(buf, i + 1));
+    }
+    CHECK(!ring.push(buf, 1));
+
+    size_t len = 0;
+    const uint8_t* p = ring.peek(len, 2);
+    CHECK(p && len == 3 && p[0] == 2);
+    CHECK(ring.peek(len, 4) == nullptr);
+
+    ring.pop(2);
+    p = ring.peek(len);
+    CHECK(p && len == 3 && p[0] == 2);
+
+    // Freed slots are reused across the wrap
+    CHECK(ring.push(buf, 5));
+    CHECK(ring.push(buf, 6));
+    CHECK(!ring.push(buf, 7));
+    ring.pop(4);
+    CHECK(ring.empty());
+}
+
+TEST(packet_ring_transfers_between_threads) {
+    PacketRing<8> ring(64);
+    const uint32_t count = 200000;
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < count;) {
+            if (ring.push(reinterpret_cast<const uint8_t*>(&i), sizeof(i))) {
+                i++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    bool ordered = true;
+    while (expected < count) {
+        size_t len;
+        const uint8_t* p = ring.peek(len);
+        if (!p) {
+            std::this_thread::yield();
+            continue;
+        }
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        ordered = ordered && len == sizeof(value) && value == expected;
+        ring.pop();
+        expected++;
+    }
+    producer.join();
+    CHECK(ordered);
+    CHECK(ring.empty());
+}
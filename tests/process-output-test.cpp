@@ -0,0 +1,131 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Child process output capture tests
+ *
+ * License: GPL-3.0
+ */
+
+#include "test.h"
+#include "process-output.h"
+#include "process-supervisor.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+TEST(process_output_splits_and_bounds_lines) {
+    ProcessOutput output(4);
+    std::string line;
+
+    // Lines arrive in arbitrary chunks
+    output.append("first li", 8);
+    output.append("ne\r\nsecond\n\n", 12);
+    CHECK(output.pop(line));
+    CHECK_EQ(line, std::string("first line"));
+    CHECK(output.pop(line));
+    CHECK_EQ(line, std::string("second"));
+    CHECK(!output.pop(line));
+
+    // Overlong lines are truncated, the rest of them skipped
+    std::string longLine(PROCESS_OUTPUT_LINE_MAX + 50, 'x');
+    longLine += "\nshort\n";
+    output.append(longLine.data(), longLine.size());
+    CHECK(output.pop(line));
+    CHECK_EQ(line.size(), PROCESS_OUTPUT_LINE_MAX);
+    CHECK(output.pop(line));
+    CHECK_EQ(line, std::string("short"));
+
+    // A full ring drops new lines instead of growing
+    for (int i = 0; i < 6; i++) {
+        std::string text = "line " + std::to_string(i) + "\n";
+        output.append(text.data(), text.size());
+    }
+    CHECK_EQ(output.dropped(), 2u);
+    CHECK(output.pop(line));
+    CHECK_EQ(line, std::string("line 0"));
+
+    // The unterminated last line is kept when the pipe closes
+    while (output.pop(line)) {
+    }
+    output.append("tail", 4);
+    CHECK(!output.pop(line));
+    output.finish();
+    CHECK(output.pop(line));
+    CHECK_EQ(line, std::string("tail"));
+}
+
+TEST(process_output_spills_to_rotated_file) {
+    char dir[] = "/tmp/srtla-test-XXXXXX";
+    CHECK(mkdtemp(dir) != nullptr);
+    std::string path = std::string(dir) + "/srtla.log";
+
+    ProcessOutput output(4);
+    output.setSpillFile(path, 32);
+    output.append("0123456789\n", 11);
+    output.append("abcdefghij\n", 11);
+    output.append("ABCDEFGHIJ\n", 11);
+    output.finish();
+
+    // The third line would have passed 32 bytes
+    CHECK_EQ(readFile(path + ".1"), std::string("0123456789\nabcdefghij\n"));
+    CHECK_EQ(readFile(path), std::string("ABCDEFGHIJ\n"));
+
+    std::string cmd = std::string("rm -rf '") + dir + "'";
+    int ret = system(cmd.c_str());
+    (void)ret;
+}
+
+TEST(srtla_send_events_are_parsed) {
+    SrtlaSendEvent event;
+
+    CHECK(parseSrtlaSendEvent("192.168.1.20 (0x55d0c0a8): connection established", event));
+    CHECK(event.type == SrtlaSendEvent::Type::LinkRegistered);
+    CHECK_EQ(event.link, std::string("192.168.1.20"));
+
+    CHECK(parseSrtlaSendEvent("10.64.0.7 (0x55d0c0b0): connection failed, attempting to reconnect", event));
+    CHECK(event.type == SrtlaSendEvent::Type::LinkTimedOut);
+    CHECK_EQ(event.link, std::string("10.64.0.7"));
+
+    CHECK(parseSrtlaSendEvent("192.168.1.20 (0x55d0c0a8): connection group registered", event));
+    CHECK(event.type == SrtlaSendEvent::Type::GroupRegistered);
+
+    CHECK(parseSrtlaSendEvent("warning: no available connections", event));
+    CHECK(event.type == SrtlaSendEvent::Type::ConnectionLost);
+    CHECK(event.link.empty());
+
+    CHECK(parseSrtlaSendEvent("Failed to bind to the local SRT socket", event));
+    CHECK(event.type == SrtlaSendEvent::Type::Error);
+
+    CHECK(!parseSrtlaSendEvent("Trying to connect to 203.0.113.5:5000...", event));
+}
+
+TEST(supervisor_captures_child_output) {
+    ProcessOutput output;
+    ProcessSupervisor supervisor;
+    CHECK(supervisor.start({"/bin/sh", "-c", "echo to stdout; echo to stderr >&2; sleep 10"}, &output));
+
+    std::string lines;
+    std::string line;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (lines.find("to stderr") == std::string::npos && std::chrono::steady_clock::now() < deadline) {
+        if (output.pop(line)) {
+            lines += line + "\n";
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+    supervisor.stop();
+
+    CHECK(lines.find("to stdout\n") != std::string::npos);
+    CHECK(lines.find("to stderr\n") != std::string::npos);
+}
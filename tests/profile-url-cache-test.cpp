@@ -0,0 +1,82 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Profile URL cache tests
+ *
+ * License: GPL-3.0
+ */
+
+#include "test.h"
+#include "profile-url-cache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include <unistd.h>
+
+static void writeFile(const std::string& path, const std::string& contents) {
+    std::ofstream out(path, std::ios::trunc);
+    out << contents;
+}
+
+TEST(profile_url_cache_reloads_only_on_change) {
+    char dir[] = "/tmp/srtla-test-XXXXXX";
+    CHECK(mkdtemp(dir) != nullptr);
+    std::string servicePath = std::string(dir) + "/service.json";
+
+    int loads = 0;
+    ProfileUrlCache cache([&loads](const std::string& path) {
+        loads++;
+        std::ifstream in(path);
+        std::string url;
+        std::getline(in, url);
+        return url;
+    });
+
+    CHECK_EQ(cache.lookup(dir), std::string());
+    CHECK_EQ(loads, 0);
+
+    writeFile(servicePath, "srt://localhost:9000");
+    CHECK_EQ(cache.lookup(dir), std::string("srt://localhost:9000"));
+    CHECK_EQ(cache.lookup(dir), std::string("srt://localhost:9000"));
+    CHECK_EQ(loads, 1);
+
+    // Replaced by rename, the way OBS saves it
+    writeFile(servicePath + ".tmp", "srt://localhost:9001");
+    CHECK(rename((servicePath + ".tmp").c_str(), servicePath.c_str()) == 0);
+    CHECK_EQ(cache.lookup(dir), std::string("srt://localhost:9001"));
+    CHECK_EQ(loads, 2);
+
+    unlink(servicePath.c_str());
+    CHECK_EQ(cache.lookup(dir), std::string());
+    rmdir(dir);
+}
+
+TEST(profile_url_cache_reloads_after_event_overflow) {
+    char dir[] = "/tmp/srtla-test-XXXXXX";
+    CHECK(mkdtemp(dir) != nullptr);
+    std::string servicePath = std::string(dir) + "/service.json";
+    std::string otherPath = std::string(dir) + "/other";
+
+    ProfileUrlCache cache([](const std::string& path) {
+        std::ifstream in(path);
+        std::string url;
+        std::getline(in, url);
+        return url;
+    });
+    writeFile(servicePath, "srt://localhost:9000");
+    CHECK_EQ(cache.lookup(dir), std::string("srt://localhost:9000"));
+
+    // Overflow the inotify queue, so the change below is never reported
+    int maxEvents = 16384;
+    std::ifstream("/proc/sys/fs/inotify/max_queued_events") >> maxEvents;
+    for (int i = 0; i <= maxEvents; i++) {
+        writeFile(otherPath + std::to_string(i % 2), "x");
+    }
+    writeFile(servicePath, "srt://localhost:9001");
+    CHECK_EQ(cache.lookup(dir), std::string("srt://localhost:9001"));
+
+    std::string cmd = std::string("rm -rf '") + dir + "'";
+    int ret = system(cmd.c_str());
+    (void)ret;
+}
@@ -0,0 +1,476 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Bonding engine end-to-end test over loopback
+ *
+ * Registers two links from 127.0.0.1 and 127.0.0.2 with the local SRTLA
+ * receiver and sends SRT packets to the engine's local port, through to its sink.
+ *
+ * License: GPL-3.0
+ */
+
+#include "test.h"
+#include "srtla-receiver.h"
+#include "srtla-sender.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// SRT sink behind the receiver, records the sequence numbers it gets
+class Sink {
+public:
+    Sink() {
+        m_fd = socket(AF_INET, SOCK_DGRAM, 0);
+        int rcvbuf = 4 << 20;
+        setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(m_fd, (sockaddr*)&addr, sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(m_fd, (sockaddr*)&addr, &len);
+        m_port = ntohs(addr.sin_port);
+
+        timeval tv{0, 50000};
+        setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        m_thread = std::thread(&Sink::run, this);
+    }
+
+    ~Sink() {
+        m_stop = true;
+        m_thread.join();
+        close(m_fd);
+    }
+
+    uint16_t port() const { return m_port; }
+
+    size_t received() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_seqs.size();
+    }
+
+private:
+    void run() {
+        uint8_t buf[SRTLA_MTU];
+        while (!m_stop) {
+            ssize_t n = recv(m_fd, buf, sizeof(buf), 0);
+            int32_t seq = n > 0 ? srt_data_seq(buf, n) : -1;
+            if (seq < 0) continue;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_seqs.insert(seq);
+        }
+    }
+
+    int m_fd;
+    uint16_t m_port;
+    std::atomic<bool> m_stop{false};
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::set<int32_t> m_seqs;
+};
+
+template <typename Pred>
+bool waitFor(Pred pred, int timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+// Link from sourceIp, pinned to ifIndex/interfaceName if given
+LinkConfig makeLink(const std::string& sourceIp, int ifIndex = 0, const std::string& interfaceName = "") {
+    LinkConfig link;
+    link.sourceIp = sourceIp;
+    link.ifIndex = ifIndex;
+    link.interfaceName = interfaceName;
+    return link;
+}
+
+// A local UDP port nothing is bound to
+sockaddr_in freeLoopbackPort() {
+    int probe = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(probe, (sockaddr*)&local, sizeof(local));
+    socklen_t localLen = sizeof(local);
+    getsockname(probe, (sockaddr*)&local, &localLen);
+    close(probe);
+    return local;
+}
+
+// SRT client: count numbered packets to the engine's local port, paced
+// well below loopback capacity so nothing is dropped
+void sendPackets(const sockaddr_in& local, uint32_t count) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    uint8_t packet[1316] = {0};
+    for (uint32_t seq = 0; seq < count; seq++) {
+        srtla_write_be32(packet, seq);
+        sendto(fd, packet, sizeof(packet), 0, (sockaddr*)&local, sizeof(local));
+        if (seq % 10 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    close(fd);
+}
+
+} // namespace
+
+TEST(sender_delivers_over_loopback_links) {
+    Sink sink;
+    SrtlaReceiver receiver;
+    CHECK(receiver.start("127.0.0.1", 0, "127.0.0.1", sink.port()));
+    SenderStatsBuffer statsBuffer;
+    SrtlaSender sender;
+    sender.setStatsBuffer(&statsBuffer);
+    sockaddr_in local = freeLoopbackPort();
+    CHECK(sender.start(ntohs(local.sin_port), {"127.0.0.1"}, receiver.port(), {makeLink("127.0.0.1"), makeLink("127.0.0.2")}));
+
+    // Both links register
+    const SenderStats* stats = nullptr;
+    CHECK(waitFor([&]() {
+        statsBuffer.read(stats);
+        size_t registered = 0;
+        for (const auto& link : stats->links) registered += link.registered;
+        return registered == 2;
+    }, 3000));
+
+    const uint32_t count = 2000;
+    sendPackets(local, count);
+
+    CHECK(waitFor([&]() { return sink.received() == count; }, 3000));
+    ReceiverStats received = receiver.stats();
+    CHECK_EQ(received.linkPackets.size(), 2u);
+    CHECK(received.linkPackets[0] > 0 && received.linkPackets[1] > 0);
+    sender.stop();
+}
+
+TEST(sender_drops_empty_and_oversized_datagrams) {
+    Sink sink;
+    SrtlaReceiver receiver;
+    CHECK(receiver.start("127.0.0.1", 0, "127.0.0.1", sink.port()));
+    sockaddr_in local = freeLoopbackPort();
+    SrtlaSender sender;
+    CHECK(sender.start(ntohs(local.sin_port), {"127.0.0.1"}, receiver.port(), {makeLink("127.0.0.1")}));
+    CHECK(waitFor([&]() { return receiver.stats().linkPackets.size() == 1; }, 3000));
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    uint8_t packet[SRTLA_MTU + 100] = {0};
+    const uint32_t count = 200;
+    for (uint32_t seq = 0; seq < count; seq++) {
+        sendto(fd, packet, 0, 0, (sockaddr*)&local, sizeof(local));
+        sendto(fd, packet, sizeof(packet), 0, (sockaddr*)&local, sizeof(local));
+        srtla_write_be32(packet, seq);
+        sendto(fd, packet, 1316, 0, (sockaddr*)&local, sizeof(local));
+        if (seq % 10 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    close(fd);
+
+    // Only the valid packets are forwarded, and the engine survives the rest
+    CHECK(waitFor([&]() { return sink.received() == count; }, 3000));
+    CHECK(sender.isRunning());
+    sender.stop();
+}
+
+TEST(sender_avoids_blacked_out_link) {
+    auto script = std::make_shared<ImpairmentScript>();
+    std::string error;
+    CHECK(ImpairmentScript::parse("0 1 blackout=on\n", *script, error));
+
+    Sink sink;
+    SrtlaReceiver receiver;
+    CHECK(receiver.start("127.0.0.1", 0, "127.0.0.1", sink.port()));
+    SenderStatsBuffer statsBuffer;
+    SrtlaSender sender;
+    sender.setStatsBuffer(&statsBuffer);
+    sockaddr_in local = freeLoopbackPort();
+    sender.setImpairment(script);
+    CHECK(sender.start(ntohs(local.sin_port), {"127.0.0.1"}, receiver.port(), {makeLink("127.0.0.1"), makeLink("127.0.0.2")}));
+
+    const SenderStats* stats = nullptr;
+    CHECK(waitFor([&]() {
+        statsBuffer.read(stats);
+        return stats->links.size() == 2 && stats->links[0].registered;
+    }, 3000));
+
+    const uint32_t count = 500;
+    sendPackets(local, count);
+
+    // Everything went over the link that is up, the other never registered
+    CHECK(waitFor([&]() { return sink.received() == count; }, 3000));
+    CHECK_EQ(receiver.stats().linkPackets.size(), 1u);
+    statsBuffer.read(stats);
+    CHECK(!stats->links[1].registered);
+    sender.stop();
+}
+
+TEST(sender_holds_back_links_failing_the_quality_gate) {
+    // The second link registers, but answers probes too slowly
+    auto script = std::make_shared<ImpairmentScript>();
+    std::string error;
+    CHECK(ImpairmentScript::parse("0 1 delay=300\n", *script, error));
+
+    Sink sink;
+    SrtlaReceiver receiver;
+    CHECK(receiver.start("127.0.0.1", 0, "127.0.0.1", sink.port()));
+    SenderStatsBuffer statsBuffer;
+    SrtlaSender sender;
+    sender.setStatsBuffer(&statsBuffer);
+    sockaddr_in local = freeLoopbackPort();
+    sender.setImpairment(script);
+    LinkQualityGate gate;
+    gate.enabled = true;
+    gate.maxRttMs = 100.0;
+    sender.setQualityGate(gate);
+    CHECK(sender.start(ntohs(local.sin_port), {"127.0.0.1"}, receiver.port(), {makeLink("127.0.0.1"), makeLink("127.0.0.2")}));
+
+    const SenderStats* stats = nullptr;
+    CHECK(waitFor([&]() {
+        statsBuffer.read(stats);
+        return stats->links.size() == 2 && stats->links[0].registered && !stats->links[0].probing &&
+               stats->links[1].registered;
+    }, 3000));
+
+    const uint32_t count = 500;
+    sendPackets(local, count);
+    CHECK(waitFor([&]() { return sink.received() == count; }, 3000));
+
+    // The slow link kept probing and never carried data
+    statsBuffer.read(stats);
+    CHECK(stats->links[1].probing);
+    ReceiverStats received = receiver.stats();
+    CHECK_EQ(received.linkPackets.size(), 2u);
+    CHECK(received.linkPackets[0] == 0 || received.linkPackets[1] == 0);
+    sender.stop();
+}
+
+TEST(sender_restarts_without_a_gap) {
+    Sink sink;
+    SrtlaReceiver receiver;
+    CHECK(receiver.start("127.0.0.1", 0, "127.0.0.1", sink.port()));
+
+    // A free local port for the SRT client to send to
+    sockaddr_in local = freeLoopbackPort();
+    uint16_t localPort = ntohs(local.sin_port);
+
+    SrtlaSender first;
+    CHECK(first.start(localPort, {"127.0.0.1"}, receiver.port(), {makeLink("127.0.0.1"), makeLink("127.0.0.2")}));
+    uint8_t id[SRTLA_ID_LEN];
+    CHECK(waitFor([&]() { return first.registeredGroup(id) && receiver.stats().linkPackets.size() == 2; }, 3000));
+
+    // The SRT client keeps streaming throughout the restart
+    const uint32_t count = 3000;
+    std::thread client([&]() {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        uint8_t packet[1316] = {0};
+        for (uint32_t seq = 0; seq < count; seq++) {
+            srtla_write_be32(packet, seq);
+            sendto(fd, packet, sizeof(packet), 0, (sockaddr*)&local, sizeof(local));
+            if (seq % 5 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        close(fd);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    SrtlaSender second;
+    CHECK(second.startWarm(first, {"127.0.0.1"}, receiver.port(), {makeLink("127.0.0.1"), makeLink("127.0.0.2")}));
+    CHECK(second.isTakingOver());
+    CHECK(waitFor([&]() { return !second.isTakingOver(); }, 3000));
+    CHECK(!first.isRunning());
+    client.join();
+
+    // Every packet arrived, through one group and so one SRT connection
+    CHECK(waitFor([&]() { return sink.received() == count; }, 3000));
+    ReceiverStats received = receiver.stats();
+    CHECK_EQ(received.groups, 1u);
+    CHECK_EQ(received.linkPackets.size(), 4u);
+    CHECK(received.linkPackets[2] + received.linkPackets[3] > 0);
+    second.stop();
+    first.stop();
+}
+
+TEST(sender_restarts_to_another_server_without_a_gap) {
+    Sink sink;
+    SrtlaReceiver oldReceiver;
+    SrtlaReceiver newReceiver;
+    CHECK(oldReceiver.start("127.0.0.1", 0, "127.0.0.1", sink.port()));
+    CHECK(newReceiver.start("127.0.0.1", 0, "127.0.0.1", sink.port()));
+    sockaddr_in local = freeLoopbackPort();
+    const std::vector<LinkConfig> links = {makeLink("127.0.0.1"), makeLink("127.0.0.2")};
+
+    SrtlaSender first;
+    CHECK(first.start(ntohs(local.sin_port), {"127.0.0.1"}, oldReceiver.port(), links));
+    uint8_t id[SRTLA_ID_LEN];
+    CHECK(waitFor([&]() { return first.registeredGroup(id); }, 3000));
+
+    const uint32_t count = 3000;
+    std::thread client([&]() {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        uint8_t packet[1316] = {0};
+        for (uint32_t seq = 0; seq < count; seq++) {
+            srtla_write_be32(packet, seq);
+            sendto(fd, packet, sizeof(packet), 0, (sockaddr*)&local, sizeof(local));
+            if (seq % 5 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        close(fd);
+    });
+
+    // The new server knows nothing of the running group, a new one is registered
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    SrtlaSender second;
+    CHECK(second.startWarm(first, {"127.0.0.1"}, newReceiver.port(), links, false));
+    CHECK(waitFor([&]() { return !second.isTakingOver(); }, 6000));
+    CHECK(!first.isRunning());
+    uint8_t newId[SRTLA_ID_LEN];
+    CHECK(second.registeredGroup(newId));
+    CHECK(memcmp(id, newId, SRTLA_ID_LEN) != 0);
+    client.join();
+
+    // The old server forwarded until the handover, the new one after it
+    CHECK(waitFor([&]() { return sink.received() == count; }, 3000));
+    CHECK_EQ(oldReceiver.stats().groups, 1u);
+    CHECK_EQ(newReceiver.stats().groups, 1u);
+    ReceiverStats received = newReceiver.stats();
+    CHECK(received.linkPackets.size() == 2u && received.linkPackets[0] + received.linkPackets[1] > 0);
+    second.stop();
+    first.stop();
+}
+
+TEST(sender_chains_warm_restarts) {
+    Sink sink;
+    SrtlaReceiver receiver;
+    CHECK(receiver.start("127.0.0.1", 0, "127.0.0.1", sink.port()));
+    sockaddr_in local = freeLoopbackPort();
+    const std::vector<LinkConfig> links = {makeLink("127.0.0.1"), makeLink("127.0.0.2")};
+
+    SrtlaSender first;
+    CHECK(first.start(ntohs(local.sin_port), {"127.0.0.1"}, receiver.port(), links));
+    uint8_t id[SRTLA_ID_LEN];
+    CHECK(waitFor([&]() { return first.registeredGroup(id); }, 3000));
+
+    const uint32_t count = 3000;
+    std::thread client([&]() {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        uint8_t packet[1316] = {0};
+        for (uint32_t seq = 0; seq < count; seq++) {
+            srtla_write_be32(packet, seq);
+            sendto(fd, packet, sizeof(packet), 0, (sockaddr*)&local, sizeof(local));
+            if (seq % 2 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        close(fd);
+    });
+
+    // Probing keeps the second engine taking over for a while
+    LinkQualityGate slowGate;
+    slowGate.enabled = true;
+    slowGate.probes = 10;
+    SrtlaSender second;
+    second.setQualityGate(slowGate);
+    CHECK(second.startWarm(first, {"127.0.0.1"}, receiver.port(), links));
+
+    // A restart in the middle of a handover is refused, not chained
+    SrtlaSender third;
+    CHECK(!third.startWarm(second, {"127.0.0.1"}, receiver.port(), links));
+    CHECK(second.isTakingOver());
+    CHECK(first.isRunning());
+
+    CHECK(waitFor([&]() { return !second.isTakingOver(); }, 6000));
+    CHECK(!first.isRunning());
+    CHECK(third.startWarm(second, {"127.0.0.1"}, receiver.port(), links));
+    CHECK(waitFor([&]() { return !third.isTakingOver(); }, 6000));
+    CHECK(!second.isRunning());
+    client.join();
+
+    CHECK(waitFor([&]() { return sink.received() == count; }, 3000));
+    CHECK_EQ(receiver.stats().groups, 1u);
+
+    // Stopping an engine that has not taken over yet stops the one it replaces
+    SrtlaSender fourth;
+    fourth.setQualityGate(slowGate);
+    CHECK(fourth.startWarm(third, {"127.0.0.1"}, receiver.port(), links));
+    CHECK(fourth.isTakingOver());
+    fourth.stop();
+    CHECK(!third.isRunning());
+}
+
+TEST(sender_pins_links_to_their_interface) {
+    Sink sink;
+    SrtlaReceiver receiver;
+    CHECK(receiver.start("127.0.0.1", 0, "127.0.0.1", sink.port()));
+    SenderStatsBuffer statsBuffer;
+    SrtlaSender sender;
+    sender.setStatsBuffer(&statsBuffer);
+    sockaddr_in local = freeLoopbackPort();
+
+    // The second link names the wrong interface for its index
+    int lo = (int)if_nametoindex("lo");
+    CHECK(lo > 0);
+    CHECK(sender.start(ntohs(local.sin_port), {"127.0.0.1"}, receiver.port(),
+                       {makeLink("127.0.0.1", lo, "lo"), makeLink("127.0.0.2", lo, "wwan0")}));
+
+    const SenderStats* stats = nullptr;
+    CHECK(waitFor([&]() {
+        statsBuffer.read(stats);
+        return stats->links.size() == 2 && stats->links[0].registered && stats->links[1].registered;
+    }, 3000));
+    CHECK(stats->links[0].pinned);
+    CHECK_EQ(stats->links[0].interfaceName, std::string("lo"));
+    CHECK(!stats->links[1].pinned);
+    CHECK(stats->links[1].interfaceName.empty());
+
+    const uint32_t count = 200;
+    sendPackets(local, count);
+    CHECK(waitFor([&]() { return sink.received() == count; }, 3000));
+    sender.stop();
+}
+
+TEST(sender_uses_one_family_of_a_dual_stack_interface) {
+    Sink sink;
+    SrtlaReceiver receiver;
+    CHECK(receiver.start("::", 0, "127.0.0.1", sink.port()));
+    SenderStatsBuffer statsBuffer;
+    SrtlaSender sender;
+    sender.setStatsBuffer(&statsBuffer);
+    sockaddr_in local = freeLoopbackPort();
+
+    // Both links are on lo, each goes to the server address of its family
+    int lo = (int)if_nametoindex("lo");
+    CHECK(lo > 0);
+    CHECK(sender.start(ntohs(local.sin_port), {"127.0.0.1", "::1"}, receiver.port(),
+                       {makeLink("127.0.0.1", lo, "lo"), makeLink("::1", lo, "lo")}));
+
+    // Both register and are probed, loopback RTTs are too close to switch
+    const SenderStats* stats = nullptr;
+    CHECK(waitFor([&]() {
+        statsBuffer.read(stats);
+        return stats->links.size() == 2 && stats->links[0].registered && stats->links[1].registered &&
+               stats->links[0].keepaliveRttMs >= 0.0 && stats->links[1].keepaliveRttMs >= 0.0;
+    }, 5000));
+    CHECK(!stats->links[0].ipv6);
+    CHECK(stats->links[1].ipv6);
+    CHECK(!stats->links[0].standby);
+    CHECK(stats->links[1].standby);
+
+    const uint32_t count = 200;
+    sendPackets(local, count);
+    CHECK(waitFor([&]() { return sink.received() == count; }, 3000));
+
+    // Only the preferred family carried data
+    CHECK(waitFor([&]() {
+        statsBuffer.read(stats);
+        return stats->links.size() == 2 && stats->links[0].packetsSent >= count;
+    }, 3000));
+    CHECK(stats->links[1].packetsSent < 20);
+    sender.stop();
+}
@@ -0,0 +1,121 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * SRT URL parser and formatter tests
+ *
+ * License: GPL-3.0
+ */
+
+#include "test.h"
+#include "srt-url.h"
+
+#include <string>
+
+static std::string format(const SrtUrl& url) {
+    std::string out(formatSrtUrl(url, nullptr, 0), '\0');
+    formatSrtUrl(url, &out[0], out.size() + 1);
+    return out;
+}
+
+TEST(srt_url_parses_plugin_urls) {
+    std::string url = "srt://localhost:9000?streamid=live/cam1&latency=2000";
+    char scratch[128];
+    SrtUrl parsed;
+    CHECK(parseSrtUrl(url, parsed, scratch, sizeof(scratch)));
+    CHECK(parsed.host == "localhost");
+    CHECK_EQ(parsed.port, 9000);
+    CHECK(parsed.streamId == "live/cam1");
+    CHECK(parsed.latency && *parsed.latency == 2000);
+    CHECK(!parsed.passphrase.size() && !parsed.mode);
+}
+
+TEST(srt_url_keeps_plugin_url_format) {
+    // buildSRTURL() output must not change for existing settings
+    SrtUrl url;
+    url.host = "localhost";
+    url.port = 9000;
+    url.streamId = "abc";
+    url.latency = 2000;
+    CHECK_EQ(format(url), std::string("srt://localhost:9000?streamid=abc&latency=2000"));
+}
+
+TEST(srt_url_parses_all_options) {
+    std::string url = "SRT://[2001:db8::1]:4000/?PASSPHRASE=correct%20horse&pbkeylen=24&maxbw=-1"
+                      "&oheadbw=25&rcvbuf=1000000&sndbuf=2000000&tlpktdrop=false&mode=listener&delay=120";
+    char scratch[256];
+    SrtUrl parsed;
+    CHECK(parseSrtUrl(url, parsed, scratch, sizeof(scratch)));
+    CHECK(parsed.host == "2001:db8::1");
+    CHECK_EQ(parsed.port, 4000);
+    CHECK(parsed.passphrase == "correct horse");
+    CHECK(parsed.pbkeylen && *parsed.pbkeylen == 24);
+    CHECK(parsed.maxbw && *parsed.maxbw == -1);
+    CHECK(parsed.oheadbw && *parsed.oheadbw == 25);
+    CHECK(parsed.rcvbuf && *parsed.rcvbuf == 1000000);
+    CHECK(parsed.sndbuf && *parsed.sndbuf == 2000000);
+    CHECK(parsed.tlpktdrop && !*parsed.tlpktdrop);
+    CHECK(parsed.mode && *parsed.mode == SrtMode::Listener);
+    CHECK(parsed.latency && *parsed.latency == 120);
+}
+
+TEST(srt_url_ignores_invalid_values) {
+    std::string url = "srt://host:99999?latency=abc&pbkeylen=20&oheadbw=1&mode=sideways&tlpktdrop=maybe&x=1&noequals";
+    char scratch[128];
+    SrtUrl parsed;
+    CHECK(parseSrtUrl(url, parsed, scratch, sizeof(scratch)));
+    CHECK(parsed.host == "host");
+    CHECK_EQ(parsed.port, 0);
+    CHECK(!parsed.latency && !parsed.pbkeylen && !parsed.oheadbw && !parsed.mode && !parsed.tlpktdrop);
+}
+
+TEST(srt_url_rejects_bad_urls) {
+    char scratch[64];
+    SrtUrl parsed;
+    CHECK(!parseSrtUrl("rtmp://host:1935/live", parsed, scratch, sizeof(scratch)));
+    CHECK(!parseSrtUrl("srt:/", parsed, scratch, sizeof(scratch)));
+    CHECK(!parseSrtUrl("srt://[::1:9000", parsed, scratch, sizeof(scratch)));
+    CHECK(!parseSrtUrl("srt://[::1]x:9000", parsed, scratch, sizeof(scratch)));
+
+    // Scratch must be able to hold the decoded options
+    CHECK(!parseSrtUrl("srt://localhost:9000?streamid=abc", parsed, scratch, 8));
+}
+
+TEST(srt_url_round_trips_encoded_strings) {
+    SrtUrl url;
+    url.host = "::1";
+    url.port = 1234;
+    url.streamId = "#!::r=live/cam 1,m=publish&x=%";
+    url.passphrase = "p\xc3\xa4ss";
+    url.maxbw = 0;
+    url.tlpktdrop = true;
+    url.mode = SrtMode::Rendezvous;
+
+    std::string text = format(url);
+    CHECK(text.find("streamid=#!::r=live/cam%201,m=publish%26x=%25&") != std::string::npos);
+    CHECK(text.find("passphrase=p%C3%A4ss&") != std::string::npos);
+
+    std::string scratch(text.size(), '\0');
+    SrtUrl parsed;
+    CHECK(parseSrtUrl(text, parsed, &scratch[0], scratch.size()));
+    CHECK(parsed == url);
+    CHECK_EQ(format(parsed), text);
+}
+
+TEST(srt_url_keeps_access_control_streamid_verbatim) {
+    SrtUrl url;
+    url.host = "localhost";
+    url.port = 6000;
+    url.streamId = "#!::r=live,m=publish";
+    url.latency = 2000;
+
+    CHECK_EQ(format(url), std::string("srt://localhost:6000?streamid=#!::r=live,m=publish&latency=2000"));
+}
+
+TEST(srt_url_formats_truncated_output) {
+    SrtUrl url;
+    url.host = "example.com";
+    url.port = 5000;
+    char small[10];
+    size_t len = formatSrtUrl(url, small, sizeof(small));
+    CHECK_EQ(len, std::string("srt://example.com:5000").size());
+    CHECK_EQ(std::string(small), std::string("srt://exa"));
+}
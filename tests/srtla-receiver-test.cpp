@@ -0,0 +1,202 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Local SRTLA receiver tests
+ *
+ * Drives the receiver with hand-built packets from a loopback socket and
+ * checks what reaches the SRT sink.
+ *
+ * License: GPL-3.0
+ */
+
+#include "test.h"
+#include "srtla-receiver.h"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// Loopback UDP socket with a receive timeout
+class Peer {
+public:
+    explicit Peer(int timeoutMs = 1000) {
+        m_fd = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(m_fd, (sockaddr*)&addr, sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(m_fd, (sockaddr*)&addr, &len);
+        m_port = ntohs(addr.sin_port);
+        timeval tv{timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+        setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+
+    ~Peer() { close(m_fd); }
+
+    uint16_t port() const { return m_port; }
+
+    void sendTo(uint16_t port, const uint8_t* buf, size_t len) {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        sendto(m_fd, buf, len, 0, (sockaddr*)&addr, sizeof(addr));
+    }
+
+    // Empty on timeout
+    std::vector<uint8_t> receive() {
+        uint8_t buf[SRTLA_MTU];
+        sockaddr_in from{};
+        socklen_t fromLen = sizeof(from);
+        ssize_t n = recvfrom(m_fd, buf, sizeof(buf), 0, (sockaddr*)&from, &fromLen);
+        if (n <= 0) return {};
+        m_lastFromPort = ntohs(from.sin_port);
+        return std::vector<uint8_t>(buf, buf + n);
+    }
+
+    // Source port of the last packet received
+    uint16_t lastFromPort() const { return m_lastFromPort; }
+
+private:
+    int m_fd;
+    uint16_t m_port;
+    uint16_t m_lastFromPort = 0;
+};
+
+uint16_t typeOf(const std::vector<uint8_t>& pkt) {
+    return srtla_packet_type(pkt.data(), pkt.size());
+}
+
+// Registers peer as the single link of a new group
+bool registerLink(Peer& peer, uint16_t receiverPort) {
+    uint8_t reg[SRTLA_TYPE_REG2_LEN];
+    srtla_write_be16(reg, SRTLA_TYPE_REG1);
+    memset(reg + 2, 0xa5, SRTLA_ID_LEN);
+    peer.sendTo(receiverPort, reg, SRTLA_TYPE_REG1_LEN);
+
+    std::vector<uint8_t> reply = peer.receive();
+    if (typeOf(reply) != SRTLA_TYPE_REG2 || reply.size() != SRTLA_TYPE_REG2_LEN) return false;
+    if (memcmp(reply.data() + 2, reg + 2, SRTLA_ID_LEN / 2) != 0) return false;
+
+    peer.sendTo(receiverPort, reply.data(), reply.size());
+    return typeOf(peer.receive()) == SRTLA_TYPE_REG3;
+}
+
+void sendData(Peer& peer, uint16_t receiverPort, int32_t seq) {
+    uint8_t pkt[64] = {0};
+    srtla_write_be32(pkt, (uint32_t)seq);
+    peer.sendTo(receiverPort, pkt, sizeof(pkt));
+}
+
+int32_t sinkSeq(Peer& sink) {
+    std::vector<uint8_t> pkt = sink.receive();
+    return srt_data_seq(pkt.data(), pkt.size());
+}
+
+// Stats are published after each batch of packets, so poll for them
+ReceiverStats statsAfter(SrtlaReceiver& receiver, uint64_t packets) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    ReceiverStats stats = receiver.stats();
+    while (stats.packets < packets && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        stats = receiver.stats();
+    }
+    return stats;
+}
+
+} // namespace
+
+TEST(receiver_rejects_unknown_group) {
+    Peer sink(200);
+    SrtlaReceiver receiver;
+    CHECK(receiver.start("127.0.0.1", 0, "127.0.0.1", sink.port()));
+
+    Peer link(200);
+    uint8_t reg[SRTLA_TYPE_REG2_LEN];
+    srtla_write_be16(reg, SRTLA_TYPE_REG2);
+    memset(reg + 2, 0x11, SRTLA_ID_LEN);
+    link.sendTo(receiver.port(), reg, sizeof(reg));
+    CHECK_EQ(typeOf(link.receive()), SRTLA_TYPE_REG_NGP);
+
+    // Data from an unregistered address is neither ACKed nor forwarded
+    sendData(link, receiver.port(), 1);
+    CHECK(link.receive().empty());
+    CHECK_EQ(receiver.stats().packets, 0u);
+}
+
+TEST(receiver_registers_acks_and_forwards) {
+    Peer sink;
+    SrtlaReceiver receiver;
+    CHECK(receiver.start("127.0.0.1", 0, "127.0.0.1", sink.port()));
+
+    Peer link;
+    CHECK(registerLink(link, receiver.port()));
+
+    uint8_t keepalive[10];
+    srtla_write_be16(keepalive, SRTLA_TYPE_KEEPALIVE);
+    link.sendTo(receiver.port(), keepalive, sizeof(keepalive));
+    std::vector<uint8_t> echo = link.receive();
+    CHECK_EQ(typeOf(echo), SRTLA_TYPE_KEEPALIVE);
+    CHECK_EQ(echo.size(), sizeof(keepalive));
+
+    for (int32_t seq = 100; seq < 103; seq++) {
+        sendData(link, receiver.port(), seq);
+        CHECK_EQ(sinkSeq(sink), seq);
+    }
+
+    // Every data packet is acknowledged, possibly several per ACK
+    size_t acked = 0;
+    while (acked < 3) {
+        std::vector<uint8_t> ack = link.receive();
+        CHECK_EQ(typeOf(ack), SRTLA_TYPE_ACK);
+        for (size_t off = SRTLA_ACK_HDR_LEN; off + 4 <= ack.size(); off += 4) {
+            CHECK_EQ(srtla_read_be32(ack.data() + off), 100u + acked);
+            acked++;
+        }
+    }
+
+    // The sink's replies go back over the link
+    uint8_t srtAck[SRT_MIN_LEN] = {0};
+    srtla_write_be16(srtAck, SRT_TYPE_ACK);
+    sink.sendTo(sink.lastFromPort(), srtAck, sizeof(srtAck));
+    CHECK_EQ(typeOf(link.receive()), SRT_TYPE_ACK);
+    CHECK_EQ(receiver.stats().groups, 1u);
+}
+
+TEST(receiver_reassembles_in_sequence_order) {
+    Peer sink;
+    SrtlaReceiver receiver;
+    receiver.setReassembly(64, 100);
+    CHECK(receiver.start("127.0.0.1", 0, "127.0.0.1", sink.port()));
+
+    Peer link;
+    CHECK(registerLink(link, receiver.port()));
+
+    for (int32_t seq : {10, 12, 13, 11, 14}) {
+        sendData(link, receiver.port(), seq);
+    }
+    for (int32_t seq = 10; seq <= 14; seq++) {
+        CHECK_EQ(sinkSeq(sink), seq);
+    }
+
+    // A gap is given up on after the hold time, and the missing packet is
+    // passed on as late when it finally shows up
+    sendData(link, receiver.port(), 16);
+    CHECK_EQ(sinkSeq(sink), 16);
+    sendData(link, receiver.port(), 15);
+    CHECK_EQ(sinkSeq(sink), 15);
+
+    ReceiverStats stats = statsAfter(receiver, 7);
+    CHECK_EQ(stats.packets, 7u);
+    CHECK_EQ(stats.reordered, 2u);
+    CHECK_EQ(stats.maxReorderDepth, 2);
+    CHECK_EQ(stats.late, 1u);
+    CHECK_EQ(stats.linkPackets.size(), 1u);
+}
@@ -0,0 +1,63 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Unit test runner
+ *
+ * Runs the tests registered with TEST(); arguments select tests by name.
+ *
+ * License: GPL-3.0
+ */
+
+#include "test.h"
+#include "srtla-log.h"
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+std::vector<TestCase>& testRegistry() {
+    static std::vector<TestCase> registry;
+    return registry;
+}
+
+void testFail(const char* file, int line, const std::string& message) {
+    std::ostringstream out;
+    out << file << ":" << line << ": " << message;
+    throw TestFailure{out.str()};
+}
+
+static bool selected(const char* name, int argc, char** argv) {
+    if (argc < 2) return true;
+    for (int i = 1; i < argc; i++) {
+        if (strstr(name, argv[i])) return true;
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    // Keep the output readable, engine warnings are still shown
+    srtla_log_set_handler([](int level, const char* message) {
+        if (level <= SRTLA_LOG_WARNING) {
+            fprintf(stderr, "  log: %s\n", message);
+        }
+    });
+
+    int run = 0;
+    int failed = 0;
+    for (const TestCase& test : testRegistry()) {
+        if (!selected(test.name, argc, argv)) continue;
+        run++;
+        try {
+            test.function();
+            printf("[  OK  ] %s\n", test.name);
+        } catch (const TestFailure& failure) {
+            failed++;
+            printf("[ FAIL ] %s\n         %s\n", test.name, failure.message.c_str());
+        } catch (const std::exception& e) {
+            failed++;
+            printf("[ FAIL ] %s\n         exception: %s\n", test.name, e.what());
+        }
+    }
+
+    printf("%d test(s), %d failed\n", run, failed);
+    return failed == 0 && run > 0 ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Minimal self-registering test harness, so the core can be tested without
+// pulling in a test framework.
+//
+//     TEST(packet_ring_wraps) {
+//         CHECK(ring.push(buf, 10));
+//         CHECK_EQ(len, 10u);
+//     }
+//
+// A failed check ends the test; srtla-tests runs every test, or those whose
+// name contains one of its arguments, and exits non-zero on any failure.
+
+using TestFunction = void (*)();
+
+struct TestCase {
+    const char* name;
+    TestFunction function;
+};
+
+std::vector<TestCase>& testRegistry();
+
+struct TestRegistrar {
+    TestRegistrar(const char* name, TestFunction function) {
+        testRegistry().push_back({name, function});
+    }
+};
+
+// Thrown by a failed check
+struct TestFailure {
+    std::string message;
+};
+
+[[noreturn]] void testFail(const char* file, int line, const std::string& message);
+
+#define TEST(name)                                                   \
+    static void test_##name();                                       \
+    static TestRegistrar test_registrar_##name(#name, test_##name);  \
+    static void test_##name()
+
+#define CHECK(cond)                                                  \
+    do {                                                             \
+        if (!(cond)) testFail(__FILE__, __LINE__, #cond);            \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                               \
+    do {                                                             \
+        auto&& check_a_ = (a);                                       \
+        auto&& check_b_ = (b);                                       \
+        if (!(check_a_ == check_b_)) {                               \
+            std::ostringstream check_msg_;                           \
+            check_msg_ << #a " == " #b " (" << check_a_ << " vs " << check_b_ << ")"; \
+            testFail(__FILE__, __LINE__, check_msg_.str());          \
+        }                                                            \
+    } while (0)
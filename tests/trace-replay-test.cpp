@@ -0,0 +1,76 @@
+/**
+ * SRTLA Sender Plugin for OBS Studio
+ * Link trace replay tests
+ *
+ * License: GPL-3.0
+ */
+
+#include "test.h"
+#include "trace-replay.h"
+
+// Two links, steady apart from an optional outage of both
+static LinkTrace steadyTrace(int64_t outageFromMs = -1, int64_t outageToMs = -1) {
+    LinkTrace trace;
+    trace.linkNames = {"a", "b"};
+    for (int64_t ms = 0; ms <= 20000; ms += 250) {
+        bool down = ms >= outageFromMs && ms < outageToMs;
+        LinkTracePoint a{down ? 0u : 5000u, 40, 0};
+        LinkTracePoint b{down ? 0u : 4000u, 60, 0};
+        trace.frames.push_back({ms, {a, b}});
+    }
+    return trace;
+}
+
+TEST(trace_replay_clean_links_deliver_everything) {
+    TraceReplayConfig config;
+    config.bitrateKbps = 4000;
+    for (LinkSchedulerType type : {LinkSchedulerType::Window, LinkSchedulerType::RttWeighted,
+                                   LinkSchedulerType::LossPenalised, LinkSchedulerType::Priority}) {
+        config.scheduler = type;
+        TraceReplayResult result = replayLinkTrace(steadyTrace(), config);
+        CHECK_EQ(result.seconds, 20.0);
+        CHECK(result.packets > 7000);
+        CHECK_EQ(result.delivered, result.packets);
+        CHECK_EQ(result.stalls, 0);
+        CHECK(result.goodputKbps > 3900 && result.goodputKbps < 4100);
+        CHECK(result.latencyP50Ms >= 20.0 && result.latencyP99Ms < 200.0);
+    }
+}
+
+TEST(trace_replay_is_deterministic) {
+    LinkTrace trace = steadyTrace();
+    for (auto& frame : trace.frames) {
+        frame.links[0].lossBp = 300;
+        frame.links[1].lossBp = 100;
+    }
+    TraceReplayConfig config;
+    config.adaptBitrate = true;
+
+    TraceReplayResult first = replayLinkTrace(trace, config);
+    TraceReplayResult second = replayLinkTrace(trace, config);
+    CHECK(first.retransmissions > 0);
+    CHECK_EQ(first.delivered, second.delivered);
+    CHECK_EQ(first.retransmissions, second.retransmissions);
+    CHECK_EQ(first.meanBitrateKbps, second.meanBitrateKbps);
+    CHECK_EQ(first.latencyP99Ms, second.latencyP99Ms);
+
+    config.seed = 2;
+    CHECK(replayLinkTrace(trace, config).retransmissions != first.retransmissions);
+}
+
+TEST(trace_replay_counts_stalls) {
+    TraceReplayConfig config;
+    config.bitrateKbps = 4000;
+
+    // Shorter than the latency: retransmissions cover it
+    TraceReplayResult result = replayLinkTrace(steadyTrace(5000, 6000), config);
+    CHECK_EQ(result.stalls, 0);
+    CHECK_EQ(result.delivered, result.packets);
+    CHECK(result.retransmissions > 0);
+
+    // Longer than the latency: the part that cannot be retransmitted in time
+    result = replayLinkTrace(steadyTrace(5000, 10000), config);
+    CHECK_EQ(result.stalls, 1);
+    CHECK(result.stalledSeconds > 2.5 && result.stalledSeconds < 4.5);
+    CHECK(result.delivered < result.packets);
+}